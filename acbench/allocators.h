@@ -0,0 +1,379 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#ifndef ACBENCH_ALLOCATORS_H_
+#define ACBENCH_ALLOCATORS_H_
+
+/**
+
+Allocation policies for acbench::ringbuffer (third template argument), as STL-like allocators:
+
+    allocator_aligned<T, Alignment=64>
+        Memory aligned on cache lines, so that SIMD loads and stores of the ringbuffer's segments
+        don't straddle two cache lines.
+
+    allocator_hugepage<T, Threshold=2MB>
+        Allocations of at least Threshold bytes are backed by huge pages, which reduces the TLB misses
+        when running through large buffers. (Linux only, otherwise same as allocator_aligned)
+        It first tries explicit huge pages (MAP_HUGETLB, which needs pages reserved in /proc/sys/vm/nr_hugepages),
+        and falls back on transparent huge pages (madvise(MADV_HUGEPAGE)).
+
+    allocator_mlock<T, Base=allocator_aligned<T>>
+        For real-time threads: the memory is touched and locked in RAM when allocated,
+        so that accessing it never triggers a page fault (nor a swap) in the real-time thread.
+        Locking is best effort, as it can be denied by the system (see RLIMIT_MEMLOCK),
+        the memory is touched anyway.
+
+    allocator_lazy<T, Threshold=64KB>
+        Allocations of at least Threshold bytes only reserve address space (mmap, or VirtualAlloc on Windows),
+        the pages being committed on demand, when first written (ex. as the write head of the ringbuffer advances).
+        A large ringbuffer of which only the beginning is used (ex. the measures of acbench::time_elapsed)
+        then costs neither the time nor the resident memory of its whole capacity. The memory is given back
+        to the system on deallocation (whereas the heap might keep it). Below Threshold, same as allocator_aligned.
+
+    allocator_arena<T>
+        Carves the allocations out of an arena_monotonic, one block allocated once and shared by many ringbuffers
+        (ex. the hundreds of buffers of a processing graph), instead of one heap allocation per buffer.
+        Deallocating is a no-op: the memory is given back all at once, with arena.release() or when the arena is destroyed.
+        The allocator only holds a pointer to the arena, so it has to be given to the constructor of the ringbuffer:
+            acbench::arena_monotonic arena(10000*4096*sizeof(float));
+            acbench::ringbuffer<float, std::mutex, acbench::allocator_arena<float>> rb(acbench::allocator_arena<float>(arena));
+        WARNING: The arena is not thread-safe, the buffers sharing it should allocate from a single thread
+                 (typically when the graph is instantiated).
+
+Like the default allocator_new<T>, they only allocate raw memory for trivially copyable types.
+All of them throw std::bad_alloc if the memory cannot be obtained.
+
+    acbench::ringbuffer<float, std::mutex, acbench::allocator_hugepage<float>> rb;
+
+**/
+
+#include <cstddef>  // For std::size_t
+#include <cstdlib>  // For std::free(.)
+#include <cstring>  // For std::memset(.)
+#include <new>      // For std::bad_alloc
+
+#if defined(_MSC_VER)
+    #include <malloc.h>     // For _aligned_malloc(.)
+    #ifndef NOMINMAX
+        #define NOMINMAX        // Keeps std::min and std::max usable
+    #endif
+    #include <windows.h>    // For VirtualLock(.) and VirtualAlloc(.)
+#else
+    #include <sys/mman.h>   // For mmap(.), madvise(.) and mlock(.)
+#endif
+
+
+namespace acbench {
+
+    //! Memory aligned on Alignment bytes (a power of two, at least sizeof(void*)).
+    template<typename T, std::size_t Alignment = 64>
+    class allocator_aligned {
+        static_assert((Alignment & (Alignment-1)) == 0, "Alignment must be a power of two");
+        static_assert(Alignment >= sizeof(void*), "Alignment must be at least sizeof(void*)");
+
+     public:
+        typedef T value_type;
+        template<typename U> struct rebind { typedef allocator_aligned<U, Alignment> other; };
+
+        allocator_aligned() {}
+        template<typename U>
+        allocator_aligned(const allocator_aligned<U, Alignment>&) {}  // NOLINT(runtime/explicit)
+
+        inline T* allocate(std::size_t n) {
+            std::size_t nb_bytes = sizeof(T)*n;
+            if (nb_bytes == 0)
+                nb_bytes = Alignment;  // GCOVR_EXCL_LINE
+            void* p = nullptr;
+            #if defined(_MSC_VER)
+                p = _aligned_malloc(nb_bytes, Alignment);
+            #else
+                if (posix_memalign(&p, Alignment, nb_bytes) != 0)
+                    p = nullptr;  // GCOVR_EXCL_LINE
+            #endif
+            if (p == nullptr)
+                throw std::bad_alloc();  // GCOVR_EXCL_LINE
+            return reinterpret_cast<T*>(p);
+        }
+        inline void deallocate(T* p, std::size_t) {
+            #if defined(_MSC_VER)
+                _aligned_free(p);
+            #else
+                std::free(p);
+            #endif
+        }
+    };
+    template<typename T, typename U, std::size_t A>
+    inline bool operator==(const allocator_aligned<T, A>&, const allocator_aligned<U, A>&) { return true; }
+    template<typename T, typename U, std::size_t A>
+    inline bool operator!=(const allocator_aligned<T, A>&, const allocator_aligned<U, A>&) { return false; }
+
+
+    //! Huge pages for allocations of at least Threshold bytes, allocator_aligned<T> below.
+    template<typename T, std::size_t Threshold = 2*1024*1024>
+    class allocator_hugepage {
+     public:
+        typedef T value_type;
+        template<typename U> struct rebind { typedef allocator_hugepage<U, Threshold> other; };
+        static const std::size_t hugepage_size = 2*1024*1024;  // The default huge page size on x86-64 and arm64
+
+        allocator_hugepage() {}
+        template<typename U>
+        allocator_hugepage(const allocator_hugepage<U, Threshold>&) {}  // NOLINT(runtime/explicit)
+
+        //! Returns true if an allocation of n values is mapped by this allocator (rather than allocator_aligned)
+        static inline bool is_mapped(std::size_t n) {
+            #if defined(__linux__)
+                return sizeof(T)*n >= Threshold;
+            #else
+                (void)n;
+                return false;
+            #endif
+        }
+
+        inline T* allocate(std::size_t n) {
+            if (!is_mapped(n))
+                return allocator_aligned<T>().allocate(n);
+
+            #if defined(__linux__)
+                std::size_t nb_bytes = mapped_size(n);
+                void* p = mmap(nullptr, nb_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (p == MAP_FAILED) {
+                    // No huge pages reserved, fall back on transparent huge pages
+                    p = mmap(nullptr, nb_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (p == MAP_FAILED)
+                        throw std::bad_alloc();  // GCOVR_EXCL_LINE
+                    #ifdef MADV_HUGEPAGE
+                    madvise(p, nb_bytes, MADV_HUGEPAGE);  // Only a hint, the kernel might ignore it
+                    #endif
+                }
+                return reinterpret_cast<T*>(p);
+            #else
+                return nullptr;  // GCOVR_EXCL_LINE - Never reached
+            #endif
+        }
+        inline void deallocate(T* p, std::size_t n) {
+            if (!is_mapped(n)) {
+                allocator_aligned<T>().deallocate(p, n);
+                return;
+            }
+            #if defined(__linux__)
+                munmap(reinterpret_cast<void*>(p), mapped_size(n));
+            #endif
+        }
+
+     private:
+        static inline std::size_t mapped_size(std::size_t n) {
+            return ((sizeof(T)*n + hugepage_size - 1) / hugepage_size) * hugepage_size;
+        }
+    };
+    template<typename T, typename U, std::size_t S>
+    inline bool operator==(const allocator_hugepage<T, S>&, const allocator_hugepage<U, S>&) { return true; }
+    template<typename T, typename U, std::size_t S>
+    inline bool operator!=(const allocator_hugepage<T, S>&, const allocator_hugepage<U, S>&) { return false; }
+
+
+    //! Memory of the Base allocator, touched and locked in RAM.
+    template<typename T, typename Base = allocator_aligned<T>>
+    class allocator_mlock {
+        Base m_base;
+
+     public:
+        typedef T value_type;
+        template<typename U> struct rebind { typedef allocator_mlock<U, typename Base::template rebind<U>::other> other; };
+
+        allocator_mlock() {}
+        template<typename U, typename Base2>
+        allocator_mlock(const allocator_mlock<U, Base2>& a) : m_base(a.base()) {}  // NOLINT(runtime/explicit)
+
+        inline const Base& base() const {
+            return m_base;
+        }
+
+        //! Returns true if the memory of the last allocation of the calling thread could be locked.
+        static inline bool& last_locked() {
+            static thread_local bool locked = false;
+            return locked;
+        }
+
+        inline T* allocate(std::size_t n) {
+            T* p = m_base.allocate(n);
+            std::size_t nb_bytes = sizeof(T)*n;
+            std::memset(reinterpret_cast<void*>(p), 0, nb_bytes);  // Fault all the pages in now
+            #if defined(_MSC_VER)
+                last_locked() = (VirtualLock(reinterpret_cast<void*>(p), nb_bytes) != 0);
+            #else
+                last_locked() = (mlock(reinterpret_cast<void*>(p), nb_bytes) == 0);
+            #endif
+            return p;
+        }
+        inline void deallocate(T* p, std::size_t n) {
+            // Unlocking fails harmlessly if the memory was not locked
+            #if defined(_MSC_VER)
+                VirtualUnlock(reinterpret_cast<void*>(p), sizeof(T)*n);
+            #else
+                munlock(reinterpret_cast<void*>(p), sizeof(T)*n);
+            #endif
+            m_base.deallocate(p, n);
+        }
+    };
+    template<typename T, typename U, typename B1, typename B2>
+    inline bool operator==(const allocator_mlock<T, B1>& a1, const allocator_mlock<U, B2>& a2) { return a1.base() == a2.base(); }
+    template<typename T, typename U, typename B1, typename B2>
+    inline bool operator!=(const allocator_mlock<T, B1>& a1, const allocator_mlock<U, B2>& a2) { return !(a1 == a2); }
+
+
+    //! Address space only for allocations of at least Threshold bytes, the pages being backed by physical memory
+    //  when first written (the smaller allocations use allocator_aligned<T>).
+    //  On Windows, the whole allocation is committed up front (it counts in the system's commit limit),
+    //  as VirtualAlloc can't commit the pages on first touch; only their physical memory is lazy.
+    template<typename T, std::size_t Threshold = 64*1024>
+    class allocator_lazy {
+     public:
+        typedef T value_type;
+        template<typename U> struct rebind { typedef allocator_lazy<U, Threshold> other; };
+
+        allocator_lazy() {}
+        template<typename U>
+        allocator_lazy(const allocator_lazy<U, Threshold>&) {}  // NOLINT(runtime/explicit)
+
+        //! Returns true if an allocation of n values is mapped by this allocator (rather than allocator_aligned)
+        static inline bool is_mapped(std::size_t n) {
+            return sizeof(T)*n >= Threshold;
+        }
+
+        inline T* allocate(std::size_t n) {
+            if (!is_mapped(n))
+                return allocator_aligned<T>().allocate(n);
+
+            void* p = nullptr;
+            #if defined(_MSC_VER)
+                // Reserved and committed at once, the committed pages being backed by physical memory when first accessed
+                p = VirtualAlloc(nullptr, sizeof(T)*n, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+            #else
+                int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+                #ifdef MAP_NORESERVE
+                flags |= MAP_NORESERVE;  // No swap reserved for the pages never written
+                #endif
+                p = mmap(nullptr, sizeof(T)*n, PROT_READ | PROT_WRITE, flags, -1, 0);
+                if (p == MAP_FAILED)
+                    p = nullptr;  // GCOVR_EXCL_LINE
+            #endif
+            if (p == nullptr)
+                throw std::bad_alloc();  // GCOVR_EXCL_LINE
+            return reinterpret_cast<T*>(p);
+        }
+        inline void deallocate(T* p, std::size_t n) {
+            if (!is_mapped(n)) {
+                allocator_aligned<T>().deallocate(p, n);
+                return;
+            }
+            #if defined(_MSC_VER)
+                VirtualFree(reinterpret_cast<void*>(p), 0, MEM_RELEASE);
+            #else
+                munmap(reinterpret_cast<void*>(p), sizeof(T)*n);
+            #endif
+        }
+    };
+    template<typename T, typename U, std::size_t S>
+    inline bool operator==(const allocator_lazy<T, S>&, const allocator_lazy<U, S>&) { return true; }
+    template<typename T, typename U, std::size_t S>
+    inline bool operator!=(const allocator_lazy<T, S>&, const allocator_lazy<U, S>&) { return false; }
+
+
+    //! One memory block, from which the allocations are carved out one after the other (bump pointer).
+    //  Each allocation starts on a cache line, so that two buffers never share one.
+    class arena_monotonic {
+     public:
+        static const std::size_t alignment = 64;
+
+     protected:
+        char* m_block = nullptr;
+        std::size_t m_size = 0;
+        std::size_t m_used = 0;
+
+        // Copy constructor is forbidden, the allocators point to the arena.
+        explicit arena_monotonic(const arena_monotonic& arena) {
+            (void)arena;
+        }
+        // So is copy assignment (the block would be shared and deallocated twice).
+        arena_monotonic& operator=(const arena_monotonic&) = delete;
+
+     public:
+        //! Allocates the block of nb_bytes bytes (the only allocation of the arena).
+        explicit arena_monotonic(std::size_t nb_bytes) {
+            m_size = ((nb_bytes + alignment - 1) / alignment) * alignment;
+            m_block = allocator_aligned<char, alignment>().allocate(m_size);
+        }
+        ~arena_monotonic() {
+            allocator_aligned<char, alignment>().deallocate(m_block, m_size);
+        }
+
+        //! Throws std::bad_alloc if the arena cannot hold nb_bytes more bytes.
+        inline void* allocate(std::size_t nb_bytes) {
+            std::size_t nb_bytes_aligned = ((nb_bytes + alignment - 1) / alignment) * alignment;
+            if (nb_bytes_aligned > m_size - m_used)
+                throw std::bad_alloc();
+            void* p = reinterpret_cast<void*>(m_block + m_used);
+            m_used += nb_bytes_aligned;
+            return p;
+        }
+        //! No-op, the memory is given back by release() only.
+        inline void deallocate(void*, std::size_t) {
+        }
+        //! Makes all the block available again.
+        //  WARNING: The memory of all the previous allocations must not be used anymore.
+        inline void release() {
+            m_used = 0;
+        }
+
+        inline std::size_t size() const {
+            return m_size;
+        }
+        inline std::size_t used() const {
+            return m_used;
+        }
+    };
+
+    //! Memory carved out of an arena_monotonic.
+    //  A default-constructed allocator has no arena and throws std::bad_alloc on allocation.
+    template<typename T>
+    class allocator_arena {
+        arena_monotonic* m_arena = nullptr;
+
+     public:
+        typedef T value_type;
+        template<typename U> struct rebind { typedef allocator_arena<U> other; };
+
+        allocator_arena() {}
+        explicit allocator_arena(arena_monotonic& arena) : m_arena(&arena) {}
+        template<typename U>
+        allocator_arena(const allocator_arena<U>& a) : m_arena(a.arena()) {}  // NOLINT(runtime/explicit)
+
+        inline arena_monotonic* arena() const {
+            return m_arena;
+        }
+
+        inline T* allocate(std::size_t n) {
+            if (m_arena == nullptr)
+                throw std::bad_alloc();
+            return reinterpret_cast<T*>(m_arena->allocate(sizeof(T)*n));
+        }
+        inline void deallocate(T* p, std::size_t n) {
+            if (m_arena)
+                m_arena->deallocate(reinterpret_cast<void*>(p), sizeof(T)*n);
+        }
+    };
+    template<typename T, typename U>
+    inline bool operator==(const allocator_arena<T>& a1, const allocator_arena<U>& a2) { return a1.arena() == a2.arena(); }
+    template<typename T, typename U>
+    inline bool operator!=(const allocator_arena<T>& a1, const allocator_arena<U>& a2) { return !(a1 == a2); }
+
+}  // namespace acbench
+
+#endif  // ACBENCH_ALLOCATORS_H_
@@ -0,0 +1,218 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#include <acbench/allocators.h>
+#include <acbench/ringbuffer.h>
+#include <acbench/ringbuffer_group.h>
+#include <acbench/delayline.h>
+
+#include "utils.h"
+
+#include <cstdint>
+#include <deque>
+#include <new>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+template<typename ringbuffer_t>
+void rb_check_push_pop(ringbuffer_t& rb, int size_max) {
+    std::deque<float> ref;
+    rb.resize_allocation(size_max);
+    for (int iter = 0; iter < 3; ++iter) {
+        for (int n = 0; n < size_max; ++n) {
+            float v = acbench::rand_uniform_continuous_01<float>();
+            rb.push_back(v);
+            ref.push_back(v);
+        }
+        rb.pop_front(size_max/2);
+        ref.erase(ref.begin(), ref.begin()+size_max/2);
+        REQUIRE(rb.size() == static_cast<int>(ref.size()));
+        for (int n = 0; n < rb.size(); ++n)
+            REQUIRE(rb[n] == ref[n]);
+        rb.pop_front(size_max);
+        ref.clear();
+    }
+
+    // Reallocations go through the allocator too
+    rb.push_back(1.0f, 10);
+    rb.reserve(2*size_max);
+    rb.set_dynamic_allocation(true);
+    rb.push_back(2.0f, 2*size_max);
+    rb.shrink_to_fit();
+    REQUIRE(rb.size() == 2*size_max+10);
+    REQUIRE(rb.front() == 1.0f);
+    REQUIRE(rb.back() == 2.0f);
+}
+
+TEST_CASE("allocator_aligned") {
+    acbench::allocator_aligned<float> alloc;
+    for (int n : {1, 3, 100, 4097}) {
+        float* p = alloc.allocate(n);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(p) % 64 == 0);
+        alloc.deallocate(p, n);
+    }
+    acbench::allocator_aligned<double, 4096> alloc_page;
+    double* p = alloc_page.allocate(10);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p) % 4096 == 0);
+    alloc_page.deallocate(p, 10);
+
+    acbench::allocator_aligned<double> alloc_rebound(alloc);
+    REQUIRE(alloc_rebound == acbench::allocator_aligned<double>());
+    REQUIRE(!(alloc_rebound != acbench::allocator_aligned<double>()));
+
+    acbench::ringbuffer<float, acbench::lock_none, acbench::allocator_aligned<float>> rb;
+    rb_check_push_pop(rb, 1000);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(rb.data()) % 64 == 0);
+}
+
+TEST_CASE("allocator_hugepage") {
+    typedef acbench::allocator_hugepage<float> alloc_t;
+    alloc_t alloc;
+
+    // Small allocations are aligned ones
+    REQUIRE(!alloc_t::is_mapped(1000));
+    float* p = alloc.allocate(1000);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p) % 64 == 0);
+    alloc.deallocate(p, 1000);
+
+    // Large ones are mapped on huge page boundaries (if any huge pages are available)
+    int n = 3*1024*1024/sizeof(float);
+    #if defined(__linux__)
+        REQUIRE(alloc_t::is_mapped(n));
+    #endif
+    p = alloc.allocate(n);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p) % 64 == 0);
+    p[0] = 1.0f;
+    p[n-1] = 2.0f;
+    alloc.deallocate(p, n);
+
+    acbench::allocator_hugepage<double> alloc_rebound(alloc);
+    REQUIRE(alloc_rebound == acbench::allocator_hugepage<double>());
+    REQUIRE(!(alloc_rebound != acbench::allocator_hugepage<double>()));
+
+    acbench::ringbuffer<float, acbench::lock_none, acbench::allocator_hugepage<float, 4096>> rb;
+    rb_check_push_pop(rb, 10000);
+}
+
+TEST_CASE("allocator_mlock") {
+    typedef acbench::allocator_mlock<float> alloc_t;
+    alloc_t alloc;
+
+    float* p = alloc.allocate(1000);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p) % 64 == 0);
+    for (int n = 0; n < 1000; ++n)
+        REQUIRE(p[n] == 0.0f);
+    bool locked = alloc_t::last_locked();
+    (void)locked;  // Depends on the system's limits
+    alloc.deallocate(p, 1000);
+
+    acbench::allocator_mlock<double>::rebind<float>::other alloc_rebound(alloc);
+    REQUIRE(alloc_rebound == alloc);
+    REQUIRE(!(alloc_rebound != alloc));
+
+    acbench::ringbuffer<float, acbench::lock_none, acbench::allocator_mlock<float, acbench::allocator_hugepage<float>>> rb;
+    rb_check_push_pop(rb, 1000);
+}
+
+TEST_CASE("allocator_lazy") {
+    typedef acbench::allocator_lazy<float, 4096> alloc_t;
+    REQUIRE(!alloc_t::is_mapped(1000));
+    REQUIRE(alloc_t::is_mapped(1024));
+
+    alloc_t alloc;
+    float* p = alloc.allocate(1000000);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p) % 4096 == 0);
+    REQUIRE(p[999999] == 0.0f);  // Zero pages
+    for (int n = 0; n < 1000; ++n)
+        p[n] = static_cast<float>(n);
+    REQUIRE(p[999] == 999.0f);
+    alloc.deallocate(p, 1000000);
+
+    acbench::allocator_lazy<double, 4096>::rebind<float>::other alloc_rebound(alloc);
+    REQUIRE(alloc_rebound == alloc);
+    REQUIRE(!(alloc_rebound != alloc));
+
+    acbench::ringbuffer<float, acbench::lock_none, alloc_t> rb;
+    rb_check_push_pop(rb, 10000);
+    rb_check_push_pop(rb, 100);
+}
+
+TEST_CASE("allocator_spsc_ringbuffer") {
+    acbench::spsc_ringbuffer<float, acbench::allocator_aligned<float>> rb;
+    rb.resize_allocation(100);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(rb.data()) % 64 == 0);
+    REQUIRE(rb.push_back(1.0f, 100) == 100);
+    REQUIRE(rb.pop_front() == 1.0f);
+    rb.resize_allocation(200);
+    REQUIRE(rb.capacity() == 200);
+}
+
+TEST_CASE("allocator_arena") {
+    acbench::arena_monotonic arena(1000000);
+    REQUIRE(arena.size() >= 1000000);
+    REQUIRE(arena.used() == 0);
+
+    typedef acbench::allocator_arena<float> alloc_t;
+    alloc_t alloc(arena);
+    float* p1 = alloc.allocate(10);
+    float* p2 = alloc.allocate(10);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p1) % 64 == 0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p2) % 64 == 0);
+    REQUIRE(p2 == p1 + 16);  // Each allocation starts on a cache line
+    REQUIRE(arena.used() == 128);
+    alloc.deallocate(p1, 10);
+    REQUIRE(arena.used() == 128);  // Monotonic
+    arena.release();
+    REQUIRE(arena.used() == 0);
+    REQUIRE(alloc.allocate(10) == p1);
+    arena.release();
+
+    acbench::allocator_arena<double> alloc_double(arena);
+    acbench::allocator_arena<double>::rebind<float>::other alloc_rebound(alloc_double);
+    REQUIRE(alloc_rebound == alloc);
+    REQUIRE(!(alloc_rebound != alloc));
+    REQUIRE(alloc_t() != alloc);
+
+    // Without arena, or when the arena is exhausted
+    alloc_t alloc_none;
+    REQUIRE_THROWS_AS(alloc_none.allocate(1), std::bad_alloc);
+    alloc_none.deallocate(nullptr, 1);
+    REQUIRE_THROWS_AS(alloc.allocate(1000000), std::bad_alloc);
+
+    // Many ringbuffers out of the same arena
+    std::vector<acbench::ringbuffer<float, acbench::lock_none, alloc_t>> rbs;
+    for (int i = 0; i < 10; ++i)
+        rbs.emplace_back(alloc);
+    for (auto& rb : rbs) {
+        REQUIRE(rb.get_allocator() == alloc);
+        rb_check_push_pop(rb, 1000);
+    }
+    REQUIRE(arena.used() > 10*1000*sizeof(float));
+    arena.release();
+
+    acbench::spsc_ringbuffer<float, alloc_t> rb_spsc(alloc);
+    rb_spsc.resize_allocation(100);
+    REQUIRE(arena.used() == 448);  // 101 floats, rounded up to cache lines
+    REQUIRE(rb_spsc.push_back(1.0f, 100) == 100);
+    REQUIRE(rb_spsc.pop_front() == 1.0f);
+
+    typedef acbench::ringbuffer_group<float, acbench::lock_none, alloc_t> group_t;
+    group_t group(alloc);
+    group.resize_allocation(4, 256);
+    std::size_t array_size = ((4*sizeof(group_t::buffer_type) + 63) / 64) * 64;  // The array of ringbuffers too
+    REQUIRE(arena.used() == 448 + array_size + 4*1024);
+    REQUIRE_THROWS_AS(group_t().resize_allocation(4, 256), std::bad_alloc);
+    for (int i = 0; i < group.nb_buffers(); ++i)
+        REQUIRE(group.buffer(i).get_allocator() == alloc);
+
+    acbench::delayline<float, acbench::lock_none, alloc_t> dl(alloc);
+    dl.resize_allocation(100, 10);
+    REQUIRE(dl.buffer().get_allocator() == alloc);
+    REQUIRE(dl.buffer().size() == dl.buffer().size_max());
+}
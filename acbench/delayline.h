@@ -0,0 +1,266 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#ifndef ACBENCH_DELAYLINE_H_
+#define ACBENCH_DELAYLINE_H_
+
+/**
+
+Delay line, built on the storage of acbench::ringbuffer.
+
+    The signal is written by blocks with write(.), and the last written block can then be read back
+    with any delay (in samples) between 0 and delay_max():
+        read(out, n, delay)                             Integer delay.
+        read_taps(out, n, delays, gains, nb_taps)       Sum of integer delays, each one with its gain.
+        read_linear(out, n, delay)                      Fractional delay, linear interpolation.
+        read_cubic(out, n, delay)                       Fractional delay, 3rd order Lagrange interpolation (delay >= 1).
+        read_allpass(out, n, delay, state)              Fractional delay, 1st order allpass interpolation.
+                                                        `state` is the last output value of the previous read of the caller.
+
+    The history is always full (initially of zeros), so a read never depends on the amount of data written so far.
+    Each read is a weighted sum of shifted copies of the history, each copy being done with the vectorized kernels
+    of acbench/simd.h in at most two contiguous passes (one on each side of the wrap point).
+
+    Typical use, per block of n samples:
+        dl.write(in, n);
+        dl.read_linear(out, n, 441.3f);
+
+Allocation:
+    Only resize_allocation(delay_max, block_size_max) allocates memory (the destructor deallocates it),
+    through the Allocator of the underlying ringbuffer.
+
+Thread-safety:
+    Same as acbench::ringbuffer, chosen with the Lock template argument (std::mutex, lock_spinlock or lock_none).
+
+**/
+
+#include <acbench/ringbuffer.h>
+#include <acbench/simd.h>
+
+
+namespace acbench {
+
+    template<typename T, typename Lock = lock_default, typename Allocator = allocator_new<T>>
+    class delayline {
+        static_assert(!is_lock_free_policy<Lock>::value, "lock_spsc and lock_mpmc are not supported by delayline");
+
+     public:
+        typedef T value_type;
+        typedef Lock lock_type;
+        typedef Allocator allocator_type;
+
+        //! Number of values kept beyond delay_max() for the interpolations
+        static const int interpolation_margin = 2;
+
+     protected:
+        ACBENCH_MUTEX_DECLARE
+
+        ringbuffer<T, lock_none, Allocator> m_buffer;  // Always full, the mutex is the delayline's
+        int m_delay_max = 0;
+        int m_block_size_max = 0;
+
+        // Copy constructor is forbidden to avoid implicit calls.
+        explicit delayline(const delayline& dl) {
+            (void)dl;
+        }
+
+        inline void clear_nolock() {
+            m_buffer.clear();
+            m_buffer.push_back(value_type(0), m_buffer.size_max());
+        }
+
+        // Index, relative to the front of m_buffer, of the value delayed by delay relative to the first value of the last block of n values
+        inline int index_nolock(int n, int delay) const {
+            int r = m_buffer.size() - n - delay;
+            assert(r >= 0);
+            assert(r+n <= m_buffer.size());
+            return r;
+        }
+
+        // out[k] = gain*x[r+k] if overwrite, out[k] += gain*x[r+k] otherwise, where x[r] is the value at index r from the front.
+        // In at most two contiguous passes, one in each segment of m_buffer.
+        inline void accumulate_nolock(value_type* out, int n, int r, value_type gain, bool overwrite) const {
+            segment_pair<const value_type> segs = m_buffer.segments();
+            int seg1size = std::min(n, std::max(0, segs.first.size() - r));
+            if (seg1size > 0) {
+                if (overwrite)
+                    simd::copy_scale(out, segs.first.data()+r, gain, seg1size);
+                else
+                    simd::multiply_accumulate(out, segs.first.data()+r, gain, seg1size);
+            }
+            if (n > seg1size) {
+                const value_type* p2 = segs.second.data() + (r+seg1size - segs.first.size());
+                if (overwrite)
+                    simd::copy_scale(out+seg1size, p2, gain, n-seg1size);
+                else
+                    simd::multiply_accumulate(out+seg1size, p2, gain, n-seg1size);
+            }
+        }
+
+        // Splits a fractional delay into its integer part and its fractional part in [0, 1)
+        static inline int split_delay(value_type delay, value_type* frac) {
+            assert(delay >= value_type(0));
+            int delay_int = static_cast<int>(delay);
+            *frac = delay - static_cast<value_type>(delay_int);
+            return delay_int;
+        }
+
+     public:
+        delayline() {
+        }
+        //! For stateful allocators (ex. allocator_arena<T>). Doesn't allocate.
+        explicit delayline(const allocator_type& allocator)
+            : m_buffer(allocator) {
+        }
+
+        //! Allocate a new memory block, for delays up to delay_max and blocks of up to block_size_max values.
+        //  The history is filled with zeros.
+        inline void resize_allocation(int delay_max, int block_size_max) {
+            assert(delay_max >= 0);
+            assert(block_size_max > 0);
+            ACBENCH_MUTEX_GUARD
+            m_buffer.resize_allocation(delay_max + block_size_max + interpolation_margin);
+            m_delay_max = delay_max;
+            m_block_size_max = block_size_max;
+            clear_nolock();
+        }
+
+        //! Fills the history with zeros. Does keep the allocation
+        inline void clear() {
+            ACBENCH_MUTEX_GUARD
+            clear_nolock();
+        }
+
+        inline void lock() {
+            ACBENCH_MUTEX_LOCK
+        }
+        inline void unlock() {
+            ACBENCH_MUTEX_UNLOCK
+        }
+        //! This is usefull to build a guard object out of the delayline's mutex.
+        inline lock_type& mutex() const {
+            return m_mutex;
+        }
+        inline bool is_thread_safe() const {
+            return !std::is_same<lock_type, lock_none>::value;
+        }
+
+        inline int delay_max() const {
+            return m_delay_max;           // Atomic, no need of locked mutex
+        }
+        inline int block_size_max() const {
+            return m_block_size_max;      // Atomic, no need of locked mutex
+        }
+        //! The history, from the oldest value to the last written one.
+        //  WARNING: Not thread-safe
+        inline const ringbuffer<T, lock_none, Allocator>& buffer() const {
+            return m_buffer;
+        }
+
+        //! Writes a block of n values (at most block_size_max()), dropping the n oldest ones.
+        inline void write_nolock(const value_type* block, int n) {
+            assert(n <= m_block_size_max);
+            m_buffer.pop_front_nolock(n);
+            m_buffer.push_back_nolock(block, n);
+        }
+        inline void write(const value_type* block, int n) {
+            ACBENCH_MUTEX_GUARD
+            write_nolock(block, n);
+        }
+
+        //! out[k] = in[k-delay], in being the last block of n written values, with 0 <= delay <= delay_max()
+        inline void read_nolock(value_type* out, int n, int delay) const {
+            assert((delay >= 0) && (delay <= m_delay_max));
+            const value_type* pdata1;
+            const value_type* pdata2;
+            int size1, size2;
+            int r = index_nolock(n, delay);
+            m_buffer.read_peek_nolock(r+n, &pdata1, &size1, &pdata2, &size2);
+            int seg1size = std::min(n, std::max(0, size1 - r));
+            std::memcpy(reinterpret_cast<void*>(out), reinterpret_cast<const void*>(pdata1+r), sizeof(value_type)*static_cast<std::size_t>(seg1size));
+            if (n > seg1size)
+                std::memcpy(reinterpret_cast<void*>(out+seg1size), reinterpret_cast<const void*>(pdata2+(r+seg1size-size1)), sizeof(value_type)*static_cast<std::size_t>(n-seg1size));
+        }
+        inline void read(value_type* out, int n, int delay) const {
+            ACBENCH_MUTEX_GUARD
+            read_nolock(out, n, delay);
+        }
+
+        //! out[k] = sum_j gains[j]*in[k-delays[j]] (a multi-tap delay), with nb_taps >= 1
+        inline void read_taps_nolock(value_type* out, int n, const int* delays, const value_type* gains, int nb_taps) const {
+            assert(nb_taps >= 1);
+            for (int j = 0; j < nb_taps; ++j) {
+                assert((delays[j] >= 0) && (delays[j] <= m_delay_max));
+                accumulate_nolock(out, n, index_nolock(n, delays[j]), gains[j], j == 0);
+            }
+        }
+        inline void read_taps(value_type* out, int n, const int* delays, const value_type* gains, int nb_taps) const {
+            ACBENCH_MUTEX_GUARD
+            read_taps_nolock(out, n, delays, gains, nb_taps);
+        }
+
+        //! Linear interpolation, with 0 <= delay <= delay_max()
+        inline void read_linear_nolock(value_type* out, int n, value_type delay) const {
+            assert(delay <= static_cast<value_type>(m_delay_max));
+            value_type frac;
+            int delay_int = split_delay(delay, &frac);
+            accumulate_nolock(out, n, index_nolock(n, delay_int), value_type(1)-frac, true);
+            accumulate_nolock(out, n, index_nolock(n, delay_int+1), frac, false);
+        }
+        inline void read_linear(value_type* out, int n, value_type delay) const {
+            ACBENCH_MUTEX_GUARD
+            read_linear_nolock(out, n, delay);
+        }
+
+        //! 3rd order Lagrange interpolation (over the values delayed by delay_int-1 to delay_int+2), with 1 <= delay <= delay_max()
+        inline void read_cubic_nolock(value_type* out, int n, value_type delay) const {
+            assert((delay >= value_type(1)) && (delay <= static_cast<value_type>(m_delay_max)));
+            value_type frac;
+            int delay_int = split_delay(delay, &frac);
+            value_type d = value_type(1) + frac;  // Delay relative to the first value
+            value_type h0 = -(d-1)*(d-2)*(d-3)/6;
+            value_type h1 = d*(d-2)*(d-3)/2;
+            value_type h2 = -d*(d-1)*(d-3)/2;
+            value_type h3 = d*(d-1)*(d-2)/6;
+            accumulate_nolock(out, n, index_nolock(n, delay_int-1), h0, true);
+            accumulate_nolock(out, n, index_nolock(n, delay_int), h1, false);
+            accumulate_nolock(out, n, index_nolock(n, delay_int+1), h2, false);
+            accumulate_nolock(out, n, index_nolock(n, delay_int+2), h3, false);
+        }
+        inline void read_cubic(value_type* out, int n, value_type delay) const {
+            ACBENCH_MUTEX_GUARD
+            read_cubic_nolock(out, n, delay);
+        }
+
+        //! 1st order allpass interpolation, with 0 <= delay <= delay_max():
+        //      out[k] = a*in[k-delay_int] + in[k-delay_int-1] - a*out[k-1],  a = (1-frac)/(1+frac)
+        //  `state` is out[-1] on input, and the last value of out on output.
+        //  The feedforward part is vectorized, the feedback part is a scalar recursion.
+        inline void read_allpass_nolock(value_type* out, int n, value_type delay, value_type* state) const {
+            assert(delay <= static_cast<value_type>(m_delay_max));
+            value_type frac;
+            int delay_int = split_delay(delay, &frac);
+            value_type a = (value_type(1)-frac) / (value_type(1)+frac);
+            accumulate_nolock(out, n, index_nolock(n, delay_int), a, true);
+            accumulate_nolock(out, n, index_nolock(n, delay_int+1), value_type(1), false);
+            value_type prev = *state;
+            for (int k = 0; k < n; ++k) {
+                prev = out[k] - a*prev;
+                out[k] = prev;
+            }
+            *state = prev;
+        }
+        inline void read_allpass(value_type* out, int n, value_type delay, value_type* state) const {
+            ACBENCH_MUTEX_GUARD
+            read_allpass_nolock(out, n, delay, state);
+        }
+    };
+
+}  // namespace acbench
+
+#endif  // ACBENCH_DELAYLINE_H_
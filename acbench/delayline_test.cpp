@@ -0,0 +1,167 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#include <acbench/delayline.h>
+
+#include "utils.h"
+
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+// The whole signal written so far, with zeros before the beginning
+class reference_signal {
+    std::vector<double> m_signal;
+ public:
+    void write(const float* block, int n) {
+        for (int k = 0; k < n; ++k)
+            m_signal.push_back(block[k]);
+    }
+    // Value delayed by delay relative to the k-th value of the last block of n values
+    double at(int n, int k, int delay) const {
+        int t = static_cast<int>(m_signal.size()) - n + k - delay;
+        return t >= 0 ? m_signal[t] : 0.0;
+    }
+};
+
+TEST_CASE("delayline_allocation") {
+    acbench::delayline<float> test;
+    REQUIRE(test.delay_max() == 0);
+    REQUIRE(test.is_thread_safe());
+
+    test.resize_allocation(100, 16);
+    REQUIRE(test.delay_max() == 100);
+    REQUIRE(test.block_size_max() == 16);
+    REQUIRE(test.buffer().size() == 100+16+acbench::delayline<float>::interpolation_margin);
+    for (int n = 0; n < test.buffer().size(); ++n)
+        REQUIRE(test.buffer()[n] == 0.0f);
+
+    float block[16];
+    for (int k = 0; k < 16; ++k)
+        block[k] = 1.0f;
+    test.write(block, 16);
+    REQUIRE(test.buffer()[test.buffer().size()-1] == 1.0f);
+    test.clear();
+    REQUIRE(test.buffer()[test.buffer().size()-1] == 0.0f);
+
+    acbench::delayline<double, acbench::lock_none> test_nolock;
+    REQUIRE(!test_nolock.is_thread_safe());
+    test_nolock.lock();
+    test_nolock.unlock();
+    acbench::lock_guard<acbench::lock_none> guard(test_nolock.mutex());
+}
+
+TEST_CASE("delayline_read") {
+    const int delay_max = 100;
+    const int block_size_max = 32;
+    acbench::delayline<float> test;
+    test.resize_allocation(delay_max, block_size_max);
+    reference_signal ref;
+
+    std::vector<float> block(block_size_max);
+    std::vector<float> out(block_size_max);
+    const int delays[3] = {0, 37, delay_max};
+    const float gains[3] = {0.5f, -0.25f, 1.0f};
+
+    // Blocks of various sizes, so that the wrap point is everywhere
+    for (int iter = 0; iter < 50; ++iter) {
+        int n = 1 + (iter*7)%block_size_max;
+        for (int k = 0; k < n; ++k)
+            block[k] = 2.0f*acbench::rand_uniform_continuous_01<float>() - 1.0f;
+        test.write(block.data(), n);
+        ref.write(block.data(), n);
+
+        // Integer delays
+        for (int delay : {0, 1, n, 53, delay_max}) {
+            test.read(out.data(), n, delay);
+            for (int k = 0; k < n; ++k)
+                REQUIRE(out[k] == static_cast<float>(ref.at(n, k, delay)));
+        }
+
+        // Multi-tap
+        test.read_taps(out.data(), n, delays, gains, 3);
+        for (int k = 0; k < n; ++k) {
+            double expected = 0.0;
+            for (int j = 0; j < 3; ++j)
+                expected += gains[j]*ref.at(n, k, delays[j]);
+            REQUIRE(std::abs(out[k] - expected) < 1e-5);
+        }
+
+        // Linear interpolation
+        for (float delay : {0.0f, 0.25f, 10.5f, 99.75f, 100.0f}) {
+            test.read_linear(out.data(), n, delay);
+            int di = static_cast<int>(delay);
+            double frac = delay - di;
+            for (int k = 0; k < n; ++k) {
+                double expected = (1.0-frac)*ref.at(n, k, di) + frac*ref.at(n, k, di+1);
+                REQUIRE(std::abs(out[k] - expected) < 1e-5);
+            }
+        }
+
+        // Cubic interpolation
+        for (float delay : {1.0f, 1.5f, 20.25f, 100.0f}) {
+            test.read_cubic(out.data(), n, delay);
+            int di = static_cast<int>(delay);
+            double d = 1.0 + (delay - di);
+            double h[4] = {-(d-1)*(d-2)*(d-3)/6, d*(d-2)*(d-3)/2, -d*(d-1)*(d-3)/2, d*(d-1)*(d-2)/6};
+            for (int k = 0; k < n; ++k) {
+                double expected = 0.0;
+                for (int j = 0; j < 4; ++j)
+                    expected += h[j]*ref.at(n, k, di-1+j);
+                REQUIRE(std::abs(out[k] - expected) < 1e-5);
+            }
+        }
+        // Integer delays are exact
+        test.read_cubic(out.data(), n, 20.0f);
+        for (int k = 0; k < n; ++k)
+            REQUIRE(std::abs(out[k] - ref.at(n, k, 20)) < 1e-6);
+    }
+}
+
+TEST_CASE("delayline_allpass") {
+    acbench::delayline<float, acbench::lock_none> test;
+    test.resize_allocation(50, 16);
+    reference_signal ref;
+
+    std::vector<float> block(16);
+    std::vector<float> out(16);
+    float state = 0.0f;
+    double state_ref = 0.0;
+    const float delay = 12.4f;
+    const double a = (1.0-0.4)/(1.0+0.4);
+    for (int iter = 0; iter < 20; ++iter) {
+        for (int k = 0; k < 16; ++k)
+            block[k] = 2.0f*acbench::rand_uniform_continuous_01<float>() - 1.0f;
+        test.write(block.data(), 16);
+        ref.write(block.data(), 16);
+
+        test.read_allpass(out.data(), 16, delay, &state);
+        for (int k = 0; k < 16; ++k) {
+            state_ref = a*ref.at(16, k, 12) + ref.at(16, k, 13) - a*state_ref;
+            REQUIRE(std::abs(out[k] - state_ref) < 1e-4);
+        }
+        REQUIRE(state == out[15]);
+    }
+
+    // A frequency much lower than Nyquist is delayed by about the fractional delay
+    test.clear();
+    state = 0.0f;
+    const double freq = 0.01;  // [cycles/sample]
+    int t = 0;
+    for (int iter = 0; iter < 20; ++iter) {
+        for (int k = 0; k < 16; ++k, ++t)
+            block[k] = static_cast<float>(std::sin(2*3.14159265358979*freq*t));
+        test.write(block.data(), 16);
+        test.read_allpass(out.data(), 16, delay, &state);
+    }
+    for (int k = 0; k < 16; ++k) {
+        double expected = std::sin(2*3.14159265358979*freq*(t-16+k-delay));
+        REQUIRE(std::abs(out[k] - expected) < 1e-2);
+    }
+}
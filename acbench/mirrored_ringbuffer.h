@@ -0,0 +1,352 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#ifndef ACBENCH_MIRRORED_RINGBUFFER_H_
+#define ACBENCH_MIRRORED_RINGBUFFER_H_
+
+/**
+
+Mirrored ringbuffer (aka "magic" ringbuffer), Linux only.
+
+    The allocated memory pages are mapped twice in a row in the virtual address space,
+    so that data()[n] and data()[n+capacity()] are the same value.
+    Any segment of at most capacity() values starting within [0, capacity()) is thus contiguous:
+        * push_back(.) and pop_front(.) are always a single memcpy, there is no wrap-around logic.
+        * operator[](int) has no modulo.
+        * front_data() gives a pointer to the size() contiguous values of the buffer.
+
+Allocation:
+    Same as acbench::ringbuffer, only resize_allocation(.) allocates memory (and the destructor deallocates it).
+    The allocation is rounded up to a multiple of the memory page size (and of sizeof(T), if it doesn't divide
+    the page size), so capacity() can be bigger than requested.
+    Throws std::bad_alloc if the mapping fails.
+
+Thread-safety:
+    Same as acbench::ringbuffer, chosen with the Lock template argument (std::mutex, lock_spinlock or lock_none).
+
+**/
+
+#if defined(__linux__)
+
+#include <acbench/ringbuffer.h>  // For the locking policies
+
+#include <new>          // For std::bad_alloc
+#include <sys/mman.h>   // For mmap(.) and memfd_create(.)
+#include <unistd.h>     // For ftruncate(.), close(.) and sysconf(.)
+
+
+namespace acbench {
+
+    template<typename T, typename Lock = lock_default>
+    class mirrored_ringbuffer {
+     public:
+        typedef T value_type;
+        typedef Lock lock_type;
+
+     protected:
+        ACBENCH_MUTEX_DECLARE
+
+        int m_size_max = 0;
+        int m_size = 0;
+        T* m_data = nullptr;
+        int m_front = 0;
+        int m_end = 0;  // One after the last element
+
+        // Also clears, so that the buffer is consistently empty if the following allocation throws.
+        inline void destroy_nolock() {
+            if ( m_data ) {
+                munmap(reinterpret_cast<void*>(m_data), 2*sizeof(value_type)*static_cast<size_t>(m_size_max));
+                m_data = nullptr;
+                m_size_max = 0;
+            }
+            this->clear_nolock();
+        }
+
+        // Copy constructor is forbidden to avoid implicit calls.
+        explicit mirrored_ringbuffer(const mirrored_ringbuffer& rb) {
+            (void)rb;
+        }
+        // So is copy assignment (the mapping would be shared and unmapped twice).
+        mirrored_ringbuffer& operator=(const mirrored_ringbuffer&) = delete;
+
+        inline void clear_nolock() {
+            m_front = 0;
+            m_end = 0;
+            m_size = 0;
+        }
+
+     public:
+        //! Only allowed constructor
+        mirrored_ringbuffer() {
+        }
+        ~mirrored_ringbuffer() {
+            ACBENCH_MUTEX_GUARD
+            this->destroy_nolock();
+        }
+
+        //! Allocate a new memory block and clear any previous data.
+        //  The allocation is rounded up to a multiple of lcm(page size, sizeof(T)), so that the second view
+        //  starts exactly capacity() values after the first one, whatever the size of T (ex. a 12 bytes frame).
+        inline void resize_allocation(int size_max) {
+            assert(size_max > 0);
+            ACBENCH_MUTEX_GUARD
+
+            const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            size_t gcd = page_size;
+            for (size_t b = sizeof(value_type); b != 0; ) {
+                size_t r = gcd % b;
+                gcd = b;
+                b = r;
+            }
+            const size_t granularity = (page_size/gcd)*sizeof(value_type);
+            size_t nb_bytes = sizeof(value_type)*static_cast<size_t>(size_max);
+            nb_bytes = ((nb_bytes + granularity - 1) / granularity) * granularity;
+
+            if (static_cast<int>(nb_bytes/sizeof(value_type)) == m_size_max) {
+                this->clear_nolock();
+                return;
+            }
+            this->destroy_nolock();
+
+            int fd = memfd_create("acbench_mirrored_ringbuffer", 0);
+            if (fd < 0)
+                throw std::bad_alloc();  // GCOVR_EXCL_LINE
+            if (ftruncate(fd, static_cast<off_t>(nb_bytes)) != 0) {
+                close(fd);               // GCOVR_EXCL_LINE
+                throw std::bad_alloc();  // GCOVR_EXCL_LINE
+            }
+
+            // Reserve the address space for the two views, then map the same pages on each half.
+            char* paddr = reinterpret_cast<char*>(mmap(nullptr, 2*nb_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            bool ok = (paddr != MAP_FAILED);
+            ok = ok && (mmap(paddr, nb_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED);
+            ok = ok && (mmap(paddr+nb_bytes, nb_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED);
+            close(fd);  // The mappings keep the memory alive
+            if (!ok) {
+                if (paddr != MAP_FAILED)    // GCOVR_EXCL_LINE
+                    munmap(paddr, 2*nb_bytes);  // GCOVR_EXCL_LINE
+                throw std::bad_alloc();     // GCOVR_EXCL_LINE
+            }
+
+            m_data = reinterpret_cast<value_type*>(paddr);
+            m_size_max = static_cast<int>(nb_bytes/sizeof(value_type));
+
+            this->clear_nolock();
+        }
+
+        //! Does keep the allocation
+        inline void clear() {
+            ACBENCH_MUTEX_GUARD
+            this->clear_nolock();
+        }
+
+        inline void lock() {
+            ACBENCH_MUTEX_LOCK
+        }
+        inline void unlock() {
+            ACBENCH_MUTEX_UNLOCK
+        }
+        inline bool is_thread_safe() const {
+            return !std::is_same<lock_type, lock_none>::value;
+        }
+
+        inline value_type* data() const {
+            return m_data;                // Atomic, no need of locked mutex
+        }
+        inline int capacity() const {
+            return m_size_max;            // Atomic, no need of locked mutex
+        }
+        inline int size_max() const {
+            return capacity();            // Atomic, no need of locked mutex
+        }
+        inline int size() const {
+            return m_size;                // Atomic, no need of locked mutex
+        }
+        inline bool empty() const {
+            return m_size == 0;           // Atomic, no need of locked mutex
+        }
+        //! Pointer to the size() contiguous values of the buffer, from front to back.
+        //  WARNING: Not thread-safe
+        inline value_type* front_data() const {
+            return m_data + m_front;
+        }
+        inline value_type front() const {
+            assert(m_size > 0);
+            ACBENCH_MUTEX_GUARD
+            return m_data[m_front];
+        }
+        inline value_type back() const {
+            assert(m_size > 0);
+            ACBENCH_MUTEX_GUARD
+            return m_data[m_front+m_size-1];
+        }
+
+        //! WARNING: Not thread-safe
+        value_type operator[](int n) const {
+            assert((n >= 0) && (n < m_size));
+            return m_data[m_front+n];
+        }
+        //! WARNING: Not thread-safe
+        value_type& operator[](int n) {
+            assert((n >= 0) && (n < m_size));
+            return m_data[m_front+n];
+        }
+
+        inline void push_back_nolock(const value_type v) {
+            assert(m_size+1 <= m_size_max);
+            m_data[m_end] = v;
+            if (++m_end >= m_size_max)
+                m_end = 0;
+            ++m_size;
+        }
+        inline void push_back(const value_type v) {
+            ACBENCH_MUTEX_GUARD
+            push_back_nolock(v);
+        }
+        inline void push_back_nolock(const value_type value, int nb_values) {
+            if (nb_values <= 0)             // Ignore pushing no values
+                return;
+            assert(m_size+nb_values <= m_size_max);
+
+            value_type* pdata = m_data+m_end;
+            for (int k=0; k < nb_values; ++k)
+                *pdata++ = value;
+
+            m_end += nb_values;
+            if (m_end >= m_size_max)
+                m_end -= m_size_max;
+            m_size += nb_values;
+        }
+        inline void push_back(const value_type value, int nb_values) {
+            ACBENCH_MUTEX_GUARD
+            push_back_nolock(value, nb_values);
+        }
+        inline void push_back_nolock(const value_type* array, int array_size) {
+            if (array_size <= 0)             // Ignore push of empty buffers
+                return;
+            assert(m_size+array_size <= m_size_max);
+
+            std::memcpy(reinterpret_cast<void*>(m_data+m_end), reinterpret_cast<const void*>(array), sizeof(value_type)*static_cast<size_t>(array_size));
+
+            m_end += array_size;
+            if (m_end >= m_size_max)
+                m_end -= m_size_max;
+            m_size += array_size;
+        }
+        inline void push_back(const value_type* array, int array_size) {
+            ACBENCH_MUTEX_GUARD
+            push_back_nolock(array, array_size);
+        }
+
+        inline value_type pop_front_nolock() {
+            assert(m_size >= 1);
+            value_type value = m_data[m_front];
+            if (++m_front >= m_size_max)
+                m_front = 0;
+            --m_size;
+            return value;
+        }
+        inline value_type pop_front() {
+            ACBENCH_MUTEX_GUARD
+            return pop_front_nolock();
+        }
+        inline void pop_front_nolock(int n) {
+            if (n < 1) return;                // Just ignore pops of non-existing values
+
+            if (n >= m_size) {                // Clears all if not enough to be poped
+                clear_nolock();
+                return;
+            }
+
+            m_front += n;
+            if (m_front >= m_size_max)
+                m_front -= m_size_max;
+            m_size -= n;
+        }
+        inline void pop_front(int n) {
+            ACBENCH_MUTEX_GUARD
+            pop_front_nolock(n);
+        }
+        inline int pop_front_nolock(value_type* array, int n) {
+            if (n < 1) return 0;              // Just ignore pops of non-existing values
+
+            if (n > m_size)                   // Pop as many values as possible
+                n = m_size;
+
+            std::memcpy(reinterpret_cast<void*>(array), reinterpret_cast<const void*>(m_data+m_front), sizeof(value_type)*static_cast<size_t>(n));
+
+            m_front += n;
+            if (m_front >= m_size_max)
+                m_front -= m_size_max;
+            m_size -= n;
+
+            return n;
+        }
+        inline int pop_front(value_type* array, int n) {
+            ACBENCH_MUTEX_GUARD
+            return pop_front_nolock(array, n);
+        }
+
+        // Zero-copy access, same interface as acbench::ringbuffer, though the second region is always empty.
+
+        inline int write_reserve_nolock(int n, value_type** pdata1, int* size1, value_type** pdata2, int* size2) {
+            if (n > m_size_max - m_size)      // Reserve as many values as possible
+                n = m_size_max - m_size;
+            if (n < 0)
+                n = 0;
+            *pdata1 = m_data + m_end;
+            *size1 = n;
+            *pdata2 = nullptr;
+            *size2 = 0;
+            return n;
+        }
+        inline int write_reserve(int n, value_type** pdata1, int* size1, value_type** pdata2, int* size2) {
+            ACBENCH_MUTEX_GUARD
+            return write_reserve_nolock(n, pdata1, size1, pdata2, size2);
+        }
+        inline void write_commit_nolock(int n) {
+            if (n < 1) return;                // Ignore pushing no values
+            assert(m_size+n <= m_size_max);
+            m_end += n;
+            if (m_end >= m_size_max)
+                m_end -= m_size_max;
+            m_size += n;
+        }
+        inline void write_commit(int n) {
+            ACBENCH_MUTEX_GUARD
+            write_commit_nolock(n);
+        }
+        inline int read_peek_nolock(int n, const value_type** pdata1, int* size1, const value_type** pdata2, int* size2) const {
+            if (n > m_size)                   // Peek as many values as possible
+                n = m_size;
+            if (n < 0)
+                n = 0;
+            *pdata1 = m_data + m_front;
+            *size1 = n;
+            *pdata2 = nullptr;
+            *size2 = 0;
+            return n;
+        }
+        inline int read_peek(int n, const value_type** pdata1, int* size1, const value_type** pdata2, int* size2) const {
+            ACBENCH_MUTEX_GUARD
+            return read_peek_nolock(n, pdata1, size1, pdata2, size2);
+        }
+        inline void read_consume_nolock(int n) {
+            pop_front_nolock(n);
+        }
+        inline void read_consume(int n) {
+            ACBENCH_MUTEX_GUARD
+            read_consume_nolock(n);
+        }
+    };
+
+}  // namespace acbench
+
+#endif  // defined(__linux__)
+
+#endif  // ACBENCH_MIRRORED_RINGBUFFER_H_
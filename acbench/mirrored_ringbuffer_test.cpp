@@ -0,0 +1,193 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#include <acbench/mirrored_ringbuffer.h>
+
+#include "utils.h"
+
+#include <deque>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+typedef acbench::mirrored_ringbuffer<float> test_t;
+typedef std::deque<float> ref_t;
+
+template<typename ringbuffer1_t, typename ringbuffer2_t>
+void rb_require_equals(ringbuffer1_t& rb1, ringbuffer2_t& rb2) {
+    REQUIRE(int(rb1.size()) == int(rb2.size()));
+    for (int i=0; i < rb1.size(); ++i)
+        REQUIRE(rb1[i] == rb2[i]);
+}
+
+TEST_CASE("mirrored_ringbuffer_allocation") {
+    test_t test;
+    REQUIRE(test.data() == nullptr);
+    REQUIRE(test.capacity() == 0);
+
+    test.resize_allocation(100);
+    REQUIRE(test.capacity() >= 100);
+    REQUIRE((test.capacity()*sizeof(float)) % 4096 == 0);
+    REQUIRE(test.size_max() == test.capacity());
+    REQUIRE(test.empty());
+    REQUIRE(test.is_thread_safe());
+
+    // Both halves are the same memory
+    test.data()[0] = 1.0f;
+    REQUIRE(test.data()[test.capacity()] == 1.0f);
+    test.data()[2*test.capacity()-1] = 2.0f;
+    REQUIRE(test.data()[test.capacity()-1] == 2.0f);
+
+    // Same size: only clears
+    float* pdata = test.data();
+    test.push_back(1.0f);
+    test.resize_allocation(100);
+    REQUIRE(test.data() == pdata);
+    REQUIRE(test.empty());
+
+    test.resize_allocation(test.capacity()+1);
+    REQUIRE(test.capacity() >= 2048);
+
+    acbench::mirrored_ringbuffer<double, acbench::lock_none> test_double;
+    test_double.resize_allocation(10);
+    REQUIRE(!test_double.is_thread_safe());
+    REQUIRE(test_double.capacity() >= 512);
+
+    // A value size that doesn't divide the page size: the allocation is rounded up to a multiple of both
+    struct frame { float left, right, gain; };
+    acbench::mirrored_ringbuffer<frame, acbench::lock_none> test_frame;
+    test_frame.resize_allocation(100);
+    REQUIRE(test_frame.capacity() >= 100);
+    REQUIRE((test_frame.capacity()*sizeof(frame)) % 4096 == 0);
+    test_frame.data()[0].gain = 1.0f;
+    REQUIRE(test_frame.data()[test_frame.capacity()].gain == 1.0f);
+    test_frame.data()[2*test_frame.capacity()-1].left = 2.0f;
+    REQUIRE(test_frame.data()[test_frame.capacity()-1].left == 2.0f);
+}
+
+TEST_CASE("mirrored_ringbuffer_push_pop") {
+    test_t test;
+    ref_t ref;
+    test.resize_allocation(1024);
+    int capacity = test.capacity();
+
+    std::vector<float> data(capacity);
+    for (int i = 0; i < capacity; ++i)
+        data[i] = acbench::rand_uniform_continuous_01<float>();
+    std::vector<float> out(capacity);
+
+    // Shortcuts
+    test.push_back(data.data(), 0);
+    test.push_back(1.0f, 0);
+    test.pop_front(0);
+    REQUIRE(test.pop_front(out.data(), 0) == 0);
+    REQUIRE(test.empty());
+
+    // Move the front around the buffer many times, with chunks crossing the mirror boundary
+    int chunk_size = 300;
+    for (int iter = 0; iter < 20; ++iter) {
+        test.push_back(data.data(), chunk_size);
+        for (int i = 0; i < chunk_size; ++i)
+            ref.push_back(data[i]);
+        test.push_back(0.5f, 7);
+        for (int i = 0; i < 7; ++i)
+            ref.push_back(0.5f);
+        test.push_back(0.25f);
+        ref.push_back(0.25f);
+        rb_require_equals(test, ref);
+
+        // The content is always contiguous
+        const float* pfront = test.front_data();
+        for (int i = 0; i < test.size(); ++i)
+            REQUIRE(pfront[i] == ref[i]);
+        REQUIRE(test.front() == ref.front());
+        REQUIRE(test.back() == ref.back());
+
+        int n = test.pop_front(out.data(), chunk_size);
+        REQUIRE(n == chunk_size);
+        for (int i = 0; i < n; ++i) {
+            REQUIRE(out[i] == ref.front());
+            ref.pop_front();
+        }
+        test.pop_front(3);
+        for (int i = 0; i < 3; ++i)
+            ref.pop_front();
+        REQUIRE(test.pop_front() == ref.front());
+        ref.pop_front();
+        rb_require_equals(test, ref);
+    }
+
+    // Fill completely, then pop more than available
+    test.clear();
+    ref.clear();
+    test.push_back(data.data(), capacity-1);
+    test.push_back(2.0f);
+    REQUIRE(test.size() == capacity);
+    test[0] = 3.0f;
+    REQUIRE(test.front() == 3.0f);
+    REQUIRE(test.pop_front(out.data(), capacity+10) == capacity);
+    REQUIRE(test.empty());
+
+    test.push_back(data.data(), 10);
+    test.pop_front(20);
+    REQUIRE(test.empty());
+
+    // Repeated values and pops across the end of the allocation
+    test.push_back(0.0f, capacity-2);
+    test.pop_front(capacity-3);
+    test.push_back(0.5f, 5);
+    REQUIRE(test.size() == 6);
+    test.pop_front(4);
+    REQUIRE(test.size() == 2);
+    REQUIRE(test.front() == 0.5f);
+    REQUIRE(test.back() == 0.5f);
+    test.clear();
+
+    // Single values across the end of the first view
+    for (int i = 0; i < capacity+5; ++i) {
+        test.push_back(static_cast<float>(i));
+        REQUIRE(test.pop_front() == static_cast<float>(i));
+    }
+}
+
+TEST_CASE("mirrored_ringbuffer_zero_copy") {
+    test_t test;
+    test.resize_allocation(1024);
+    int capacity = test.capacity();
+
+    float* pw1 = nullptr; float* pw2 = nullptr;
+    const float* pr1 = nullptr; const float* pr2 = nullptr;
+    int size1 = 0, size2 = 0;
+
+    test.push_back(0.0f, capacity-10);
+    test.pop_front(capacity-20);
+
+    // Crosses the end of the first view, but always a single region
+    REQUIRE(test.write_reserve(100, &pw1, &size1, &pw2, &size2) == 100);
+    REQUIRE(size1 == 100);
+    REQUIRE(pw2 == nullptr);
+    REQUIRE(size2 == 0);
+    for (int i = 0; i < size1; ++i)
+        pw1[i] = static_cast<float>(i);
+    test.write_commit(100);
+    REQUIRE(test.size() == 110);
+    REQUIRE(test.write_reserve(capacity, &pw1, &size1, &pw2, &size2) == capacity-110);
+
+    REQUIRE(test.read_peek(capacity, &pr1, &size1, &pr2, &size2) == 110);
+    REQUIRE(size1 == 110);
+    REQUIRE(size2 == 0);
+    for (int i = 0; i < 100; ++i)
+        REQUIRE(pr1[10+i] == static_cast<float>(i));
+    test.read_consume(110);
+    REQUIRE(test.empty());
+
+    // Shortcuts
+    test.write_commit(0);
+    REQUIRE(test.write_reserve(-1, &pw1, &size1, &pw2, &size2) == 0);
+    REQUIRE(test.read_peek(-1, &pr1, &size1, &pr2, &size2) == 0);
+}
@@ -0,0 +1,373 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#ifndef ACBENCH_MULTICHANNEL_RINGBUFFER_H_
+#define ACBENCH_MULTICHANNEL_RINGBUFFER_H_
+
+/**
+
+Multichannel ringbuffer.
+
+    All the channels are held in a single allocation and share the same front and end,
+    so that pushing or popping a chunk of frames locks a single mutex and updates a single set of indices,
+    instead of one acbench::ringbuffer per channel.
+    Sizes and indices are in frames (one value per channel).
+
+Layouts:
+    Chosen when allocating, with resize_allocation(nb_channels, size_max, layout):
+        planar      (default) Each channel is a contiguous ringbuffer of capacity() values.
+                    Best to process each channel separately (see channel_segments(.)).
+        interleaved The values of a frame are contiguous, the frames follow each other.
+                    Best when exchanging interleaved data with audio devices and files.
+
+    Both layouts accept and provide both formats:
+        push_back(const T* const* channels, int nb_frames)  An array of one pointer per channel (planar data).
+        push_back_interleaved(const T* frames, int nb_frames) Interleaved data.
+        Same for pop_front(.) and pop_front_interleaved(.).
+    The (de)interleaving, if any, is done while copying.
+
+Allocation:
+    Same as acbench::ringbuffer, only resize_allocation(.) allocates memory (and the destructor deallocates it).
+    There is no dynamic allocation.
+
+Thread-safety:
+    Same as acbench::ringbuffer, chosen with the Lock template argument (std::mutex, lock_spinlock or lock_none).
+
+**/
+
+#include <acbench/ringbuffer.h>  // For the locking and allocation policies, and acbench::segment
+
+
+namespace acbench {
+
+    enum class channel_layout {
+        planar,
+        interleaved
+    };
+
+    template<typename T, typename Lock = lock_default, typename Allocator = allocator_new<T>>
+    class multichannel_ringbuffer {
+     public:
+        typedef T value_type;
+        typedef Lock lock_type;
+        typedef Allocator allocator_type;
+
+     protected:
+        ACBENCH_MUTEX_DECLARE
+
+        allocator_type m_allocator;
+
+        int m_nb_channels = 0;
+        channel_layout m_layout = channel_layout::planar;
+        int m_size_max = 0;  // In frames
+        int m_size = 0;      // In frames
+        T* m_data = nullptr;
+        int m_front = 0;     // In frames
+        int m_end = 0;       // In frames. One after the last frame
+
+        inline void destroy_nolock() {
+            if ( m_data ) {
+                m_allocator.deallocate(m_data, static_cast<std::size_t>(m_nb_channels)*static_cast<std::size_t>(m_size_max));
+                m_data = nullptr;
+            }
+        }
+
+        // Copy constructor is forbidden to avoid implicit calls.
+        explicit multichannel_ringbuffer(const multichannel_ringbuffer& rb) {
+            (void)rb;
+        }
+        // So is copy assignment (the allocation would be shared and deallocated twice).
+        multichannel_ringbuffer& operator=(const multichannel_ringbuffer&) = delete;
+
+        // The segments of the frames stored from pbase, of stride values each (V being value_type or const value_type).
+        template<typename V>
+        inline segment_pair<V> segments_of(V* pbase, int stride) const {
+            segment_pair<V> segs;
+            int seg1size = std::min(m_size, m_size_max - m_front);
+            segs.first = segment<V>(pbase + m_front*stride, seg1size*stride);
+            if (seg1size < m_size)
+                segs.second = segment<V>(pbase, (m_size - seg1size)*stride);
+            return segs;
+        }
+
+        static inline void memory_copy_nolock(value_type* pdest, const value_type* psrc, int size) {
+            std::memcpy(reinterpret_cast<void*>(pdest), reinterpret_cast<const void*>(psrc), sizeof(value_type)*static_cast<size_t>(size));
+        }
+
+        // Copies nb_frames frames from the given source, starting at the frame `offset` in the source, into the storage at the frame `pos`.
+        // The frames must not wrap around the end of the storage.
+        inline void copy_in_planar_nolock(int pos, const value_type* const* channels, int offset, int nb_frames) {
+            if (m_layout == channel_layout::planar) {
+                for (int c = 0; c < m_nb_channels; ++c)
+                    memory_copy_nolock(m_data + c*m_size_max + pos, channels[c] + offset, nb_frames);
+            } else {
+                value_type* pdata = m_data + pos*m_nb_channels;
+                for (int c = 0; c < m_nb_channels; ++c) {
+                    const value_type* pchannel = channels[c] + offset;
+                    for (int n = 0; n < nb_frames; ++n)
+                        pdata[n*m_nb_channels + c] = pchannel[n];
+                }
+            }
+        }
+        inline void copy_in_interleaved_nolock(int pos, const value_type* frames, int offset, int nb_frames) {
+            if (m_layout == channel_layout::interleaved) {
+                memory_copy_nolock(m_data + pos*m_nb_channels, frames + offset*m_nb_channels, nb_frames*m_nb_channels);
+            } else {
+                const value_type* pframes = frames + offset*m_nb_channels;
+                for (int c = 0; c < m_nb_channels; ++c) {
+                    value_type* pchannel = m_data + c*m_size_max + pos;
+                    for (int n = 0; n < nb_frames; ++n)
+                        pchannel[n] = pframes[n*m_nb_channels + c];
+                }
+            }
+        }
+        inline void copy_out_planar_nolock(int pos, value_type* const* channels, int offset, int nb_frames) const {
+            if (m_layout == channel_layout::planar) {
+                for (int c = 0; c < m_nb_channels; ++c)
+                    memory_copy_nolock(channels[c] + offset, m_data + c*m_size_max + pos, nb_frames);
+            } else {
+                const value_type* pdata = m_data + pos*m_nb_channels;
+                for (int c = 0; c < m_nb_channels; ++c) {
+                    value_type* pchannel = channels[c] + offset;
+                    for (int n = 0; n < nb_frames; ++n)
+                        pchannel[n] = pdata[n*m_nb_channels + c];
+                }
+            }
+        }
+        inline void copy_out_interleaved_nolock(int pos, value_type* frames, int offset, int nb_frames) const {
+            if (m_layout == channel_layout::interleaved) {
+                memory_copy_nolock(frames + offset*m_nb_channels, m_data + pos*m_nb_channels, nb_frames*m_nb_channels);
+            } else {
+                value_type* pframes = frames + offset*m_nb_channels;
+                for (int c = 0; c < m_nb_channels; ++c) {
+                    const value_type* pchannel = m_data + c*m_size_max + pos;
+                    for (int n = 0; n < nb_frames; ++n)
+                        pframes[n*m_nb_channels + c] = pchannel[n];
+                }
+            }
+        }
+
+        inline void advance_end_nolock(int nb_frames) {
+            m_end += nb_frames;
+            if (m_end >= m_size_max)
+                m_end -= m_size_max;
+            m_size += nb_frames;
+        }
+        inline void advance_front_nolock(int nb_frames) {
+            m_front += nb_frames;
+            if (m_front >= m_size_max)
+                m_front -= m_size_max;
+            m_size -= nb_frames;
+        }
+
+        inline void clear_nolock() {
+            m_front = 0;
+            m_end = 0;
+            m_size = 0;
+        }
+
+     public:
+        multichannel_ringbuffer() {
+        }
+        //! For stateful allocators (ex. allocator_arena<T>). Doesn't allocate.
+        explicit multichannel_ringbuffer(const allocator_type& allocator)
+            : m_allocator(allocator) {
+        }
+        ~multichannel_ringbuffer() {
+            ACBENCH_MUTEX_GUARD
+            this->destroy_nolock();
+        }
+
+        //! Allocate a new memory block for nb_channels channels of size_max frames and clear any previous data.
+        inline void resize_allocation(int nb_channels, int size_max, channel_layout layout = channel_layout::planar) {
+            assert(nb_channels > 0);
+            assert(size_max > 0);
+            ACBENCH_MUTEX_GUARD
+            m_layout = layout;
+            if (nb_channels != m_nb_channels || size_max != m_size_max) {
+                this->destroy_nolock();
+                m_data = m_allocator.allocate(static_cast<std::size_t>(nb_channels)*static_cast<std::size_t>(size_max));
+                m_nb_channels = nb_channels;
+                m_size_max = size_max;
+            }
+            this->clear_nolock();
+        }
+
+        //! Does keep the allocation
+        inline void clear() {
+            ACBENCH_MUTEX_GUARD
+            this->clear_nolock();
+        }
+
+        inline void lock() {
+            ACBENCH_MUTEX_LOCK
+        }
+        inline void unlock() {
+            ACBENCH_MUTEX_UNLOCK
+        }
+        inline bool is_thread_safe() const {
+            return !std::is_same<lock_type, lock_none>::value;
+        }
+
+        inline value_type* data() const {
+            return m_data;                // Atomic, no need of locked mutex
+        }
+        inline int nb_channels() const {
+            return m_nb_channels;         // Atomic, no need of locked mutex
+        }
+        inline channel_layout layout() const {
+            return m_layout;              // Atomic, no need of locked mutex
+        }
+        //! In frames
+        inline int capacity() const {
+            return m_size_max;            // Atomic, no need of locked mutex
+        }
+        inline int size_max() const {
+            return capacity();            // Atomic, no need of locked mutex
+        }
+        //! In frames
+        inline int size() const {
+            return m_size;                // Atomic, no need of locked mutex
+        }
+        inline int size_free() const {
+            return m_size_max - m_size;   // Atomic, no need of locked mutex
+        }
+        inline bool empty() const {
+            return m_size == 0;           // Atomic, no need of locked mutex
+        }
+
+        //! Value of the given channel in the n-th frame.
+        //  WARNING: Not thread-safe
+        inline value_type operator()(int channel, int n) const {
+            assert((channel >= 0) && (channel < m_nb_channels));
+            assert((n >= 0) && (n < m_size));
+            int idx = m_front + n;
+            if (idx >= m_size_max)
+                idx -= m_size_max;
+            if (m_layout == channel_layout::planar)
+                return m_data[channel*m_size_max + idx];
+            return m_data[idx*m_nb_channels + channel];
+        }
+        //! WARNING: Not thread-safe
+        inline value_type& operator()(int channel, int n) {
+            assert((channel >= 0) && (channel < m_nb_channels));
+            assert((n >= 0) && (n < m_size));
+            int idx = m_front + n;
+            if (idx >= m_size_max)
+                idx -= m_size_max;
+            if (m_layout == channel_layout::planar)
+                return m_data[channel*m_size_max + idx];
+            return m_data[idx*m_nb_channels + channel];
+        }
+
+        //! The content of one channel as (at most) two contiguous segments (planar layout only).
+        //  WARNING: Not thread-safe
+        inline segment_pair<value_type> channel_segments(int channel) {
+            assert(m_layout == channel_layout::planar);
+            assert((channel >= 0) && (channel < m_nb_channels));
+            return segments_of(m_data + channel*m_size_max, 1);
+        }
+        //! WARNING: Not thread-safe
+        inline segment_pair<const value_type> channel_segments(int channel) const {
+            assert(m_layout == channel_layout::planar);
+            assert((channel >= 0) && (channel < m_nb_channels));
+            return segments_of(static_cast<const value_type*>(m_data) + channel*m_size_max, 1);
+        }
+        //! The content as (at most) two contiguous segments of whole frames (interleaved layout only).
+        //  WARNING: Not thread-safe
+        inline segment_pair<value_type> segments() {
+            assert(m_layout == channel_layout::interleaved);
+            return segments_of(m_data, m_nb_channels);
+        }
+        //! WARNING: Not thread-safe
+        inline segment_pair<const value_type> segments() const {
+            assert(m_layout == channel_layout::interleaved);
+            return segments_of(static_cast<const value_type*>(m_data), m_nb_channels);
+        }
+
+        //! Push nb_frames frames given as one array per channel.
+        inline void push_back_nolock(const value_type* const* channels, int nb_frames) {
+            if (nb_frames <= 0)             // Ignore push of empty buffers
+                return;
+            assert(m_size+nb_frames <= m_size_max);
+            int seg1size = std::min(nb_frames, m_size_max - m_end);
+            copy_in_planar_nolock(m_end, channels, 0, seg1size);
+            if (seg1size < nb_frames)
+                copy_in_planar_nolock(0, channels, seg1size, nb_frames - seg1size);
+            advance_end_nolock(nb_frames);
+        }
+        inline void push_back(const value_type* const* channels, int nb_frames) {
+            ACBENCH_MUTEX_GUARD
+            push_back_nolock(channels, nb_frames);
+        }
+        //! Push nb_frames interleaved frames (ie. nb_frames*nb_channels() values).
+        inline void push_back_interleaved_nolock(const value_type* frames, int nb_frames) {
+            if (nb_frames <= 0)             // Ignore push of empty buffers
+                return;
+            assert(m_size+nb_frames <= m_size_max);
+            int seg1size = std::min(nb_frames, m_size_max - m_end);
+            copy_in_interleaved_nolock(m_end, frames, 0, seg1size);
+            if (seg1size < nb_frames)
+                copy_in_interleaved_nolock(0, frames, seg1size, nb_frames - seg1size);
+            advance_end_nolock(nb_frames);
+        }
+        inline void push_back_interleaved(const value_type* frames, int nb_frames) {
+            ACBENCH_MUTEX_GUARD
+            push_back_interleaved_nolock(frames, nb_frames);
+        }
+
+        inline void pop_front_nolock(int nb_frames) {
+            if (nb_frames < 1) return;        // Just ignore pops of non-existing values
+
+            if (nb_frames >= m_size) {        // Clears all if not enough to be poped
+                clear_nolock();
+                return;
+            }
+            advance_front_nolock(nb_frames);
+        }
+        inline void pop_front(int nb_frames) {
+            ACBENCH_MUTEX_GUARD
+            pop_front_nolock(nb_frames);
+        }
+        //! Pop (at most) nb_frames frames into one array per channel, and returns the number of frames popped.
+        inline int pop_front_nolock(value_type* const* channels, int nb_frames) {
+            if (nb_frames < 1) return 0;      // Just ignore pops of non-existing values
+            if (nb_frames > m_size)           // Pop as many frames as possible
+                nb_frames = m_size;
+            int seg1size = std::min(nb_frames, m_size_max - m_front);
+            copy_out_planar_nolock(m_front, channels, 0, seg1size);
+            if (seg1size < nb_frames)
+                copy_out_planar_nolock(0, channels, seg1size, nb_frames - seg1size);
+            advance_front_nolock(nb_frames);
+            return nb_frames;
+        }
+        inline int pop_front(value_type* const* channels, int nb_frames) {
+            ACBENCH_MUTEX_GUARD
+            return pop_front_nolock(channels, nb_frames);
+        }
+        //! Pop (at most) nb_frames interleaved frames, and returns the number of frames popped.
+        inline int pop_front_interleaved_nolock(value_type* frames, int nb_frames) {
+            if (nb_frames < 1) return 0;      // Just ignore pops of non-existing values
+            if (nb_frames > m_size)           // Pop as many frames as possible
+                nb_frames = m_size;
+            int seg1size = std::min(nb_frames, m_size_max - m_front);
+            copy_out_interleaved_nolock(m_front, frames, 0, seg1size);
+            if (seg1size < nb_frames)
+                copy_out_interleaved_nolock(0, frames, seg1size, nb_frames - seg1size);
+            advance_front_nolock(nb_frames);
+            return nb_frames;
+        }
+        inline int pop_front_interleaved(value_type* frames, int nb_frames) {
+            ACBENCH_MUTEX_GUARD
+            return pop_front_interleaved_nolock(frames, nb_frames);
+        }
+    };
+
+}  // namespace acbench
+
+#endif  // ACBENCH_MULTICHANNEL_RINGBUFFER_H_
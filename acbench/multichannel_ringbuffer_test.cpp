@@ -0,0 +1,222 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#include <acbench/multichannel_ringbuffer.h>
+
+#include "utils.h"
+
+#include <deque>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+typedef acbench::multichannel_ringbuffer<float> test_t;
+typedef std::vector<std::deque<float>> ref_t;
+
+void mrb_require_equals(const test_t& test, const ref_t& ref) {
+    REQUIRE(test.nb_channels() == static_cast<int>(ref.size()));
+    for (int c = 0; c < test.nb_channels(); ++c) {
+        REQUIRE(test.size() == static_cast<int>(ref[c].size()));
+        for (int n = 0; n < test.size(); ++n)
+            REQUIRE(test(c, n) == ref[c][n]);
+    }
+}
+
+// Pushes random frames, alternatively as planar and interleaved data
+void mrb_push_back_rand(test_t& test, ref_t& ref, int nb_frames, bool interleaved) {
+    int nb_channels = test.nb_channels();
+    std::vector<std::vector<float>> channels(nb_channels, std::vector<float>(nb_frames));
+    std::vector<float> frames(nb_channels*nb_frames);
+    for (int c = 0; c < nb_channels; ++c) {
+        for (int n = 0; n < nb_frames; ++n) {
+            float v = acbench::rand_uniform_continuous_01<float>();
+            channels[c][n] = v;
+            frames[n*nb_channels+c] = v;
+            ref[c].push_back(v);
+        }
+    }
+    if (interleaved) {
+        test.push_back_interleaved(frames.data(), nb_frames);
+    } else {
+        std::vector<const float*> pchannels(nb_channels);
+        for (int c = 0; c < nb_channels; ++c)
+            pchannels[c] = channels[c].data();
+        test.push_back(pchannels.data(), nb_frames);
+    }
+}
+
+void mrb_pop_front_check(test_t& test, ref_t& ref, int nb_frames, bool interleaved) {
+    int nb_channels = test.nb_channels();
+    int nb_expected = std::min(nb_frames, test.size());
+    if (interleaved) {
+        std::vector<float> frames(nb_channels*nb_frames);
+        REQUIRE(test.pop_front_interleaved(frames.data(), nb_frames) == nb_expected);
+        for (int n = 0; n < nb_expected; ++n)
+            for (int c = 0; c < nb_channels; ++c)
+                REQUIRE(frames[n*nb_channels+c] == ref[c][n]);
+    } else {
+        std::vector<std::vector<float>> channels(nb_channels, std::vector<float>(nb_frames));
+        std::vector<float*> pchannels(nb_channels);
+        for (int c = 0; c < nb_channels; ++c)
+            pchannels[c] = channels[c].data();
+        REQUIRE(test.pop_front(pchannels.data(), nb_frames) == nb_expected);
+        for (int c = 0; c < nb_channels; ++c)
+            for (int n = 0; n < nb_expected; ++n)
+                REQUIRE(channels[c][n] == ref[c][n]);
+    }
+    for (int c = 0; c < nb_channels; ++c)
+        ref[c].erase(ref[c].begin(), ref[c].begin()+nb_expected);
+}
+
+TEST_CASE("multichannel_ringbuffer_allocation") {
+    test_t test;
+    REQUIRE(test.data() == nullptr);
+    REQUIRE(test.capacity() == 0);
+    REQUIRE(test.nb_channels() == 0);
+    REQUIRE(test.is_thread_safe());
+
+    test.resize_allocation(2, 100);
+    REQUIRE(test.nb_channels() == 2);
+    REQUIRE(test.capacity() == 100);
+    REQUIRE(test.size_max() == 100);
+    REQUIRE(test.size_free() == 100);
+    REQUIRE(test.layout() == acbench::channel_layout::planar);
+    REQUIRE(test.empty());
+
+    // Same size: only clears, though the layout can change
+    float* pdata = test.data();
+    test.push_back_interleaved(std::vector<float>(2, 1.0f).data(), 1);
+    test.resize_allocation(2, 100, acbench::channel_layout::interleaved);
+    REQUIRE(test.data() == pdata);
+    REQUIRE(test.layout() == acbench::channel_layout::interleaved);
+    REQUIRE(test.empty());
+
+    test.resize_allocation(3, 100);
+    REQUIRE(test.nb_channels() == 3);
+    test.push_back_interleaved(std::vector<float>(3, 1.0f).data(), 1);
+    test.clear();
+    REQUIRE(test.empty());
+
+    acbench::multichannel_ringbuffer<double, acbench::lock_none> test_nolock;
+    REQUIRE(!test_nolock.is_thread_safe());
+    test_nolock.lock();
+    test_nolock.unlock();
+}
+
+TEST_CASE("multichannel_ringbuffer_push_pop") {
+    for (acbench::channel_layout layout : {acbench::channel_layout::planar, acbench::channel_layout::interleaved}) {
+        for (int nb_channels : {1, 2, 7}) {
+            test_t test;
+            ref_t ref(nb_channels);
+            test.resize_allocation(nb_channels, 100, layout);
+
+            // Shortcuts
+            test.push_back(static_cast<const float* const*>(nullptr), 0);
+            test.push_back_interleaved(nullptr, 0);
+            test.pop_front(0);
+            REQUIRE(test.pop_front(static_cast<float* const*>(nullptr), 0) == 0);
+            REQUIRE(test.pop_front_interleaved(nullptr, 0) == 0);
+
+            // Move the front around the buffer many times, in all combinations of formats
+            for (int iter = 0; iter < 40; ++iter) {
+                mrb_push_back_rand(test, ref, std::min(1+std::rand()%50, test.size_free()), (iter%2) == 0);
+                mrb_require_equals(test, ref);
+                mrb_pop_front_check(test, ref, 1+std::rand()%50, (iter%3) == 0);
+                mrb_require_equals(test, ref);
+            }
+
+            // Pop more than available
+            mrb_pop_front_check(test, ref, 1000, false);
+            REQUIRE(test.empty());
+            mrb_push_back_rand(test, ref, 30, true);
+            mrb_pop_front_check(test, ref, 1000, false);
+            REQUIRE(test.empty());
+            mrb_push_back_rand(test, ref, 30, false);
+            mrb_pop_front_check(test, ref, 1000, true);
+            REQUIRE(test.empty());
+            mrb_push_back_rand(test, ref, 30, false);
+            test.pop_front(1000);
+            REQUIRE(test.empty());
+            for (int c = 0; c < nb_channels; ++c)
+                ref[c].clear();
+
+            // Discard only some frames
+            mrb_push_back_rand(test, ref, 100, false);
+            test.pop_front(10);
+            for (int c = 0; c < nb_channels; ++c)
+                ref[c].erase(ref[c].begin(), ref[c].begin()+10);
+            mrb_require_equals(test, ref);
+
+            // Element-wise write, before and after the wrap point
+            mrb_push_back_rand(test, ref, 10, true);
+            test(nb_channels-1, 5) = 2.0f;
+            ref[nb_channels-1][5] = 2.0f;
+            test(0, 95) = 3.0f;
+            ref[0][95] = 3.0f;
+            mrb_require_equals(test, ref);
+        }
+    }
+}
+
+TEST_CASE("multichannel_ringbuffer_segments") {
+    ref_t ref(3);
+    test_t test;
+    test.resize_allocation(3, 100, acbench::channel_layout::planar);
+    mrb_push_back_rand(test, ref, 80, false);
+    mrb_pop_front_check(test, ref, 70, false);
+
+    // Contiguous data
+    for (int c = 0; c < 3; ++c) {
+        acbench::segment_pair<float> segs = test.channel_segments(c);
+        REQUIRE(segs.first.data() == test.data() + c*100 + 70);
+        REQUIRE(segs.first.size() == 10);
+        REQUIRE(segs.second.empty());
+    }
+
+    // Wrapped data
+    mrb_push_back_rand(test, ref, 60, true);
+    for (int c = 0; c < 3; ++c) {
+        acbench::segment_pair<float> segs = test.channel_segments(c);
+        REQUIRE(segs.first.size() == 30);
+        REQUIRE(segs.second.data() == test.data() + c*100);
+        REQUIRE(segs.second.size() == 40);
+        int n = 0;
+        for (const auto& seg : {segs.first, segs.second})
+            for (float v : seg)
+                REQUIRE(v == ref[c][n++]);
+    }
+
+    // Interleaved layout
+    ref = ref_t(3);
+    test.resize_allocation(3, 100, acbench::channel_layout::interleaved);
+    mrb_push_back_rand(test, ref, 80, false);
+    mrb_pop_front_check(test, ref, 70, true);
+    acbench::segment_pair<float> segs = test.segments();
+    REQUIRE(segs.first.size() == 30);
+    REQUIRE(segs.second.empty());
+    mrb_push_back_rand(test, ref, 60, false);
+    segs = test.segments();
+    REQUIRE(segs.first.data() == test.data() + 70*3);
+    REQUIRE(segs.first.size() == 30*3);
+    REQUIRE(segs.second.data() == test.data());
+    REQUIRE(segs.second.size() == 40*3);
+    REQUIRE(segs.second[0] == ref[0][30]);
+    REQUIRE(segs.second[2] == ref[2][30]);
+
+    // Read-only views of a const container
+    const test_t& ctest = test;
+    acbench::segment_pair<const float> csegs = ctest.segments();
+    REQUIRE(csegs.first.data() == segs.first.data());
+    REQUIRE(csegs.second.size() == segs.second.size());
+    test.resize_allocation(3, 100, acbench::channel_layout::planar);
+    ref = ref_t(3);
+    mrb_push_back_rand(test, ref, 10, false);
+    acbench::segment_pair<const float> ccsegs = ctest.channel_segments(2);
+    REQUIRE(ccsegs.first.data() == test.data() + 2*100);
+    REQUIRE(ccsegs.first.size() == 10);
+}
@@ -0,0 +1,52 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+// The containers built without any thread support (ex. Arduino), see ACBENCH_NOT_THREAD_SAFE in ringbuffer.h
+#define ACBENCH_NOT_THREAD_SAFE
+#include <acbench/ringbuffer.h>
+#include <acbench/static_ringbuffer.h>
+#include <acbench/delayline.h>
+#include <acbench/ringbuffer_group.h>
+
+#include <type_traits>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("not_thread_safe_lock_default", "[not_thread_safe]") {
+    REQUIRE(std::is_same<acbench::lock_default, acbench::lock_none>::value);
+
+    const int block_size = 64;
+    std::vector<float> data(block_size);
+    for (int n = 0; n < block_size; ++n)
+        data[n] = static_cast<float>(n);
+    std::vector<float> out(block_size);
+
+    acbench::ringbuffer<float> rb;
+    rb.resize_allocation(2*block_size);
+    rb.push_back(data.data(), block_size);
+    REQUIRE(rb.pop_front(out.data(), block_size) == block_size);
+    REQUIRE(out == data);
+
+    acbench::static_ringbuffer<float, 128> srb;
+    srb.push_back(data.data(), block_size);
+    REQUIRE(srb.pop_front(out.data(), block_size) == block_size);
+    REQUIRE(out == data);
+
+    acbench::delayline<float> dl;
+    dl.resize_allocation(2*block_size, block_size);
+    dl.write(data.data(), block_size);
+    dl.read(out.data(), block_size, 0);
+    REQUIRE(out == data);
+
+    acbench::ringbuffer_group<float> group;
+    group.resize_allocation(2, 2*block_size);
+    group.push_back(1, data.data(), block_size);
+    group.pop_front_mix(out.data(), block_size);
+    REQUIRE(out == data);
+}
@@ -18,6 +18,34 @@ Allocation:
 
     The destructor always deallocate the memory.
 
+    The move constructor, the move assignment and swap(.) never allocate: they exchange the allocations in O(1)
+    (ex. to hand a ringbuffer over to another pipeline stage, or to store ringbuffers in an std::vector).
+    The copy constructor is forbidden, and the copy assignment copies the values into the current allocation.
+
+    The memory is obtained from the allocation policy given as third template argument,
+    an STL-like allocator (allocate(n) and deallocate(p, n)):
+        ringbuffer<T, Lock, acbench::allocator_new<T>>  (default) new[] and delete[].
+    See acbench/allocators.h for cache-line aligned, huge pages and page-locked (mlock) memory,
+    and for an arena shared by many ringbuffers. A stateful allocator is given to the constructor:
+        ringbuffer<T, Lock, Allocator> rb(allocator);
+
+Sizes:
+    All sizes and indices are of the type given as fourth template argument (int by default, thus at most 2^31-1 values):
+        ringbuffer<T, Lock, Allocator, std::int64_t>  For buffers longer than that (ex. long recordings).
+    The byte counts of the copies are always computed in std::size_t.
+
+Block sizes known at compile time:
+    push_back<N>(array) and pop_front<N>(array) are the same as push_back(array, N) and pop_front(array, N),
+    with copies resolved at compile time (ex. for the usual 32, 64, 128, 256 or 512 values blocks).
+
+Streaming stores:
+    set_stream_threshold(n) makes the pushes of arrays of at least n values bypass the caches (non-temporal stores),
+    for large ringbuffers whose values are popped much later (push_back<N>(array) included). Disabled by default.
+
+Sample formats:
+    push_back(const S*, int) and pop_front(S*, int) convert the samples from/to S while copying,
+    for the formats of acbench/sample_format.h (ex. int16_t into a ringbuffer<float>).
+
 Thread-safety:
     * By default, the functions are thread-safe.
     * WARNING: Except for element-wise accessors (ex. operator[](int)), which are _not_ thread-safe.
@@ -27,49 +55,254 @@ Thread-safety:
     * You can always call the _nolock(.) non-thread-safe version of each function.
       (if it doesn't exists, it means there was no need to lock the mutex in the thread-safe version anyway)
 
-    * On systems that don't have mutex or are single-threaded by nature (ex. Arduino), you can make the whole ringbuffer not thread-safe by defining ACBENCH_NOT_THREAD_SAFE before including this file.
+    * The synchronisation is chosen per ringbuffer through the second template argument:
+        ringbuffer<T, std::mutex>             (default) Thread-safe as described above.
+        ringbuffer<T, acbench::lock_spinlock> Same, but busy-waits instead of sleeping. For very short critical sections.
+        ringbuffer<T, acbench::lock_none>     Not thread-safe, nothing is locked. For thread-local ringbuffers.
+        ringbuffer<T, acbench::lock_spsc>     Lock-free for one producer thread and one consumer thread,
+                                              with a reduced API (see spsc_ringbuffer<T> below).
+        ringbuffer<T, acbench::lock_mpmc>     Without mutex for any number of producer and consumer threads,
+                                              each push and pop moving a whole chunk (see mpmc_ringbuffer<T> below).
+      For real-time threads (ex. an audio callback), where locking a mutex is forbidden, use lock_spsc.
+
+    * On systems that don't have mutex or are single-threaded by nature (ex. Arduino), you can make the default ringbuffer not thread-safe by defining ACBENCH_NOT_THREAD_SAFE before including this file.
+      Only lock_none is then available.
 
 **/
 
 #ifndef ACBENCH_NOT_THREAD_SAFE
-    #define ACBENCH_MULTITHREADED  // Move before the #includes or make it an option per ringbuffer
+    #define ACBENCH_MULTITHREADED
 #endif
 
 
 #include <cassert>  // For assert(.)
 #include <cstring>  // For std::memcpy(.)
+#include <algorithm>  // For std::min(.)
+
+#include <type_traits>  // For std::is_same
+#include <iterator>  // For std::random_access_iterator_tag
+#include <cstddef>  // For std::ptrdiff_t and std::size_t
+#include <functional>  // For std::less
+#include <utility>  // For std::swap
+
+#include <acbench/simd.h>  // For simd::copy(.) and simd::copy_stream(.)
+#include <acbench/sample_format.h>  // For convert_samples(.)
 
 #ifdef ACBENCH_MULTITHREADED
+#include <atomic>
+#include <cstdint>  // For std::uint64_t
 #include <mutex>
-#define ACBENCH_MUTEX_DECLARE mutable std::mutex m_mutex;  // mutable allows to change even in const methods
-#define ACBENCH_MUTEX_GUARD std::lock_guard<std::mutex> mutex_lock(m_mutex);
+#include <thread>  // For std::this_thread::yield()
+#endif
+
+#define ACBENCH_MUTEX_DECLARE mutable lock_type m_mutex;  // mutable allows to change even in const methods
+#define ACBENCH_MUTEX_GUARD acbench::lock_guard<lock_type> mutex_lock(m_mutex);
 #define ACBENCH_MUTEX_LOCK m_mutex.lock();
 #define ACBENCH_MUTEX_UNLOCK m_mutex.unlock();
-#else
-#define ACBENCH_MUTEX_DECLARE
-#define ACBENCH_MUTEX_GUARD
-#define ACBENCH_MUTEX_LOCK
-#define ACBENCH_MUTEX_UNLOCK
-#endif
 
 
 namespace acbench {
 
+    // Locking policies ---------------------------------------------------
+
+    //! Does not lock anything. The ringbuffer is then not thread-safe.
+    class lock_none {
+     public:
+        inline void lock() {}
+        inline void unlock() {}
+        inline bool try_lock() { return true; }
+    };
+
+    //! Equivalent of std::lock_guard, which is also usable without <mutex>.
+    template<typename Lock>
+    class lock_guard {
+        Lock& m_lock;
+     public:
+        lock_guard(const lock_guard&) = delete;
+        lock_guard& operator=(const lock_guard&) = delete;
+        explicit lock_guard(Lock& lock) : m_lock(lock) {
+            m_lock.lock();
+        }
+        ~lock_guard() {
+            m_lock.unlock();
+        }
+    };
+
+    //! Locks two different locks, always in the same order (by address), so that two threads locking the same two locks
+    //  in opposite orders (ex. rb1.swap(rb2) and rb2.swap(rb1)) can't deadlock.
+    template<typename Lock1, typename Lock2 = Lock1>
+    class lock_guard_pair {
+        Lock1& m_lock1;
+        Lock2& m_lock2;
+        bool m_lock1_first;
+     public:
+        lock_guard_pair(const lock_guard_pair&) = delete;
+        lock_guard_pair& operator=(const lock_guard_pair&) = delete;
+        lock_guard_pair(Lock1& lock1, Lock2& lock2)
+            : m_lock1(lock1)
+            , m_lock2(lock2)
+            , m_lock1_first(std::less<const void*>()(&lock1, &lock2)) {
+            assert(static_cast<const void*>(&lock1) != static_cast<const void*>(&lock2));
+            if (m_lock1_first) {
+                m_lock1.lock();
+                m_lock2.lock();
+            } else {
+                m_lock2.lock();
+                m_lock1.lock();
+            }
+        }
+        ~lock_guard_pair() {
+            if (m_lock1_first) {
+                m_lock2.unlock();
+                m_lock1.unlock();
+            } else {
+                m_lock1.unlock();
+                m_lock2.unlock();
+            }
+        }
+    };
+
+    #ifdef ACBENCH_MULTITHREADED
+
+    //! Busy-waiting lock. Never puts the thread to sleep, so it is cheaper than std::mutex
+    //  when the critical sections are short and rarely contended.
+    class lock_spinlock {
+        std::atomic_flag m_flag;
+     public:
+        lock_spinlock(const lock_spinlock&) = delete;
+        lock_spinlock& operator=(const lock_spinlock&) = delete;
+        lock_spinlock() {
+            m_flag.clear();
+        }
+        inline void lock() {
+            while (m_flag.test_and_set(std::memory_order_acquire)) {}
+        }
+        inline void unlock() {
+            m_flag.clear(std::memory_order_release);
+        }
+        inline bool try_lock() {
+            return !m_flag.test_and_set(std::memory_order_acquire);
+        }
+    };
+
+    //! Tag selecting the lock-free single-producer/single-consumer ringbuffer.
+    struct lock_spsc {};
+
+    //! Tag selecting the multi-producer/multi-consumer ringbuffer.
+    struct lock_mpmc {};
+
+    typedef std::mutex lock_default;
+
+    #else
+
+    typedef lock_none lock_default;
+
+    #endif  // ACBENCH_MULTITHREADED
+
+    //! True for the lock-free locking policies (lock_spsc, lock_mpmc), which are specializations of ringbuffer
+    //  and thus can't be used by the containers built on top of the generic ringbuffer.
+    template<typename Lock>
+    struct is_lock_free_policy : std::false_type {};
+    #ifdef ACBENCH_MULTITHREADED
+    template<> struct is_lock_free_policy<lock_spsc> : std::true_type {};
+    template<> struct is_lock_free_policy<lock_mpmc> : std::true_type {};
+    #endif
+
+
+    // Allocation policies ------------------------------------------------
+
+    //! Default allocation policy: new[] and delete[], as an STL-like allocator.
     template<typename T>
+    class allocator_new {
+     public:
+        typedef T value_type;
+        template<typename U> struct rebind { typedef allocator_new<U> other; };
+
+        allocator_new() {}
+        template<typename U>
+        allocator_new(const allocator_new<U>&) {}  // NOLINT(runtime/explicit)
+
+        inline T* allocate(std::size_t n) {
+            return new T[n];  // GCOVR_EXCL_BR_LINE
+        }
+        inline void deallocate(T* p, std::size_t) {
+            delete[] p;
+        }
+    };
+    template<typename T, typename U>
+    inline bool operator==(const allocator_new<T>&, const allocator_new<U>&) { return true; }
+    template<typename T, typename U>
+    inline bool operator!=(const allocator_new<T>&, const allocator_new<U>&) { return false; }
+
+
+    // Segments -----------------------------------------------------------
+
+    //! Contiguous segment of values, usable with range-based for loops and STL algorithms.
+    template<typename T, typename SizeType = int>
+    class segment {
+        T* m_data = nullptr;
+        SizeType m_size = 0;
+     public:
+        segment() {}
+        segment(T* data, SizeType size) : m_data(data), m_size(size) {}
+        inline T* data() const { return m_data; }
+        inline SizeType size() const { return m_size; }
+        inline bool empty() const { return m_size == 0; }
+        inline T* begin() const { return m_data; }
+        inline T* end() const { return m_data + m_size; }
+        inline T& operator[](SizeType n) const { return m_data[n]; }
+    };
+
+    //! The content of a ringbuffer as (at most) two contiguous segments, from front to back.
+    //  `second` is empty if the content doesn't wrap around the end of the allocation.
+    template<typename T, typename SizeType = int>
+    struct segment_pair {
+        segment<T, SizeType> first;
+        segment<T, SizeType> second;
+    };
+
+
+    // Ringbuffer ---------------------------------------------------------
+
+    template<typename T, typename Lock = lock_default, typename Allocator = allocator_new<T>, typename SizeType = int>
     class ringbuffer {
+        template<typename, typename, typename, typename> friend class ringbuffer;
+        static_assert(std::is_integral<SizeType>::value && std::is_signed<SizeType>::value, "The size type must be a signed integer");
+
+     public:
+        typedef Lock lock_type;
+        typedef Allocator allocator_type;
+        typedef SizeType size_type;
+
      protected:
         ACBENCH_MUTEX_DECLARE
 
-        int m_size_max = 0;
-        int m_size = 0;
+        allocator_type m_allocator;
+
+        size_type m_size_max = 0;
+        size_type m_size = 0;
         T* m_data = nullptr;
-        int m_front = 0;
-        int m_end = 0;  // One after the last element
+        size_type m_front = 0;
+        size_type m_end = 0;  // One after the last element
+        size_type m_mask = 0;  // m_size_max-1 if m_size_max is a power of two, 0 otherwise
         bool m_dynamic_allocation = false;
+        size_type m_stream_threshold = 0;  // 0 if disabled
+
+        inline void set_size_max_nolock(size_type size_max) {
+            m_size_max = size_max;
+            m_mask = (size_max > 1 && (size_max & (size_max-1)) == 0) ? size_max-1 : 0;
+        }
+        // Index of the n-th element relative to data().
+        // Uses a bitmask instead of the integer division of the modulo when the capacity is a power of two.
+        inline size_type data_index_nolock(size_type n) const {
+            if (m_mask)
+                return (m_front+n) & m_mask;
+            return (m_front+n) % m_size_max;
+        }
 
         inline void destroy_nolock() {
             if ( m_data ) {
-                delete[] m_data;  // GCOVR_EXCL_LINE
+                m_allocator.deallocate(m_data, static_cast<std::size_t>(m_size_max));  // GCOVR_EXCL_LINE
                 m_data = nullptr;
             }
         }
@@ -80,23 +313,31 @@ namespace acbench {
      protected:
         // Copy constructor is forbidden to avoid implicit calls.
         // Do it manually if necessary (using `.resize_allocation(.)` and `.push_back(.)`)
-        explicit ringbuffer(const ringbuffer<value_type>& rb) {
+        explicit ringbuffer(const ringbuffer& rb) {
             (void)rb;
         }
 
-        inline void memory_copy_nolock(value_type* pdest, const value_type* psrc, int size) {
-            if (size == 0) return;  // GCOVR_EXCL_LINE
-            assert(size > 0);
-            std::memcpy(reinterpret_cast<void*>(pdest), reinterpret_cast<const void*>(psrc), sizeof(value_type)*static_cast<unsigned int>(size));
+        // With non-temporal stores if stream is true (see set_stream_threshold(.)).
+        // simd::copy(.) inlines the small copies (and does nothing if size is 0), instead of calling std::memcpy.
+        // size_chunk is the size of the whole chunk when copying one of its segments, which selects the kernel.
+        inline void memory_copy_nolock(value_type* pdest, const value_type* psrc, size_type size, size_type size_chunk, bool stream = false) {
+            assert(size >= 0);
+            if (stream)
+                simd::copy_stream(reinterpret_cast<void*>(pdest), reinterpret_cast<const void*>(psrc), sizeof(value_type)*static_cast<std::size_t>(size));
+            else
+                simd::copy(reinterpret_cast<void*>(pdest), reinterpret_cast<const void*>(psrc), sizeof(value_type)*static_cast<std::size_t>(size), sizeof(value_type)*static_cast<std::size_t>(size_chunk));
+        }
+        inline void memory_copy_nolock(value_type* pdest, const value_type* psrc, size_type size) {
+            memory_copy_nolock(pdest, psrc, size, size);
         }
 
-        inline void grow_allocation_nolock(int required_capacity) {
+        inline void grow_allocation_nolock(size_type required_capacity) {
             // Grow by at least doubling, or to the required capacity (whichever is larger)
-            int new_size_max = m_size_max > 0 ? m_size_max * 2 : 16;
+            size_type new_size_max = m_size_max > 0 ? m_size_max * 2 : 16;
             while (new_size_max < required_capacity)
                 new_size_max *= 2;
 
-            value_type* new_data = new value_type[new_size_max];  // GCOVR_EXCL_BR_LINE
+            value_type* new_data = m_allocator.allocate(static_cast<std::size_t>(new_size_max));  // GCOVR_EXCL_BR_LINE
 
             // Linearize existing data into new buffer
             if (m_size > 0) {
@@ -105,22 +346,22 @@ namespace acbench {
                     memory_copy_nolock(new_data, m_data + m_front, m_size);
                 } else {
                     // Data wraps around
-                    int seg1size = m_size_max - m_front;
+                    size_type seg1size = m_size_max - m_front;
                     memory_copy_nolock(new_data, m_data + m_front, seg1size);
                     memory_copy_nolock(new_data + seg1size, m_data, m_size - seg1size);
                 }
             }
 
-            delete[] m_data;
+            destroy_nolock();
             m_data = new_data;
-            m_size_max = new_size_max;
+            set_size_max_nolock(new_size_max);
             m_front = 0;
             m_end = m_size;
             if (m_end >= m_size_max)  // GCOVR_EXCL_BR_LINE - defensive
                 m_end = 0;  // GCOVR_EXCL_LINE - defensive, can't trigger with doubling
         }
 
-        inline void memory_check_size_nolock(int nb_new_values) {
+        inline void memory_check_size_nolock(size_type nb_new_values) {
             (void)nb_new_values;
             assert(nb_new_values > 0);
             if (m_dynamic_allocation && m_size + nb_new_values > m_size_max) {
@@ -135,20 +376,66 @@ namespace acbench {
             m_size = 0;
         }
 
+        // Exchanges the allocations and the contents, not the mutexes.
+        inline void swap_nolock(ringbuffer& rb) {
+            std::swap(m_allocator, rb.m_allocator);
+            std::swap(m_size_max, rb.m_size_max);
+            std::swap(m_size, rb.m_size);
+            std::swap(m_data, rb.m_data);
+            std::swap(m_front, rb.m_front);
+            std::swap(m_end, rb.m_end);
+            std::swap(m_mask, rb.m_mask);
+            std::swap(m_dynamic_allocation, rb.m_dynamic_allocation);
+            std::swap(m_stream_threshold, rb.m_stream_threshold);
+        }
+
      public:
-        //! Only allowed constructor
         ringbuffer() {
         }
-        ringbuffer& operator=(const ringbuffer<value_type>& rb) {
+        //! For stateful allocators (ex. allocator_arena<T>). Doesn't allocate.
+        explicit ringbuffer(const allocator_type& allocator)
+            : m_allocator(allocator) {
+        }
+        ringbuffer& operator=(const ringbuffer& rb) {
             ACBENCH_MUTEX_GUARD
             this->clear_nolock();
             this->push_back_nolock(rb);
             return *this;
         }
+        //! Move constructor. Takes over the allocation and the content of rb, in O(1) and without allocating.
+        //  rb is left empty and without allocation, as if default-constructed.
+        ringbuffer(ringbuffer&& rb) {
+            acbench::lock_guard_pair<lock_type> mutex_locks(m_mutex, rb.m_mutex);
+            this->swap_nolock(rb);
+        }
+        //! Move assignment. Deallocates the current allocation and takes over the one of rb, in O(1) and without allocating.
+        //  rb is left empty and without allocation, as if default-constructed.
+        ringbuffer& operator=(ringbuffer&& rb) {
+            if (this == &rb)
+                return *this;
+            acbench::lock_guard_pair<lock_type> mutex_locks(m_mutex, rb.m_mutex);
+            this->destroy_nolock();
+            this->clear_nolock();
+            set_size_max_nolock(0);
+            m_dynamic_allocation = false;
+            m_stream_threshold = 0;
+            this->swap_nolock(rb);
+            return *this;
+        }
+        //! Exchanges the allocations and the contents of the two ringbuffers, in O(1) and without allocating.
+        inline void swap(ringbuffer& rb) {
+            if (this == &rb)
+                return;
+            acbench::lock_guard_pair<lock_type> mutex_locks(m_mutex, rb.m_mutex);
+            this->swap_nolock(rb);
+        }
+        friend inline void swap(ringbuffer& rb1, ringbuffer& rb2) {
+            rb1.swap(rb2);
+        }
         //! Allocate a new memory block and clear any previous data.
         //   * Always loose the data and reset the container to an empty state.
         //  (it is purposely not called reserve(.), because its behavior is different, see below).
-        inline void resize_allocation(int size_max) {
+        inline void resize_allocation(size_type size_max) {
             ACBENCH_MUTEX_GUARD
             if (size_max == m_size_max) {
                 this->clear_nolock();
@@ -156,36 +443,48 @@ namespace acbench {
             }
             this->destroy_nolock();
 
-            m_data = new value_type[size_max];  // GCOVR_EXCL_LINE // TODO(GD) Force contiguous memory
-            m_size_max = size_max;
+            m_data = m_allocator.allocate(static_cast<std::size_t>(size_max));  // GCOVR_EXCL_LINE
+            set_size_max_nolock(size_max);
 
             this->clear_nolock();
         }
+        //! Same as resize_allocation(.), but rounds the capacity up to the next power of two.
+        //  Element-wise accessors (ex. operator[](int)) then use a bitmask instead of a modulo.
+        //  (any capacity that happens to be a power of two benefits from it, whatever the allocation function)
+        inline void resize_allocation_pow2(size_type size_max) {
+            size_type size_max_pow2 = 1;
+            while (size_max_pow2 < size_max)
+                size_max_pow2 *= 2;
+            resize_allocation(size_max_pow2);
+        }
+        inline bool is_size_max_pow2() const {
+            return m_mask > 0;  // Atomic, no need of locked mutex
+        }
         // A more standard allocation function with behavior equivalent to std::vector::reserve()
         //  * It does nothing if the new size is less than or equal to the current size.
         //  * Otherwise, it increases the allocation and preserves the previous data.
-        inline void reserve(int size_max) {
+        inline void reserve(size_type size_max) {
             ACBENCH_MUTEX_GUARD
             if (size_max <= m_size_max)
                 return;
 
-            value_type* new_data = new value_type[size_max];  // GCOVR_EXCL_BR_LINE // TODO(GD) Force contiguous memory
+            value_type* new_data = m_allocator.allocate(static_cast<std::size_t>(size_max));  // GCOVR_EXCL_BR_LINE
             memory_copy_nolock(new_data, m_data, m_size);
 
-            delete[] m_data;  // GCOVR_EXCL_BR_LINE
+            destroy_nolock();  // GCOVR_EXCL_BR_LINE
             m_data = new_data;
 
-            m_size_max = size_max;
+            set_size_max_nolock(size_max);
         }
         // Shrink allocation to fit current size (minimum allocation of 1).
         //  * Reallocates to max(m_size, 1) elements.
         inline void shrink_to_fit() {
             ACBENCH_MUTEX_GUARD
-            int new_size_max = m_size > 0 ? m_size : 1;
+            size_type new_size_max = m_size > 0 ? m_size : 1;
             if (new_size_max == m_size_max)
                 return;  // Already minimal
 
-            value_type* new_data = new value_type[new_size_max];  // GCOVR_EXCL_BR_LINE
+            value_type* new_data = m_allocator.allocate(static_cast<std::size_t>(new_size_max));  // GCOVR_EXCL_BR_LINE
 
             // Linearize existing data into new buffer
             if (m_size > 0) {
@@ -194,15 +493,15 @@ namespace acbench {
                     memory_copy_nolock(new_data, m_data + m_front, m_size);
                 } else {
                     // Data wraps around
-                    int seg1size = m_size_max - m_front;
+                    size_type seg1size = m_size_max - m_front;
                     memory_copy_nolock(new_data, m_data + m_front, seg1size);
                     memory_copy_nolock(new_data + seg1size, m_data, m_size - seg1size);
                 }
             }
 
-            delete[] m_data;  // GCOVR_EXCL_BR_LINE
+            destroy_nolock();  // GCOVR_EXCL_BR_LINE
             m_data = new_data;
-            m_size_max = new_size_max;
+            set_size_max_nolock(new_size_max);
             m_front = 0;
             m_end = m_size;
             if (m_end >= m_size_max)
@@ -219,29 +518,22 @@ namespace acbench {
             this->destroy_nolock();
         }
 
-        #ifdef ACBENCH_MULTITHREADED
-            inline void lock() {
-                m_mutex.lock();
-            }
-            inline void unlock() {
-                m_mutex.unlock();
-            }
-            //! This is usefull to build a guard object out of the ringbuffer's mutex.
-            inline std::mutex& mutex() const {
-                return const_cast<std::mutex&>(m_mutex);
-            }
-            inline bool is_thread_safe() const {
-                return true;
-            }
-        #else
-            inline void lock() {
-            }
-            inline void unlock() {
-            }
-            inline bool is_thread_safe() const {
-                return false;
-            }
-        #endif
+        inline void lock() {
+            ACBENCH_MUTEX_LOCK
+        }
+        inline void unlock() {
+            ACBENCH_MUTEX_UNLOCK
+        }
+        //! This is usefull to build a guard object out of the ringbuffer's mutex.
+        inline lock_type& mutex() const {
+            return m_mutex;
+        }
+        inline allocator_type get_allocator() const {
+            return m_allocator;
+        }
+        inline bool is_thread_safe() const {
+            return !std::is_same<lock_type, lock_none>::value;
+        }
 
         inline void set_dynamic_allocation(bool enable) {
             ACBENCH_MUTEX_GUARD
@@ -251,21 +543,33 @@ namespace acbench {
             return m_dynamic_allocation;  // Atomic, no need of locked mutex
         }
 
+        //! Arrays of at least nb_values values are pushed with non-temporal stores (see simd::copy_stream(.)),
+        //  which don't pollute the caches with values that will be popped much later (ex. a large ringbuffer kept half full).
+        //  It slows down the pops of values pushed recently, so it is disabled by default (nb_values = 0).
+        inline void set_stream_threshold(size_type nb_values) {
+            assert(nb_values >= 0);
+            ACBENCH_MUTEX_GUARD
+            m_stream_threshold = nb_values;
+        }
+        inline size_type stream_threshold() const {
+            return m_stream_threshold;    // Atomic, no need of locked mutex
+        }
+
         inline value_type* data() const {
             return m_data;                // Atomic, no need of locked mutex
         }
-        inline int capacity() const {
+        inline size_type capacity() const {
             return m_size_max;            // Atomic, no need of locked mutex
         }
-        inline int size_max() const {
+        inline size_type size_max() const {
             return capacity();            // Atomic, no need of locked mutex
         }
-        inline int size() const {
+        inline size_type size() const {
             return m_size;                // Atomic, no need of locked mutex
         }
         // The index of the first element is always 0, as for any circular buffer.
         // So this function returns the index of `front` within the allocated memory, ie. relative to data()
-        inline int front_data_index() const {
+        inline size_type front_data_index() const {
             assert(m_size > 0);
             return m_front;  // Atomic, no need of locked mutex
         }
@@ -277,9 +581,9 @@ namespace acbench {
         }
         // The index of the last element is always size()-1, as for any circular buffer.
         // So this is the index of `back` within the allocated memory, ie. relative to data()
-        inline int back_data_index() const {
+        inline size_type back_data_index() const {
             ACBENCH_MUTEX_GUARD
-            int back = m_end - 1;
+            size_type back = m_end - 1;
             if (back < 0)
                 back = m_size_max-1;
             return back;
@@ -287,7 +591,7 @@ namespace acbench {
         inline value_type back() const {
             assert(m_size > 0);
             ACBENCH_MUTEX_GUARD
-            int back = m_end - 1;
+            size_type back = m_end - 1;
             if (back < 0)
                 back = m_size_max-1;
             assert((back >=0) && (back < m_size_max));
@@ -311,23 +615,119 @@ namespace acbench {
                 std::memcpy(out, m_data + m_front, sizeof(value_type) * m_size);
             } else {
                 // Data wraps around
-                int seg1size = m_size_max - m_front;
+                size_type seg1size = m_size_max - m_front;
                 std::memcpy(out, m_data + m_front, sizeof(value_type) * seg1size);
                 std::memcpy(out + seg1size, m_data, sizeof(value_type) * (m_size - seg1size));
             }
         }
 
+        // Iterators ----------------------------------------------------------
+        // WARNING: Not thread-safe, like the element-wise accessors.
+        // Incrementing does not compute any modulo, but loops over segments() are still faster,
+        // as they run over plain contiguous memory (and can thus be vectorized).
+
+        template<typename V>
+        class iterator_base {
+            template<typename, typename, typename, typename> friend class ringbuffer;
+            template<typename> friend class iterator_base;
+
+            V* m_data = nullptr;
+            size_type m_size_max = 0;
+            size_type m_front = 0;
+            size_type m_n = 0;  // Index relative to the front
+
+            iterator_base(V* data, size_type size_max, size_type front, size_type n)
+                : m_data(data), m_size_max(size_max), m_front(front), m_n(n) {}
+
+            inline size_type data_index(size_type n) const {
+                size_type idx = m_front + n;
+                if (idx >= m_size_max)
+                    idx -= m_size_max;
+                return idx;
+            }
+
+         public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef typename std::remove_const<V>::type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef V* pointer;
+            typedef V& reference;
+
+            iterator_base() {}
+            // Allows the conversion from iterator to const_iterator
+            template<typename V2>
+            iterator_base(const iterator_base<V2>& it)  // NOLINT(runtime/explicit)
+                : m_data(it.m_data), m_size_max(it.m_size_max), m_front(it.m_front), m_n(it.m_n) {}
+
+            inline reference operator*() const { return m_data[data_index(m_n)]; }
+            inline pointer operator->() const { return m_data + data_index(m_n); }
+            inline reference operator[](difference_type k) const { return m_data[data_index(m_n+static_cast<size_type>(k))]; }
+
+            inline iterator_base& operator++() { ++m_n; return *this; }
+            inline iterator_base operator++(int) { iterator_base it(*this); ++m_n; return it; }
+            inline iterator_base& operator--() { --m_n; return *this; }
+            inline iterator_base operator--(int) { iterator_base it(*this); --m_n; return it; }
+            inline iterator_base& operator+=(difference_type k) { m_n += static_cast<size_type>(k); return *this; }
+            inline iterator_base& operator-=(difference_type k) { m_n -= static_cast<size_type>(k); return *this; }
+            inline iterator_base operator+(difference_type k) const { iterator_base it(*this); return it += k; }
+            inline iterator_base operator-(difference_type k) const { iterator_base it(*this); return it -= k; }
+            friend inline iterator_base operator+(difference_type k, const iterator_base& it) { return it + k; }
+            inline difference_type operator-(const iterator_base& it) const { return m_n - it.m_n; }
+
+            inline bool operator==(const iterator_base& it) const { return m_n == it.m_n; }
+            inline bool operator!=(const iterator_base& it) const { return m_n != it.m_n; }
+            inline bool operator<(const iterator_base& it) const { return m_n < it.m_n; }
+            inline bool operator>(const iterator_base& it) const { return m_n > it.m_n; }
+            inline bool operator<=(const iterator_base& it) const { return m_n <= it.m_n; }
+            inline bool operator>=(const iterator_base& it) const { return m_n >= it.m_n; }
+        };
+        typedef iterator_base<value_type> iterator;
+        typedef iterator_base<const value_type> const_iterator;
+
+        inline iterator begin() { return iterator(m_data, m_size_max, m_front, 0); }
+        inline iterator end() { return iterator(m_data, m_size_max, m_front, m_size); }
+        inline const_iterator begin() const { return const_iterator(m_data, m_size_max, m_front, 0); }
+        inline const_iterator end() const { return const_iterator(m_data, m_size_max, m_front, m_size); }
+        inline const_iterator cbegin() const { return begin(); }
+        inline const_iterator cend() const { return end(); }
+
+        //! The content as (at most) two contiguous segments, from front to back.
+        //  WARNING: Not thread-safe
+        inline segment_pair<value_type, size_type> segments() {
+            segment_pair<value_type, size_type> segs;
+            if (m_front+m_size <= m_size_max) {
+                segs.first = segment<value_type, size_type>(m_data+m_front, m_size);
+            } else {
+                size_type seg1size = m_size_max - m_front;
+                segs.first = segment<value_type, size_type>(m_data+m_front, seg1size);
+                segs.second = segment<value_type, size_type>(m_data, m_size - seg1size);
+            }
+            return segs;
+        }
         //! WARNING: Not thread-safe
-        value_type operator[](int n) const {
+        inline segment_pair<const value_type, size_type> segments() const {
+            segment_pair<const value_type, size_type> segs;
+            if (m_front+m_size <= m_size_max) {
+                segs.first = segment<const value_type, size_type>(m_data+m_front, m_size);
+            } else {
+                size_type seg1size = m_size_max - m_front;
+                segs.first = segment<const value_type, size_type>(m_data+m_front, seg1size);
+                segs.second = segment<const value_type, size_type>(m_data, m_size - seg1size);
+            }
+            return segs;
+        }
+
+        //! WARNING: Not thread-safe
+        value_type operator[](size_type n) const {
             assert(n < m_size);
-            assert(((m_front+n)%m_size_max >=0) && ((m_front+n)%m_size_max < m_size_max));
-            return m_data[(m_front+n)%m_size_max];
+            assert((data_index_nolock(n) >=0) && (data_index_nolock(n) < m_size_max));
+            return m_data[data_index_nolock(n)];
         }
         //! WARNING: Not thread-safe
-        value_type& operator[](int n) {
+        value_type& operator[](size_type n) {
             assert(n < m_size);
-            assert(((m_front+n)%m_size_max >=0) && ((m_front+n)%m_size_max < m_size_max));
-            return m_data[(m_front+n)%m_size_max];
+            assert((data_index_nolock(n) >=0) && (data_index_nolock(n) < m_size_max));
+            return m_data[data_index_nolock(n)];
         }
 
         inline void push_back_nolock(const value_type v) {
@@ -346,7 +746,7 @@ namespace acbench {
             ACBENCH_MUTEX_GUARD
             push_back_nolock(v);
         }
-        inline void push_back_nolock(const value_type value, int nb_values) {
+        inline void push_back_nolock(const value_type value, size_type nb_values) {
             if (nb_values <= 0)             // Ignore pushing no values
                 return;
 
@@ -355,7 +755,7 @@ namespace acbench {
             if (m_end+nb_values <= m_size_max) {
 
                 value_type* pdata = m_data+m_end;
-                for (int k=0; k < nb_values; ++k)
+                for (size_type k=0; k < nb_values; ++k)
                     *pdata++ = value;
                 m_end += nb_values;
                 if (m_end >= m_size_max)
@@ -365,15 +765,15 @@ namespace acbench {
                 // Need to slice the array into two segments
 
                 // 1st segment: m_end:m_size_max-1
-                int seg1size = m_size_max - m_end;
+                size_type seg1size = m_size_max - m_end;
                 value_type* pdata = m_data+m_end;
-                for (int k=0; k < seg1size; ++k)
+                for (size_type k=0; k < seg1size; ++k)
                     *pdata++ = value;
 
                 // 2nd segment: 0:nb_values-seg1size
-                int seg2size = nb_values - seg1size;
+                size_type seg2size = nb_values - seg1size;
                 pdata = m_data;
-                for (int k=0; k < seg2size; ++k)
+                for (size_type k=0; k < seg2size; ++k)
                     *pdata++ = value;
 
                 m_end = seg2size;
@@ -381,19 +781,21 @@ namespace acbench {
 
             m_size += nb_values;
         }
-        inline void push_back(const value_type value, int nb_values) {
+        inline void push_back(const value_type value, size_type nb_values) {
             ACBENCH_MUTEX_GUARD
             push_back_nolock(value, nb_values);
         }
-        inline void push_back_nolock(const value_type* array, int array_size) {
+        inline void push_back_nolock(const value_type* array, size_type array_size) {
             if (array_size <= 0)             // Ignore push of empty buffers
                 return;
 
             memory_check_size_nolock(array_size);
 
+            bool stream = (m_stream_threshold > 0) && (array_size >= m_stream_threshold);
+
             if (m_end+array_size <= m_size_max) {
                 // No need to slice it
-                memory_copy_nolock(m_data+m_end, array, array_size);
+                memory_copy_nolock(m_data+m_end, array, array_size, array_size, stream);
                 m_end += array_size;
                 if (m_end >= m_size_max)
                     m_end = 0;
@@ -402,22 +804,44 @@ namespace acbench {
                 // Need to slice the array into two segments
 
                 // 1st segment: m_end:m_size_max-1
-                int seg1size = m_size_max - m_end;
-                memory_copy_nolock(m_data+m_end, array, seg1size);
+                size_type seg1size = m_size_max - m_end;
+                memory_copy_nolock(m_data+m_end, array, seg1size, array_size, stream);
 
                 // 2nd segment: 0:array_size-seg1size
-                int seg2size = array_size - seg1size;
-                memory_copy_nolock(m_data, array+seg1size, seg2size);
+                size_type seg2size = array_size - seg1size;
+                memory_copy_nolock(m_data, array+seg1size, seg2size, array_size, stream);
 
                 m_end = seg2size;
             }
 
             m_size += array_size;
         }
-        inline void push_back(const value_type* array, int array_size) {
+        inline void push_back(const value_type* array, size_type array_size) {
             ACBENCH_MUTEX_GUARD
             push_back_nolock(array, array_size);
         }
+        //! Same as push_back(array, N), with N known at compile time (ex. rb.push_back<256>(block) for blocks of 256 values).
+        //  The copy of a block that doesn't wrap around is then fully resolved at compile time (see simd::copy(.)),
+        //  unless it is streamed (see set_stream_threshold(.)).
+        template<size_type N>
+        inline void push_back_nolock(const value_type* array) {
+            static_assert(N > 0, "The block size must be positive");
+            memory_check_size_nolock(N);
+            if ((m_end+N > m_size_max) || ((m_stream_threshold > 0) && (N >= m_stream_threshold))) {
+                push_back_nolock(array, N);
+                return;
+            }
+            simd::copy(reinterpret_cast<void*>(m_data+m_end), reinterpret_cast<const void*>(array), sizeof(value_type)*static_cast<std::size_t>(N));
+            m_end += N;
+            if (m_end >= m_size_max)
+                m_end = 0;
+            m_size += N;
+        }
+        template<size_type N>
+        inline void push_back(const value_type* array) {
+            ACBENCH_MUTEX_GUARD
+            push_back_nolock<N>(array);
+        }
 
         inline void push_front_nolock(const value_type v) {
 
@@ -436,7 +860,7 @@ namespace acbench {
             ACBENCH_MUTEX_GUARD
             push_front_nolock(v);
         }
-        inline void push_front_nolock(const value_type value, int nb_values) {
+        inline void push_front_nolock(const value_type value, size_type nb_values) {
             if (nb_values <= 0)             // Ignore pushing no values
                 return;
 
@@ -449,32 +873,32 @@ namespace acbench {
             if (m_front+nb_values <= m_size_max) {
 
                 value_type* pdata = m_data+m_front;
-                for (int k=0; k < nb_values; ++k)
+                for (size_type k=0; k < nb_values; ++k)
                     *pdata++ = value;
 
             } else {
                 // Need to slice the array into two segments
 
                 // 1st segment: m_front:m_size_max-1
-                int seg1size = m_size_max - m_front;
+                size_type seg1size = m_size_max - m_front;
                 value_type* pdata = m_data+m_front;
-                for (int k=0; k < seg1size; ++k)
+                for (size_type k=0; k < seg1size; ++k)
                     *pdata++ = value;
 
                 // 2nd segment: 0:nb_values-seg1size
-                int seg2size = nb_values - seg1size;
+                size_type seg2size = nb_values - seg1size;
                 pdata = m_data;
-                for (int k=0; k < seg2size; ++k)
+                for (size_type k=0; k < seg2size; ++k)
                     *pdata++ = value;
             }
 
             m_size += nb_values;
         }
-        inline void push_front(const value_type value, int nb_values) {
+        inline void push_front(const value_type value, size_type nb_values) {
             ACBENCH_MUTEX_GUARD
             push_front_nolock(value, nb_values);
         }
-        inline void push_front_nolock(const value_type* array, int array_size) {
+        inline void push_front_nolock(const value_type* array, size_type array_size) {
             if (array_size <= 0)             // Ignore push of empty buffers
                 return;
 
@@ -492,22 +916,23 @@ namespace acbench {
                 // Need to slice the array into two segments
 
                 // 1st segment: m_front:m_size_max-1
-                int seg1size = m_size_max - m_front;
-                memory_copy_nolock(m_data+m_front, array, seg1size);
+                size_type seg1size = m_size_max - m_front;
+                memory_copy_nolock(m_data+m_front, array, seg1size, array_size);
 
                 // 2nd segment: 0:array_size-seg1size
-                int seg2size = array_size - seg1size;
-                memory_copy_nolock(m_data, array+seg1size, seg2size);
+                size_type seg2size = array_size - seg1size;
+                memory_copy_nolock(m_data, array+seg1size, seg2size, array_size);
             }
 
             m_size += array_size;
         }
-        inline void push_front(const value_type* array, int array_size) {
+        inline void push_front(const value_type* array, size_type array_size) {
             ACBENCH_MUTEX_GUARD
             push_front_nolock(array, array_size);
         }
 
-        inline void push_back_nolock(const ringbuffer<value_type>& rb) {
+        template<typename Lock2, typename Allocator2>
+        inline void push_back_nolock(const ringbuffer<value_type, Lock2, Allocator2, size_type>& rb) {
             if (rb.size() == 0)          // Ignore push of empty ringbuffers
                 return;
 
@@ -526,11 +951,11 @@ namespace acbench {
                     // The source segment is made of two continuous segments
 
                     // 1st segment
-                    int seg1size = rb.m_size_max - rb.m_front;
+                    size_type seg1size = rb.m_size_max - rb.m_front;
                     memory_copy_nolock(m_data+m_end, rb.m_data+rb.m_front, seg1size);
 
                     // 2nd segment
-                    int seg2size = rb.m_size - seg1size;
+                    size_type seg2size = rb.m_size - seg1size;
                     memory_copy_nolock(m_data+m_end+seg1size, rb.m_data, seg2size);
                 }
 
@@ -545,11 +970,11 @@ namespace acbench {
                     // The source segment is continuous...
 
                     // 1st segment
-                    int seg1size = m_size_max - m_end;
+                    size_type seg1size = m_size_max - m_end;
                     memory_copy_nolock(m_data+m_end, rb.m_data+rb.m_front, seg1size);
 
                     // 2nd segment
-                    int seg2size = rb.m_size - seg1size;
+                    size_type seg2size = rb.m_size - seg1size;
                     memory_copy_nolock(m_data, rb.m_data+rb.m_front+seg1size, seg2size);
 
                     m_end = seg2size;
@@ -563,15 +988,15 @@ namespace acbench {
                         // the source's break point comes before the destination's max size...
 
                         // 1st segment
-                        int seg1size = rb.m_size_max - rb.m_front;
+                        size_type seg1size = rb.m_size_max - rb.m_front;
                         memory_copy_nolock(m_data+m_end, rb.m_data+rb.m_front, seg1size);
 
                         // 2nd segment
-                        int seg2size = (m_size_max-m_end) - seg1size;
+                        size_type seg2size = (m_size_max-m_end) - seg1size;
                         memory_copy_nolock(m_data+m_end+seg1size, rb.m_data, seg2size);
 
                         // 3rd segment
-                        int seg3size = rb.m_size - seg1size - seg2size;
+                        size_type seg3size = rb.m_size - seg1size - seg2size;
                         memory_copy_nolock(m_data, rb.m_data+seg2size, seg3size);
 
                         m_end = seg3size;
@@ -580,15 +1005,15 @@ namespace acbench {
                         // the source's break point comes after the destination's max size...
 
                         // 1st segment
-                        int seg1size = m_size_max - m_end;
+                        size_type seg1size = m_size_max - m_end;
                         memory_copy_nolock(m_data+m_end, rb.m_data+rb.m_front, seg1size);
 
                         // 2nd segment
-                        int seg2size = (rb.m_size_max-rb.m_front) - seg1size;
+                        size_type seg2size = (rb.m_size_max-rb.m_front) - seg1size;
                         memory_copy_nolock(m_data, rb.m_data+rb.m_front+seg1size, seg2size);
 
                         // 3rd segment
-                        int seg3size = rb.m_size - seg1size - seg2size;
+                        size_type seg3size = rb.m_size - seg1size - seg2size;
                         memory_copy_nolock(m_data+seg2size, rb.m_data, seg3size);
 
                         m_end = seg2size + seg3size;
@@ -598,22 +1023,24 @@ namespace acbench {
 
             m_size += rb.m_size;
         }
-        inline void push_back(const ringbuffer<value_type>& rb) {
+        template<typename Lock2, typename Allocator2>
+        inline void push_back(const ringbuffer<value_type, Lock2, Allocator2, size_type>& rb) {
             ACBENCH_MUTEX_GUARD
             push_back_nolock(rb);
         }
 
         //! Push back only a segment of the ringbuffer given as argument.
-        inline void push_back_nolock(const ringbuffer<value_type>& rb, int start, int size) {
+        template<typename Lock2, typename Allocator2>
+        inline void push_back_nolock(const ringbuffer<value_type, Lock2, Allocator2, size_type>& rb, size_type start, size_type size) {
             if (rb.size() == 0)     return;  // Ignore push of empty ringbuffers
             if (size == 0)          return;  // Ignore push of empty data
             if (start >= rb.size()) return;  // Ignore push of empty data
 
             if (start+size > rb.size())
                 size = rb.size() - start;
-            int rb_size = size;
+            size_type rb_size = size;
 
-            int rb_front = rb.m_front + start;
+            size_type rb_front = rb.m_front + start;
             if (rb_front >= rb.m_size_max)
                 rb_front -= rb.m_size_max;
 
@@ -632,11 +1059,11 @@ namespace acbench {
                     // The source segment is made of two continuous segments
 
                     // 1st segment
-                    int seg1size = rb.m_size_max - rb_front;
+                    size_type seg1size = rb.m_size_max - rb_front;
                     memory_copy_nolock(m_data+m_end, rb.m_data+rb_front, seg1size);
 
                     // 2nd segment
-                    int seg2size = rb_size - seg1size;
+                    size_type seg2size = rb_size - seg1size;
                     memory_copy_nolock(m_data+m_end+seg1size, rb.m_data, seg2size);
                 }
 
@@ -651,11 +1078,11 @@ namespace acbench {
                     // The source segment is continuous...
 
                     // 1st segment
-                    int seg1size = m_size_max - m_end;
+                    size_type seg1size = m_size_max - m_end;
                     memory_copy_nolock(m_data+m_end, rb.m_data+rb_front, seg1size);
 
                     // 2nd segment
-                    int seg2size = rb_size - seg1size;
+                    size_type seg2size = rb_size - seg1size;
                     memory_copy_nolock(m_data, rb.m_data+rb_front+seg1size, seg2size);
 
                 } else {
@@ -668,15 +1095,15 @@ namespace acbench {
                         // .. handle the 3 resulting segments
 
                         // 1st segment
-                        int seg1size = rb.m_size_max - rb_front;
+                        size_type seg1size = rb.m_size_max - rb_front;
                         memory_copy_nolock(m_data+m_end, rb.m_data+rb_front, seg1size);
 
                         // 2nd segment
-                        int seg2size = (m_size_max-m_end) - seg1size;
+                        size_type seg2size = (m_size_max-m_end) - seg1size;
                         memory_copy_nolock(m_data+m_end+seg1size, rb.m_data, seg2size);
 
                         // 3rd segment
-                        int seg3size = rb_size - seg1size - seg2size;
+                        size_type seg3size = rb_size - seg1size - seg2size;
                         memory_copy_nolock(m_data, rb.m_data+seg2size, seg3size);
 
                     } else {
@@ -684,15 +1111,15 @@ namespace acbench {
                         // .. handle the 3 resulting segments
 
                         // 1st segment
-                        int seg1size = m_size_max - m_end;
+                        size_type seg1size = m_size_max - m_end;
                         memory_copy_nolock(m_data+m_end, rb.m_data+rb_front, seg1size);
 
                         // 2nd segment
-                        int seg2size = (rb.m_size_max-rb_front) - seg1size;
+                        size_type seg2size = (rb.m_size_max-rb_front) - seg1size;
                         memory_copy_nolock(m_data, rb.m_data+rb_front+seg1size, seg2size);
 
                         // 3rd segment
-                        int seg3size = rb_size - seg1size - seg2size;
+                        size_type seg3size = rb_size - seg1size - seg2size;
                         memory_copy_nolock(m_data+seg2size, rb.m_data, seg3size);
                     }
                 }
@@ -705,7 +1132,8 @@ namespace acbench {
 
             m_size += rb_size;
         }
-        inline void push_back(const ringbuffer<value_type>& rb, int start, int size) {
+        template<typename Lock2, typename Allocator2>
+        inline void push_back(const ringbuffer<value_type, Lock2, Allocator2, size_type>& rb, size_type start, size_type size) {
             ACBENCH_MUTEX_GUARD
             push_back_nolock(rb, start, size);
         }
@@ -729,7 +1157,7 @@ namespace acbench {
             ACBENCH_MUTEX_GUARD
             return pop_front_nolock();
         }
-        inline void pop_front_nolock(int n) {
+        inline void pop_front_nolock(size_type n) {
             if (n < 1) return;                // Just ignore pops of non-existing values
 
             if (n >= m_size) {                // Clears all if not enough to be poped
@@ -743,12 +1171,12 @@ namespace acbench {
 
             m_size -= n;
         }
-        inline void pop_front(int n) {
+        inline void pop_front(size_type n) {
             ACBENCH_MUTEX_GUARD
             pop_front_nolock(n);
         }
 
-        inline int pop_front_nolock(value_type* array, int n) {
+        inline size_type pop_front_nolock(value_type* array, size_type n) {
             if (n < 1) return 0;              // Just ignore pops of non-existing values
 
             if (n > m_size)                   // Pop as many values as possible
@@ -765,12 +1193,12 @@ namespace acbench {
                 // Need to slice the array into two segments
 
                 // 1st segment: m_front:m_size_max-1
-                int seg1size = m_size_max - m_front;
-                memory_copy_nolock(array, m_data+m_front, seg1size);
+                size_type seg1size = m_size_max - m_front;
+                memory_copy_nolock(array, m_data+m_front, seg1size, n);
 
                 // 2nd segment: 0:n-seg1size
-                int seg2size = n - seg1size;
-                memory_copy_nolock(array+seg1size, m_data, seg2size);
+                size_type seg2size = n - seg1size;
+                memory_copy_nolock(array+seg1size, m_data, seg2size, n);
 
                 m_front = seg2size;
             }
@@ -779,18 +1207,38 @@ namespace acbench {
 
             return n;
         }
-        inline int pop_front(value_type* array, int n) {
+        inline size_type pop_front(value_type* array, size_type n) {
             ACBENCH_MUTEX_GUARD
             return pop_front_nolock(array, n);
         }
+        //! Same as pop_front(array, N), with N known at compile time (ex. rb.pop_front<256>(block) for blocks of 256 values).
+        template<size_type N>
+        inline size_type pop_front_nolock(value_type* array) {
+            static_assert(N > 0, "The block size must be positive");
+            if ((m_size < N) || (m_front+N > m_size_max))
+                return pop_front_nolock(array, N);
+            simd::copy(reinterpret_cast<void*>(array), reinterpret_cast<const void*>(m_data+m_front), sizeof(value_type)*static_cast<std::size_t>(N));
+            m_front += N;
+            if (m_front >= m_size_max)
+                m_front = 0;
+            m_size -= N;
+            return N;
+        }
+        template<size_type N>
+        inline size_type pop_front(value_type* array) {
+            ACBENCH_MUTEX_GUARD
+            return pop_front_nolock<N>(array);
+        }
         // Equivalent to rb.push_back(*this) and this->clear()
-        inline int pop_front_nolock(ringbuffer<value_type>& rb) {
-            int this_size = size();
+        template<typename Lock2, typename Allocator2>
+        inline size_type pop_front_nolock(ringbuffer<value_type, Lock2, Allocator2, size_type>& rb) {
+            size_type this_size = size();
             rb.push_back_nolock(*this);
             this->clear_nolock();
             return this_size;
         }
-        inline int pop_front(ringbuffer<value_type>& rb) {
+        template<typename Lock2, typename Allocator2>
+        inline size_type pop_front(ringbuffer<value_type, Lock2, Allocator2, size_type>& rb) {
             ACBENCH_MUTEX_GUARD
             return pop_front_nolock(rb);
         }
@@ -799,7 +1247,7 @@ namespace acbench {
         inline value_type pop_back_nolock() {
             assert(m_size >= 1);
 
-            int back = m_end - 1;
+            size_type back = m_end - 1;
             if (back < 0)
                 back = m_size_max-1;
             assert((back >=0) && (back < m_size_max));
@@ -819,7 +1267,7 @@ namespace acbench {
             return pop_back_nolock();
         }
         // TODO TODO TODO To test
-        inline void pop_back_nolock(int n) {
+        inline void pop_back_nolock(size_type n) {
             if (n < 1) return;                // Just ignore pops of non-existing values
 
             if (n >= m_size) {                // Clears all if not enough to be poped
@@ -833,12 +1281,739 @@ namespace acbench {
 
             m_size -= n;
         }
-        inline void pop_back(int n) {
+        inline void pop_back(size_type n) {
             ACBENCH_MUTEX_GUARD
             pop_back_nolock(n);
         }
+
+        // Sample format conversions ------------------------------------------
+        // The samples are converted while copied into or out of the ringbuffer's memory (see acbench/sample_format.h),
+        // ex. for a ringbuffer<float> fed by a device delivering int16_t samples, instead of converting in a scratch array first.
+
+        //! Same as push_back(const value_type*, int), converting from sample_type.
+        //  The conversion kernels work on int sizes, so at most 2^31-1 values can be pushed or popped per call.
+        template<typename sample_type>
+        inline void push_back_nolock(const sample_type* array, size_type array_size) {
+            if (array_size <= 0)             // Ignore push of empty buffers
+                return;
+
+            memory_check_size_nolock(array_size);
+
+            size_type seg1size = std::min(array_size, m_size_max - m_end);
+            convert_samples(m_data+m_end, array, static_cast<int>(seg1size));
+            convert_samples(m_data, array+seg1size, static_cast<int>(array_size-seg1size));
+
+            m_end += array_size;
+            if (m_end >= m_size_max)
+                m_end -= m_size_max;
+
+            m_size += array_size;
+        }
+        template<typename sample_type>
+        inline void push_back(const sample_type* array, size_type array_size) {
+            ACBENCH_MUTEX_GUARD
+            push_back_nolock(array, array_size);
+        }
+        //! Same as pop_front(value_type*, int), converting to sample_type.
+        template<typename sample_type>
+        inline size_type pop_front_nolock(sample_type* array, size_type n) {
+            if (n < 1) return 0;              // Just ignore pops of non-existing values
+
+            if (n > m_size)                   // Pop as many values as possible
+                n = m_size;
+
+            size_type seg1size = std::min(n, m_size_max - m_front);
+            convert_samples(array, m_data+m_front, static_cast<int>(seg1size));
+            convert_samples(array+seg1size, m_data, static_cast<int>(n-seg1size));
+
+            m_front += n;
+            if (m_front >= m_size_max)
+                m_front -= m_size_max;
+
+            m_size -= n;
+
+            return n;
+        }
+        template<typename sample_type>
+        inline size_type pop_front(sample_type* array, size_type n) {
+            ACBENCH_MUTEX_GUARD
+            return pop_front_nolock(array, n);
+        }
+
+        // Zero-copy access ---------------------------------------------------
+        // Instead of copying through push_back(const value_type*, int) and pop_front(value_type*, int),
+        // the data can be written and read directly in the ringbuffer's memory,
+        // which is given as (at most) two contiguous regions, the second one starting at data().
+        // WARNING: The regions stay valid until the corresponding commit/consume only if no other thread
+        //          changes the ringbuffer meanwhile (use lock() and unlock() around if necessary).
+
+        //! Gives the regions where to write up to n values after the back.
+        //  Returns the number of values that can be written, ie. size1+size2, which is less than n if there is not enough space.
+        inline size_type write_reserve_nolock(size_type n, value_type** pdata1, size_type* size1, value_type** pdata2, size_type* size2) {
+            if (m_dynamic_allocation && m_size+n > m_size_max)
+                grow_allocation_nolock(m_size+n);
+
+            if (n > m_size_max - m_size)      // Reserve as many values as possible
+                n = m_size_max - m_size;
+            if (n < 0)
+                n = 0;
+
+            *pdata1 = m_data + m_end;
+            if (m_end+n <= m_size_max) {
+                *size1 = n;
+                *pdata2 = nullptr;
+                *size2 = 0;
+            } else {
+                *size1 = m_size_max - m_end;
+                *pdata2 = m_data;
+                *size2 = n - *size1;
+            }
+            return n;
+        }
+        inline size_type write_reserve(size_type n, value_type** pdata1, size_type* size1, value_type** pdata2, size_type* size2) {
+            ACBENCH_MUTEX_GUARD
+            return write_reserve_nolock(n, pdata1, size1, pdata2, size2);
+        }
+        //! Appends the n first values written in the regions given by write_reserve(.).
+        inline void write_commit_nolock(size_type n) {
+            if (n < 1) return;                // Ignore pushing no values
+            assert(m_size+n <= m_size_max);
+
+            m_end += n;
+            if (m_end >= m_size_max)
+                m_end -= m_size_max;
+
+            m_size += n;
+        }
+        inline void write_commit(size_type n) {
+            ACBENCH_MUTEX_GUARD
+            write_commit_nolock(n);
+        }
+
+        //! Gives the regions of the first n values, from the front.
+        //  Returns the number of values that can be read, ie. size1+size2, which is less than n if there is not enough values.
+        inline size_type read_peek_nolock(size_type n, const value_type** pdata1, size_type* size1, const value_type** pdata2, size_type* size2) const {
+            if (n > m_size)                   // Peek as many values as possible
+                n = m_size;
+            if (n < 0)
+                n = 0;
+
+            *pdata1 = m_data + m_front;
+            if (m_front+n <= m_size_max) {
+                *size1 = n;
+                *pdata2 = nullptr;
+                *size2 = 0;
+            } else {
+                *size1 = m_size_max - m_front;
+                *pdata2 = m_data;
+                *size2 = n - *size1;
+            }
+            return n;
+        }
+        inline size_type read_peek(size_type n, const value_type** pdata1, size_type* size1, const value_type** pdata2, size_type* size2) const {
+            ACBENCH_MUTEX_GUARD
+            return read_peek_nolock(n, pdata1, size1, pdata2, size2);
+        }
+        //! Removes the n first values, once read through read_peek(.). Equivalent to pop_front(n).
+        inline void read_consume_nolock(size_type n) {
+            pop_front_nolock(n);
+        }
+        inline void read_consume(size_type n) {
+            ACBENCH_MUTEX_GUARD
+            read_consume_nolock(n);
+        }
+
+        // Frames -------------------------------------------------------------
+        // For short-time analysis/synthesis (ex. STFT), where the signal is split into overlapping frames
+        // and the processed frames are overlap-added back into a signal:
+        //     while (rb_in.read_frame(frame, frame_len, hop, window) > 0) {
+        //         process(frame);
+        //         rb_out.add_overlap(frame, frame_len);
+        //         rb_out.pop_front(out, hop);  // The values that won't be overlapped by the next frames
+        //     }
+
+     protected:
+        inline void copy_window_nolock(value_type* pdest, const value_type* psrc, size_type size, const value_type* window) {
+            if (window == nullptr) {
+                memory_copy_nolock(pdest, psrc, size);
+                return;
+            }
+            for (size_type k = 0; k < size; ++k)
+                pdest[k] = psrc[k]*window[k];
+        }
+        inline void add_nolock(value_type* pdest, const value_type* psrc, size_type size) {
+            for (size_type k = 0; k < size; ++k)
+                pdest[k] += psrc[k];
+        }
+
+     public:
+        //! Copies the frame_len first values in out, multiplied by window if not null, then pops hop values.
+        //  Returns frame_len, or 0 (without copying nor poping anything) if there are less than frame_len values.
+        inline size_type read_frame_nolock(value_type* out, size_type frame_len, size_type hop, const value_type* window = nullptr) {
+            assert(frame_len > 0);
+            assert(hop > 0);
+            if (m_size < frame_len)
+                return 0;
+
+            size_type seg1size = std::min(frame_len, m_size_max - m_front);
+            copy_window_nolock(out, m_data+m_front, seg1size, window);
+            copy_window_nolock(out+seg1size, m_data, frame_len-seg1size, window ? window+seg1size : nullptr);
+
+            pop_front_nolock(hop);
+
+            return frame_len;
+        }
+        inline size_type read_frame(value_type* out, size_type frame_len, size_type hop, const value_type* window = nullptr) {
+            ACBENCH_MUTEX_GUARD
+            return read_frame_nolock(out, frame_len, hop, window);
+        }
+
+        //! Adds the array to the content, starting at the front, and pushes back the values that go beyond the back.
+        inline void add_overlap_nolock(const value_type* array, size_type array_size) {
+            if (array_size < 1) return;       // Ignore adding no values
+
+            size_type overlap = std::min(array_size, m_size);
+            size_type seg1size = std::min(overlap, m_size_max - m_front);
+            add_nolock(m_data+m_front, array, seg1size);
+            add_nolock(m_data, array+seg1size, overlap-seg1size);
+
+            if (array_size > overlap)
+                push_back_nolock(array+overlap, array_size-overlap);
+        }
+        inline void add_overlap(const value_type* array, size_type array_size) {
+            ACBENCH_MUTEX_GUARD
+            add_overlap_nolock(array, array_size);
+        }
+    };
+
+
+    #ifdef ACBENCH_MULTITHREADED
+
+    //! Lock-free single-producer/single-consumer ringbuffer (locking policy lock_spsc).
+    //  * push_back(.) functions must be called from one thread only (the producer),
+    //    pop_front(.) functions and element-wise accessors from one thread only (the consumer).
+    //  * The producer is the only one writing m_end and the consumer is the only one writing m_front.
+    //    Each side publishes its index with a release store and reads the other one with an acquire load,
+    //    so that the values copied before publishing are visible to the other side.
+    //  * One slot is kept empty to distinguish a full buffer from an empty one.
+    //    This is hidden from the user: resize_allocation(size_max) can hold size_max values.
+    //  * Like ringbuffer, there is no implicit allocation: push_back(.) pushes only what fits and
+    //    returns the number of values pushed.
+    template<typename T, typename Allocator, typename SizeType>
+    class ringbuffer<T, lock_spsc, Allocator, SizeType> {
+     public:
+        typedef T value_type;
+        typedef lock_spsc lock_type;
+        typedef Allocator allocator_type;
+        typedef SizeType size_type;
+
+     protected:
+        allocator_type m_allocator;
+
+        size_type m_size_max = 0;  // Allocated size, which is capacity()+1
+        T* m_data = nullptr;
+        std::atomic<size_type> m_front;  // Written by the consumer only
+        std::atomic<size_type> m_end;    // Written by the producer only. One after the last element
+
+        // Copy constructor is forbidden to avoid implicit calls.
+        explicit ringbuffer(const ringbuffer& rb) {
+            (void)rb;
+        }
+
+        // size_chunk is the size of the whole chunk when copying one of its segments (see simd::copy(.)).
+        inline void memory_copy_nolock(value_type* pdest, const value_type* psrc, size_type size, size_type size_chunk) {
+            assert(size >= 0);
+            simd::copy(reinterpret_cast<void*>(pdest), reinterpret_cast<const void*>(psrc), sizeof(value_type)*static_cast<std::size_t>(size), sizeof(value_type)*static_cast<std::size_t>(size_chunk));
+        }
+        inline void memory_copy_nolock(value_type* pdest, const value_type* psrc, size_type size) {
+            memory_copy_nolock(pdest, psrc, size, size);
+        }
+
+        inline size_type size_nolock(size_type front, size_type end) const {
+            size_type size = end - front;
+            if (size < 0)
+                size += m_size_max;
+            return size;
+        }
+
+     public:
+        ringbuffer()
+            : m_front(0)
+            , m_end(0) {
+        }
+        //! For stateful allocators (ex. allocator_arena<T>). Doesn't allocate.
+        explicit ringbuffer(const allocator_type& allocator)
+            : m_allocator(allocator)
+            , m_front(0)
+            , m_end(0) {
+        }
+        ~ringbuffer() {
+            if ( m_data ) {
+                m_allocator.deallocate(m_data, static_cast<std::size_t>(m_size_max));  // GCOVR_EXCL_LINE
+                m_data = nullptr;
+            }
+        }
+
+        //! Allocate a new memory block and clear any previous data.
+        //  WARNING: Not thread-safe, neither the producer nor the consumer should use the buffer meanwhile.
+        inline void resize_allocation(size_type size_max) {
+            assert(size_max > 0);
+            if (size_max+1 != m_size_max) {
+                if (m_data)
+                    m_allocator.deallocate(m_data, static_cast<std::size_t>(m_size_max));
+                m_data = m_allocator.allocate(static_cast<std::size_t>(size_max+1));  // GCOVR_EXCL_LINE
+                m_size_max = size_max+1;
+            }
+            clear();
+        }
+        //! Does keep the allocation
+        //  WARNING: Not thread-safe, neither the producer nor the consumer should use the buffer meanwhile.
+        inline void clear() {
+            m_front.store(0, std::memory_order_relaxed);
+            m_end.store(0, std::memory_order_relaxed);
+        }
+
+        inline bool is_thread_safe() const {
+            return true;
+        }
+        inline value_type* data() const {
+            return m_data;
+        }
+        inline size_type capacity() const {
+            return m_size_max > 0 ? m_size_max-1 : 0;
+        }
+        inline size_type size_max() const {
+            return capacity();
+        }
+        //! Exact when called from the producer or the consumer, though the other side might change it right after.
+        inline size_type size() const {
+            return size_nolock(m_front.load(std::memory_order_acquire), m_end.load(std::memory_order_acquire));
+        }
+        inline size_type size_free() const {
+            return capacity() - size();
+        }
+        inline bool empty() const {
+            return size() == 0;
+        }
+
+        // Producer side ------------------------------------------------------
+
+        inline size_type push_back(const value_type v) {
+            return push_back(&v, 1);
+        }
+        inline size_type push_back(const value_type value, size_type nb_values) {
+            const size_type end = m_end.load(std::memory_order_relaxed);
+            const size_type front = m_front.load(std::memory_order_acquire);
+
+            size_type nb_free = m_size_max - 1 - size_nolock(front, end);
+            if (nb_values > nb_free)          // Push as many values as possible
+                nb_values = nb_free;
+            if (nb_values <= 0)
+                return 0;
+
+            size_type seg1size = std::min(nb_values, m_size_max - end);
+            value_type* pdata = m_data+end;
+            for (size_type k=0; k < seg1size; ++k)
+                *pdata++ = value;
+            pdata = m_data;
+            for (size_type k=seg1size; k < nb_values; ++k)
+                *pdata++ = value;
+
+            size_type new_end = end + nb_values;
+            if (new_end >= m_size_max)
+                new_end -= m_size_max;
+            m_end.store(new_end, std::memory_order_release);
+
+            return nb_values;
+        }
+        inline size_type push_back(const value_type* array, size_type array_size) {
+            const size_type end = m_end.load(std::memory_order_relaxed);
+            const size_type front = m_front.load(std::memory_order_acquire);
+
+            size_type nb_free = m_size_max - 1 - size_nolock(front, end);
+            if (array_size > nb_free)         // Push as many values as possible
+                array_size = nb_free;
+            if (array_size <= 0)
+                return 0;
+
+            size_type new_end;
+            if (end+array_size <= m_size_max) {
+                // No need to slice it
+                memory_copy_nolock(m_data+end, array, array_size);
+                new_end = end + array_size;
+                if (new_end >= m_size_max)
+                    new_end = 0;
+
+            } else {
+                // Need to slice the array into two segments
+                size_type seg1size = m_size_max - end;
+                memory_copy_nolock(m_data+end, array, seg1size, array_size);
+                size_type seg2size = array_size - seg1size;
+                memory_copy_nolock(m_data, array+seg1size, seg2size, array_size);
+                new_end = seg2size;
+            }
+
+            m_end.store(new_end, std::memory_order_release);
+
+            return array_size;
+        }
+
+        //! Zero-copy writing, see ringbuffer<T, Lock>::write_reserve(.)
+        inline size_type write_reserve(size_type n, value_type** pdata1, size_type* size1, value_type** pdata2, size_type* size2) {
+            const size_type end = m_end.load(std::memory_order_relaxed);
+            const size_type front = m_front.load(std::memory_order_acquire);
+
+            size_type nb_free = m_size_max - 1 - size_nolock(front, end);
+            if (n > nb_free)                  // Reserve as many values as possible
+                n = nb_free;
+            if (n < 0)
+                n = 0;
+
+            *pdata1 = m_data + end;
+            if (end+n <= m_size_max) {
+                *size1 = n;
+                *pdata2 = nullptr;
+                *size2 = 0;
+            } else {
+                *size1 = m_size_max - end;
+                *pdata2 = m_data;
+                *size2 = n - *size1;
+            }
+            return n;
+        }
+        //! Publishes the n first values written in the regions given by write_reserve(.)
+        inline void write_commit(size_type n) {
+            if (n < 1) return;                // Ignore pushing no values
+            assert(n <= size_free());
+
+            size_type new_end = m_end.load(std::memory_order_relaxed) + n;
+            if (new_end >= m_size_max)
+                new_end -= m_size_max;
+            m_end.store(new_end, std::memory_order_release);
+        }
+
+        // Consumer side ------------------------------------------------------
+
+        //! Zero-copy reading, see ringbuffer<T, Lock>::read_peek(.)
+        inline size_type read_peek(size_type n, const value_type** pdata1, size_type* size1, const value_type** pdata2, size_type* size2) const {
+            const size_type front = m_front.load(std::memory_order_relaxed);
+            const size_type end = m_end.load(std::memory_order_acquire);
+
+            size_type size = size_nolock(front, end);
+            if (n > size)                     // Peek as many values as possible
+                n = size;
+            if (n < 0)
+                n = 0;
+
+            *pdata1 = m_data + front;
+            if (front+n <= m_size_max) {
+                *size1 = n;
+                *pdata2 = nullptr;
+                *size2 = 0;
+            } else {
+                *size1 = m_size_max - front;
+                *pdata2 = m_data;
+                *size2 = n - *size1;
+            }
+            return n;
+        }
+        //! Releases the n first values, once read through read_peek(.). Equivalent to pop_front(n).
+        inline size_type read_consume(size_type n) {
+            return pop_front(n);
+        }
+
+        //! WARNING: Consumer side only
+        inline value_type operator[](size_type n) const {
+            assert(n < size());
+            size_type idx = m_front.load(std::memory_order_relaxed) + n;
+            if (idx >= m_size_max)
+                idx -= m_size_max;
+            return m_data[idx];
+        }
+        inline value_type front() const {
+            assert(size() > 0);
+            return m_data[m_front.load(std::memory_order_relaxed)];
+        }
+        inline value_type pop_front() {
+            assert(size() > 0);
+            const size_type front = m_front.load(std::memory_order_relaxed);
+            value_type value = m_data[front];
+            m_front.store(front+1 < m_size_max ? front+1 : 0, std::memory_order_release);
+            return value;
+        }
+        //! Clears all if there are not enough values to be poped.
+        inline size_type pop_front(size_type n) {
+            const size_type front = m_front.load(std::memory_order_relaxed);
+            const size_type end = m_end.load(std::memory_order_acquire);
+
+            size_type size = size_nolock(front, end);
+            if (n > size)
+                n = size;
+            if (n < 1) return 0;              // Just ignore pops of non-existing values
+
+            size_type new_front = front + n;
+            if (new_front >= m_size_max)
+                new_front -= m_size_max;
+            m_front.store(new_front, std::memory_order_release);
+
+            return n;
+        }
+        inline size_type pop_front(value_type* array, size_type n) {
+            const size_type front = m_front.load(std::memory_order_relaxed);
+            const size_type end = m_end.load(std::memory_order_acquire);
+
+            size_type size = size_nolock(front, end);
+            if (n > size)                     // Pop as many values as possible
+                n = size;
+            if (n < 1) return 0;              // Just ignore pops of non-existing values
+
+            size_type new_front;
+            if (front+n <= m_size_max) {
+                // No need to slice it
+                memory_copy_nolock(array, m_data+front, n);
+                new_front = front + n;
+                if (new_front >= m_size_max)
+                    new_front = 0;
+
+            } else {
+                // Need to slice the array into two segments
+                size_type seg1size = m_size_max - front;
+                memory_copy_nolock(array, m_data+front, seg1size, n);
+                size_type seg2size = n - seg1size;
+                memory_copy_nolock(array+seg1size, m_data, seg2size, n);
+                new_front = seg2size;
+            }
+
+            m_front.store(new_front, std::memory_order_release);
+
+            return n;
+        }
     };
 
+    template<typename T, typename Allocator = allocator_new<T>, typename SizeType = int>
+    using spsc_ringbuffer = ringbuffer<T, lock_spsc, Allocator, SizeType>;
+
+    //! Multi-producer/multi-consumer ringbuffer (locking policy lock_mpmc), for pipelines fanning in or out
+    //  (ex. several decoder threads pushing into one ringbuffer).
+    //  * Each push_back(.) and pop_front(.) moves one chunk of contiguous values, which is never interleaved
+    //    with the values of another thread. The producers (consumers) first reserve their chunk by moving
+    //    the producers' (consumers') head forward with a compare-and-swap, then copy their values without any lock,
+    //    and finally publish them by moving the producers' (consumers') tail forward, in the order of the reservations.
+    //    Contended threads thus only retry a compare-and-swap instead of sleeping on a mutex.
+    //  * WARNING: A thread preempted between its reservation and its publication delays the publications of
+    //    the threads that reserved after it (they spin, then yield). Like lock_spsc, not for real-time threads
+    //    whose producers or consumers can be preempted by lower priority threads.
+    //  * The head and tail indices are 64 bits counters, which never wrap in practice. The allocation is rounded up
+    //    to a power of 2 so that the indices are masked instead of divided. This is hidden from the user:
+    //    resize_allocation(size_max) can hold size_max values.
+    //  * push_back(array, n) and pop_front(array, n) move as many values as possible, and
+    //    push_back_all(array, n) and pop_front_all(array, n) all the n values or none.
+    //  * There is no element-wise accessor, since any value can be popped by another consumer meanwhile.
+    template<typename T, typename Allocator, typename SizeType>
+    class ringbuffer<T, lock_mpmc, Allocator, SizeType> {
+     public:
+        typedef T value_type;
+        typedef lock_mpmc lock_type;
+        typedef Allocator allocator_type;
+        typedef SizeType size_type;
+
+     protected:
+        static const std::size_t cache_line_size = 64;
+
+        // Head: Reserved by the threads, Tail: Published to the other side
+        // Padded with a whole cache line (not aligned, which new doesn't honor before C++17), so that the indices
+        // of the producers and of the consumers never share a cache line, wherever the ringbuffer starts.
+        struct indices {
+            std::atomic<std::uint64_t> head;
+            std::atomic<std::uint64_t> tail;
+            char padding[cache_line_size];
+            indices() : head(0), tail(0) {}
+        };
+
+        allocator_type m_allocator;
+
+        size_type m_size_max = 0;    // Capacity
+        size_type m_size_alloc = 0;  // Allocated size, the power of 2 above m_size_max
+        std::uint64_t m_mask = 0;
+        T* m_data = nullptr;
+        char m_padding[cache_line_size];  // The members above, read by all the threads, don't share a cache line with m_prod
+
+        indices m_prod;
+        indices m_cons;
+
+        // Copy constructor is forbidden to avoid implicit calls.
+        explicit ringbuffer(const ringbuffer& rb) {
+            (void)rb;
+        }
+
+        // size_chunk is the size of the whole chunk when copying one of its segments (see simd::copy(.)).
+        inline void memory_copy_nolock(value_type* pdest, const value_type* psrc, size_type size, size_type size_chunk) {
+            assert(size >= 0);
+            simd::copy(reinterpret_cast<void*>(pdest), reinterpret_cast<const void*>(psrc), sizeof(value_type)*static_cast<std::size_t>(size), sizeof(value_type)*static_cast<std::size_t>(size_chunk));
+        }
+
+        // Moves the head of one side forward by up to n values, limited by the tail of the other side (plus offset).
+        // Returns the number of values reserved, the first one being at *pstart.
+        inline size_type reserve(indices& side, const indices& other, std::uint64_t offset, size_type n, bool all, std::uint64_t* pstart) {
+            if (n <= 0)                     // Ignore pushing or popping no values (and negative ones, which would wrap around once unsigned)
+                return 0;
+            std::uint64_t start = side.head.load(std::memory_order_relaxed);
+            size_type nb_reserved;
+            do {
+                nb_reserved = n;
+                std::uint64_t available = offset + other.tail.load(std::memory_order_acquire) - start;
+                if (static_cast<std::uint64_t>(nb_reserved) > available) {
+                    if (all) return 0;
+                    nb_reserved = static_cast<size_type>(available);
+                }
+                if (nb_reserved <= 0) return 0;
+            } while (!side.head.compare_exchange_weak(start, start + static_cast<std::uint64_t>(nb_reserved), std::memory_order_relaxed));
+            *pstart = start;
+            return nb_reserved;
+        }
+        // Moves the tail of one side forward, once the previous reservations are published.
+        inline void publish(indices& side, std::uint64_t start, size_type n) {
+            int nb_spins = 0;
+            while (side.tail.load(std::memory_order_acquire) != start) {
+                if (++nb_spins > 64) std::this_thread::yield();  // GCOVR_EXCL_LINE Spins first, then yields to the preempted thread
+            }
+            side.tail.store(start + static_cast<std::uint64_t>(n), std::memory_order_release);
+        }
+
+        inline void copy_in(std::uint64_t start, const value_type* array, size_type n) {
+            size_type idx = static_cast<size_type>(start & m_mask);
+            size_type seg1size = std::min(n, m_size_alloc - idx);
+            memory_copy_nolock(m_data+idx, array, seg1size, n);
+            if (seg1size < n)
+                memory_copy_nolock(m_data, array+seg1size, n - seg1size, n);
+        }
+        inline void copy_out(std::uint64_t start, value_type* array, size_type n) {
+            size_type idx = static_cast<size_type>(start & m_mask);
+            size_type seg1size = std::min(n, m_size_alloc - idx);
+            memory_copy_nolock(array, m_data+idx, seg1size, n);
+            if (seg1size < n)
+                memory_copy_nolock(array+seg1size, m_data, n - seg1size, n);
+        }
+
+        inline size_type push_back_chunk(const value_type* array, size_type array_size, bool all) {
+            std::uint64_t start = 0;
+            array_size = reserve(m_prod, m_cons, static_cast<std::uint64_t>(m_size_max), array_size, all, &start);
+            if (array_size == 0)
+                return 0;
+            copy_in(start, array, array_size);
+            publish(m_prod, start, array_size);
+            return array_size;
+        }
+        inline size_type pop_front_chunk(value_type* array, size_type n, bool all) {
+            std::uint64_t start = 0;
+            n = reserve(m_cons, m_prod, 0, n, all, &start);
+            if (n == 0)
+                return 0;
+            if (array)
+                copy_out(start, array, n);
+            publish(m_cons, start, n);
+            return n;
+        }
+
+     public:
+        ringbuffer() {
+        }
+        //! For stateful allocators (ex. allocator_arena<T>). Doesn't allocate.
+        explicit ringbuffer(const allocator_type& allocator)
+            : m_allocator(allocator) {
+        }
+        ~ringbuffer() {
+            if ( m_data ) {
+                m_allocator.deallocate(m_data, static_cast<std::size_t>(m_size_alloc));  // GCOVR_EXCL_LINE
+                m_data = nullptr;
+            }
+        }
+
+        //! Allocate a new memory block and clear any previous data.
+        //  WARNING: Not thread-safe, no producer nor consumer should use the buffer meanwhile.
+        inline void resize_allocation(size_type size_max) {
+            assert(size_max > 0);
+            size_type size_alloc = 1;
+            while (size_alloc < size_max)
+                size_alloc *= 2;
+            if (size_alloc != m_size_alloc) {
+                if (m_data)
+                    m_allocator.deallocate(m_data, static_cast<std::size_t>(m_size_alloc));
+                m_data = m_allocator.allocate(static_cast<std::size_t>(size_alloc));  // GCOVR_EXCL_LINE
+                m_size_alloc = size_alloc;
+                m_mask = static_cast<std::uint64_t>(size_alloc - 1);
+            }
+            m_size_max = size_max;
+            clear();
+        }
+        //! Does keep the allocation
+        //  WARNING: Not thread-safe, no producer nor consumer should use the buffer meanwhile.
+        inline void clear() {
+            m_prod.head.store(0, std::memory_order_relaxed);
+            m_prod.tail.store(0, std::memory_order_relaxed);
+            m_cons.head.store(0, std::memory_order_relaxed);
+            m_cons.tail.store(0, std::memory_order_relaxed);
+        }
+
+        inline bool is_thread_safe() const {
+            return true;
+        }
+        inline value_type* data() const {
+            return m_data;
+        }
+        inline size_type capacity() const {
+            return m_size_max;
+        }
+        inline size_type size_max() const {
+            return m_size_max;
+        }
+        //! Number of values published and not yet released, which other threads might change right after.
+        inline size_type size() const {
+            std::uint64_t cons_tail = m_cons.tail.load(std::memory_order_acquire);
+            return static_cast<size_type>(m_prod.tail.load(std::memory_order_acquire) - cons_tail);
+        }
+        inline size_type size_free() const {
+            return capacity() - size();
+        }
+        inline bool empty() const {
+            return size() == 0;
+        }
+
+        // Producers side -----------------------------------------------------
+
+        inline size_type push_back(const value_type v) {
+            return push_back_chunk(&v, 1, true);
+        }
+        //! Pushes as many values of the chunk as possible, contiguously. Returns the number of values pushed.
+        inline size_type push_back(const value_type* array, size_type array_size) {
+            return push_back_chunk(array, array_size, false);
+        }
+        //! Pushes all the values of the chunk, contiguously, or none if there is not enough space. Returns the number of values pushed.
+        inline size_type push_back_all(const value_type* array, size_type array_size) {
+            return push_back_chunk(array, array_size, true);
+        }
+
+        // Consumers side -----------------------------------------------------
+
+        //! Pops as many values as possible, up to n, contiguously. Returns the number of values popped.
+        inline size_type pop_front(value_type* array, size_type n) {
+            return pop_front_chunk(array, n, false);
+        }
+        //! Pops n values, contiguously, or none if there are not enough values. Returns the number of values popped.
+        inline size_type pop_front_all(value_type* array, size_type n) {
+            return pop_front_chunk(array, n, true);
+        }
+        //! Releases up to n values without reading them. Returns the number of values released.
+        inline size_type pop_front(size_type n) {
+            return pop_front_chunk(nullptr, n, false);
+        }
+    };
+
+    template<typename T, typename Allocator = allocator_new<T>, typename SizeType = int>
+    using mpmc_ringbuffer = ringbuffer<T, lock_mpmc, Allocator, SizeType>;
+
+    #endif  // ACBENCH_MULTITHREADED
+
 }  // namespace acbench
 
 #endif  // ACBENCH_RINGBUFFER_H_
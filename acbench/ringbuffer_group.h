@@ -0,0 +1,214 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#ifndef ACBENCH_RINGBUFFER_GROUP_H_
+#define ACBENCH_RINGBUFFER_GROUP_H_
+
+/**
+
+Group of ringbuffers sharing a single mutex, ex. the sources of a mixer.
+
+    Each ringbuffer of the group has its own content, front and end (conversely to acbench::multichannel_ringbuffer,
+    whose channels are always of the same size), but all are protected by the group's mutex.
+    The batch functions lock this mutex once and then loop over the ringbuffers, instead of locking and unlocking
+    the mutex of each ringbuffer:
+        push_back_many(arrays, n)           Pushes n values into each ringbuffer.
+        pop_front_many(arrays, n, sizes)    Pops up to n values from each ringbuffer.
+        pop_front_mix(out, n, gains)        Pops up to n values from each ringbuffer, mixed (summed) into out.
+    The single ringbuffers are also accessible with buffer(i), within a .lock() and .unlock() block.
+
+Allocation:
+    Only resize_allocation(nb_buffers, size_max) allocates memory (the destructor deallocates it).
+    The values of all the ringbuffers, as well as the array of ringbuffers itself, are allocated through the Allocator
+    given to the constructor (if any), so that an allocator_arena leaves the global heap untouched.
+    The ringbuffers are of fixed capacity, there is no dynamic allocation.
+
+Thread-safety:
+    Same as acbench::ringbuffer, chosen with the Lock template argument (std::mutex, lock_spinlock or lock_none).
+
+**/
+
+#include <acbench/ringbuffer.h>
+#include <acbench/simd.h>
+
+#include <new>  // For the placement new
+
+
+namespace acbench {
+
+    template<typename T, typename Lock = lock_default, typename Allocator = allocator_new<T>>
+    class ringbuffer_group {
+        static_assert(!is_lock_free_policy<Lock>::value, "lock_spsc and lock_mpmc are not supported by ringbuffer_group");
+
+     public:
+        typedef T value_type;
+        typedef Lock lock_type;
+        typedef Allocator allocator_type;
+        typedef ringbuffer<T, lock_none, Allocator> buffer_type;  // The mutex is the group's
+
+     protected:
+        typedef typename Allocator::template rebind<char>::other bytes_allocator_type;  // For the array of ringbuffers
+
+        ACBENCH_MUTEX_DECLARE
+
+        allocator_type m_allocator;
+        buffer_type* m_buffers = nullptr;
+        int m_nb_buffers = 0;
+        int m_size_max = 0;
+
+        inline void destroy_nolock() {
+            if ( m_buffers ) {
+                for (int i = 0; i < m_nb_buffers; ++i)
+                    m_buffers[i].~buffer_type();
+                bytes_allocator_type(m_allocator).deallocate(reinterpret_cast<char*>(m_buffers), sizeof(buffer_type)*m_nb_buffers);
+                m_buffers = nullptr;
+                m_nb_buffers = 0;
+            }
+        }
+
+        // Copy constructor is forbidden to avoid implicit calls.
+        explicit ringbuffer_group(const ringbuffer_group& group) {
+            (void)group;
+        }
+        // So is copy assignment (the ringbuffers would be shared and destroyed twice).
+        ringbuffer_group& operator=(const ringbuffer_group&) = delete;
+
+        // out[k] += gain*x[k] for the n first values x of the given segments
+        static inline void accumulate_nolock(value_type* out, const value_type* pdata1, int size1, const value_type* pdata2, int size2, value_type gain) {
+            simd::multiply_accumulate(out, pdata1, gain, size1);
+            if (size2 > 0)
+                simd::multiply_accumulate(out+size1, pdata2, gain, size2);
+        }
+
+     public:
+        ringbuffer_group() {
+        }
+        //! For stateful allocators (ex. allocator_arena<T>), given to all the ringbuffers. Doesn't allocate.
+        explicit ringbuffer_group(const allocator_type& allocator)
+            : m_allocator(allocator) {
+        }
+        ~ringbuffer_group() {
+            ACBENCH_MUTEX_GUARD
+            this->destroy_nolock();
+        }
+
+        //! Allocate nb_buffers ringbuffers of size_max values each, and clear any previous data.
+        inline void resize_allocation(int nb_buffers, int size_max) {
+            assert(nb_buffers > 0);
+            assert(size_max > 0);
+            ACBENCH_MUTEX_GUARD
+            if (nb_buffers != m_nb_buffers) {
+                this->destroy_nolock();
+                m_buffers = reinterpret_cast<buffer_type*>(bytes_allocator_type(m_allocator).allocate(sizeof(buffer_type)*nb_buffers));
+                for (int i = 0; i < nb_buffers; ++i)
+                    new (m_buffers+i) buffer_type(m_allocator);  // Doesn't allocate
+                m_nb_buffers = nb_buffers;
+            }
+            for (int i = 0; i < m_nb_buffers; ++i)
+                m_buffers[i].resize_allocation(size_max);
+            m_size_max = size_max;
+        }
+
+        //! Clears all the ringbuffers. Does keep the allocation
+        inline void clear() {
+            ACBENCH_MUTEX_GUARD
+            for (int i = 0; i < m_nb_buffers; ++i)
+                m_buffers[i].clear();
+        }
+
+        inline void lock() {
+            ACBENCH_MUTEX_LOCK
+        }
+        inline void unlock() {
+            ACBENCH_MUTEX_UNLOCK
+        }
+        //! This is usefull to build a guard object out of the group's mutex.
+        inline lock_type& mutex() const {
+            return m_mutex;
+        }
+        inline bool is_thread_safe() const {
+            return !std::is_same<lock_type, lock_none>::value;
+        }
+
+        inline int nb_buffers() const {
+            return m_nb_buffers;          // Atomic, no need of locked mutex
+        }
+        //! Capacity of each ringbuffer
+        inline int size_max() const {
+            return m_size_max;            // Atomic, no need of locked mutex
+        }
+
+        //! WARNING: Not thread-safe
+        inline buffer_type& buffer(int i) {
+            assert((i >= 0) && (i < m_nb_buffers));
+            return m_buffers[i];
+        }
+        //! WARNING: Not thread-safe
+        inline const buffer_type& buffer(int i) const {
+            assert((i >= 0) && (i < m_nb_buffers));
+            return m_buffers[i];
+        }
+
+        //! Pushes array_size values into the i-th ringbuffer only.
+        inline void push_back_nolock(int i, const value_type* array, int array_size) {
+            assert((i >= 0) && (i < m_nb_buffers));
+            m_buffers[i].push_back_nolock(array, array_size);
+        }
+        inline void push_back(int i, const value_type* array, int array_size) {
+            ACBENCH_MUTEX_GUARD
+            push_back_nolock(i, array, array_size);
+        }
+
+        //! Pushes the n values of arrays[i] into the i-th ringbuffer, for all the ringbuffers.
+        inline void push_back_many_nolock(const value_type* const* arrays, int n) {
+            for (int i = 0; i < m_nb_buffers; ++i)
+                m_buffers[i].push_back_nolock(arrays[i], n);
+        }
+        inline void push_back_many(const value_type* const* arrays, int n) {
+            ACBENCH_MUTEX_GUARD
+            push_back_many_nolock(arrays, n);
+        }
+
+        //! Pops up to n values from the i-th ringbuffer into arrays[i], for all the ringbuffers.
+        //  If sizes is not null, sizes[i] is the number of values popped from the i-th ringbuffer.
+        inline void pop_front_many_nolock(value_type* const* arrays, int n, int* sizes = nullptr) {
+            for (int i = 0; i < m_nb_buffers; ++i) {
+                int size = m_buffers[i].pop_front_nolock(arrays[i], n);
+                if (sizes)
+                    sizes[i] = size;
+            }
+        }
+        inline void pop_front_many(value_type* const* arrays, int n, int* sizes = nullptr) {
+            ACBENCH_MUTEX_GUARD
+            pop_front_many_nolock(arrays, n, sizes);
+        }
+
+        //! out[k] = sum_i gains[i]*x_i[k], x_i being the n values popped from the i-th ringbuffer (all gains are 1 if gains is null).
+        //  A ringbuffer holding less than n values contributes only its values (as if padded with zeros).
+        //  The values are accumulated straight from the ringbuffers' memory, without intermediate copies.
+        inline void pop_front_mix_nolock(value_type* out, int n, const value_type* gains = nullptr) {
+            if (n < 1) return;                // Just ignore pops of non-existing values
+            std::fill(out, out+n, value_type(0));
+            for (int i = 0; i < m_nb_buffers; ++i) {
+                const value_type* pdata1;
+                const value_type* pdata2;
+                int size1, size2;
+                int size = m_buffers[i].read_peek_nolock(n, &pdata1, &size1, &pdata2, &size2);
+                accumulate_nolock(out, pdata1, size1, pdata2, size2, gains ? gains[i] : value_type(1));
+                m_buffers[i].read_consume_nolock(size);
+            }
+        }
+        inline void pop_front_mix(value_type* out, int n, const value_type* gains = nullptr) {
+            ACBENCH_MUTEX_GUARD
+            pop_front_mix_nolock(out, n, gains);
+        }
+    };
+
+}  // namespace acbench
+
+#endif  // ACBENCH_RINGBUFFER_GROUP_H_
@@ -0,0 +1,151 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#include <acbench/ringbuffer_group.h>
+
+#include "utils.h"
+
+#include <cmath>
+#include <deque>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+typedef acbench::ringbuffer_group<float> test_t;
+typedef std::vector<std::deque<float>> ref_t;
+
+void group_require_equals(const test_t& test, const ref_t& ref) {
+    REQUIRE(test.nb_buffers() == static_cast<int>(ref.size()));
+    for (int i = 0; i < test.nb_buffers(); ++i)
+        REQUIRE(acbench::compare(ref[i], test.buffer(i)));
+}
+
+// Pushes n random values into each ringbuffer
+void group_push_back_many_rand(test_t& test, ref_t& ref, int n) {
+    std::vector<std::vector<float>> arrays(test.nb_buffers(), std::vector<float>(n));
+    std::vector<const float*> parrays(test.nb_buffers());
+    for (int i = 0; i < test.nb_buffers(); ++i) {
+        for (int k = 0; k < n; ++k) {
+            arrays[i][k] = acbench::rand_uniform_continuous_01<float>();
+            ref[i].push_back(arrays[i][k]);
+        }
+        parrays[i] = arrays[i].data();
+    }
+    test.push_back_many(parrays.data(), n);
+}
+
+TEST_CASE("ringbuffer_group_allocation") {
+    test_t test;
+    REQUIRE(test.is_thread_safe());
+    REQUIRE(!acbench::ringbuffer_group<float, acbench::lock_none>().is_thread_safe());
+    REQUIRE(test.nb_buffers() == 0);
+
+    test.resize_allocation(4, 100);
+    REQUIRE(test.nb_buffers() == 4);
+    REQUIRE(test.size_max() == 100);
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(test.buffer(i).size_max() == 100);
+        REQUIRE(test.buffer(i).empty());
+    }
+
+    ref_t ref(4);
+    group_push_back_many_rand(test, ref, 10);
+    group_require_equals(test, ref);
+
+    // Same number of buffers, only the capacity changes
+    test.resize_allocation(4, 50);
+    REQUIRE(test.size_max() == 50);
+    REQUIRE(test.buffer(3).size_max() == 50);
+    REQUIRE(test.buffer(3).empty());
+
+    test.resize_allocation(8, 50);
+    REQUIRE(test.nb_buffers() == 8);
+    ref = ref_t(8);
+    group_push_back_many_rand(test, ref, 10);
+    group_require_equals(test, ref);
+    test.clear();
+    for (int i = 0; i < 8; ++i)
+        REQUIRE(test.buffer(i).empty());
+
+    test.lock();
+    test.buffer(0).push_back(1.0f);
+    test.unlock();
+    {
+        std::lock_guard<std::mutex> guard(test.mutex());
+        REQUIRE(test.buffer(0).size() == 1);
+    }
+}
+
+TEST_CASE("ringbuffer_group_push_pop") {
+    test_t test;
+    test.resize_allocation(3, 100);
+    ref_t ref(3);
+
+    // Buffers with different sizes
+    std::vector<float> array(50);
+    for (int k = 0; k < 50; ++k)
+        array[k] = acbench::rand_uniform_continuous_01<float>();
+    test.push_back(1, array.data(), 50);
+    ref[1].insert(ref[1].end(), array.begin(), array.end());
+    group_push_back_many_rand(test, ref, 30);
+    group_require_equals(test, ref);
+
+    std::vector<std::vector<float>> arrays(3, std::vector<float>(60));
+    std::vector<float*> parrays = {arrays[0].data(), arrays[1].data(), arrays[2].data()};
+    std::vector<int> sizes(3);
+    test.pop_front_many(parrays.data(), 60, sizes.data());
+    REQUIRE(sizes == std::vector<int>({30, 60, 30}));
+    for (int i = 0; i < 3; ++i) {
+        for (int k = 0; k < sizes[i]; ++k)
+            REQUIRE(arrays[i][k] == ref[i][k]);
+        ref[i].erase(ref[i].begin(), ref[i].begin()+sizes[i]);
+    }
+    group_require_equals(test, ref);
+
+    // Across the end of the allocations, without sizes
+    group_push_back_many_rand(test, ref, 80);
+    REQUIRE(test.buffer(0).front_data_index() == 30);
+    test.pop_front_many(parrays.data(), 60);
+    for (int i = 0; i < 3; ++i) {
+        for (int k = 0; k < 60; ++k)
+            REQUIRE(arrays[i][k] == ref[i][k]);
+        ref[i].erase(ref[i].begin(), ref[i].begin()+60);
+    }
+    group_require_equals(test, ref);
+}
+
+TEST_CASE("ringbuffer_group_mix") {
+    test_t test;
+    test.resize_allocation(3, 100);
+    ref_t ref(3);
+    std::vector<float> out(60);
+
+    // Nothing to mix
+    test.pop_front_mix(out.data(), 0);
+
+    for (int iter = 0; iter < 10; ++iter) {
+        group_push_back_many_rand(test, ref, 40);
+        std::vector<float> array(iter);
+        test.push_back(2, array.data(), iter);  // Zeros, so that the buffers are of different sizes
+        ref[2].insert(ref[2].end(), array.begin(), array.end());
+
+        bool with_gains = (iter % 2) == 0;
+        std::vector<float> gains = {0.5f, -1.0f, 2.0f};
+        test.pop_front_mix(out.data(), 45, with_gains ? gains.data() : nullptr);
+        for (int k = 0; k < 45; ++k) {
+            float expected = 0.0f;
+            for (int i = 0; i < 3; ++i)
+                if (k < static_cast<int>(ref[i].size()))
+                    expected += (with_gains ? gains[i] : 1.0f)*ref[i][k];
+            REQUIRE(std::abs(out[k] - expected) < 1e-6f);
+        }
+        for (int i = 0; i < 3; ++i)
+            ref[i].erase(ref[i].begin(), ref[i].begin()+std::min(45, static_cast<int>(ref[i].size())));
+        group_require_equals(test, ref);
+    }
+}
@@ -0,0 +1,163 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#ifndef ACBENCH_RINGBUFFER_MATH_H_
+#define ACBENCH_RINGBUFFER_MATH_H_
+
+/**
+
+Math operations directly on the content of acbench::ringbuffer.
+
+    The operations run over the (at most two) contiguous segments of the ringbuffer (see ringbuffer::segments()),
+    with the vectorized kernels of acbench/simd.h, so that there is no need to copy the content out and back in.
+
+    In-place:
+        scale(rb, gain)                         rb[n] *= gain
+        add(rb, array)  add(rb, rb2)            rb[n] += array[n]
+        multiply(rb, array)  multiply(rb, rb2)  rb[n] *= array[n]
+        multiply_accumulate(rb, array, gain)    rb[n] += gain*array[n]  (also with a ringbuffer rb2)
+        gain_ramp(rb, gain_start, gain_end)     rb[n] *= gain_start + (gain_end-gain_start)*n/rb.size()
+    Reductions:
+        sum(rb), rms(rb), peak(rb) (maximum absolute value)
+
+    The arrays and the ringbuffers rb2 must hold at least rb.size() values.
+
+Thread-safety:
+    The functions lock the mutex of the ringbuffers (both of them for the binary operations, always in the same order).
+
+**/
+
+#include <acbench/ringbuffer.h>
+#include <acbench/simd.h>
+
+#include <cmath>       // For std::sqrt(.)
+
+
+namespace acbench {
+
+    namespace detail {
+
+        // Calls f(p, array, size) on each contiguous segment of rb, with the matching part of the array.
+        template<typename T, typename Lock, typename Allocator, typename F>
+        inline void apply_segments(ringbuffer<T, Lock, Allocator>& rb, const T* array, F f) {
+            segment_pair<T> segs = rb.segments();
+            f(segs.first.data(), array, segs.first.size());
+            f(segs.second.data(), array + segs.first.size(), segs.second.size());
+        }
+
+        // Calls f(p, p2, size) on each contiguous part that is shared by the segments of rb and rb2 (at most three parts).
+        template<typename T, typename Lock, typename Allocator, typename Lock2, typename Allocator2, typename F>
+        inline void apply_segments(ringbuffer<T, Lock, Allocator>& rb, const ringbuffer<T, Lock2, Allocator2>& rb2, F f) {
+            assert(rb2.size() >= rb.size());
+            segment_pair<T> segs = rb.segments();
+            segment_pair<const T> segs2 = rb2.segments();
+            segment<T> s1[2] = {segs.first, segs.second};
+            segment<const T> s2[2] = {segs2.first, segs2.second};
+            int i1 = 0, i2 = 0;
+            int offset1 = 0, offset2 = 0;
+            int remaining = rb.size();
+            while (remaining > 0) {
+                if (offset1 == s1[i1].size()) {
+                    ++i1;
+                    offset1 = 0;
+                }
+                if (offset2 == s2[i2].size()) {
+                    ++i2;
+                    offset2 = 0;
+                }
+                int size = std::min(s1[i1].size()-offset1, s2[i2].size()-offset2);
+                f(s1[i1].data()+offset1, s2[i2].data()+offset2, size);
+                offset1 += size;
+                offset2 += size;
+                remaining -= size;
+            }
+        }
+
+    }  // namespace detail
+
+    template<typename T, typename Lock, typename Allocator>
+    inline void scale(ringbuffer<T, Lock, Allocator>& rb, T gain) {
+        lock_guard<Lock> mutex_lock(rb.mutex());
+        segment_pair<T> segs = rb.segments();
+        simd::scale(segs.first.data(), segs.first.size(), gain);
+        simd::scale(segs.second.data(), segs.second.size(), gain);
+    }
+
+    template<typename T, typename Lock, typename Allocator>
+    inline void add(ringbuffer<T, Lock, Allocator>& rb, const T* array) {
+        lock_guard<Lock> mutex_lock(rb.mutex());
+        detail::apply_segments(rb, array, [](T* p, const T* a, int size) { simd::add(p, a, size); });
+    }
+    template<typename T, typename Lock, typename Allocator, typename Lock2, typename Allocator2>
+    inline void add(ringbuffer<T, Lock, Allocator>& rb, const ringbuffer<T, Lock2, Allocator2>& rb2) {
+        lock_guard_pair<Lock, Lock2> mutex_lock(rb.mutex(), rb2.mutex());
+        detail::apply_segments(rb, rb2, [](T* p, const T* a, int size) { simd::add(p, a, size); });
+    }
+
+    template<typename T, typename Lock, typename Allocator>
+    inline void multiply(ringbuffer<T, Lock, Allocator>& rb, const T* array) {
+        lock_guard<Lock> mutex_lock(rb.mutex());
+        detail::apply_segments(rb, array, [](T* p, const T* a, int size) { simd::multiply(p, a, size); });
+    }
+    template<typename T, typename Lock, typename Allocator, typename Lock2, typename Allocator2>
+    inline void multiply(ringbuffer<T, Lock, Allocator>& rb, const ringbuffer<T, Lock2, Allocator2>& rb2) {
+        lock_guard_pair<Lock, Lock2> mutex_lock(rb.mutex(), rb2.mutex());
+        detail::apply_segments(rb, rb2, [](T* p, const T* a, int size) { simd::multiply(p, a, size); });
+    }
+
+    template<typename T, typename Lock, typename Allocator>
+    inline void multiply_accumulate(ringbuffer<T, Lock, Allocator>& rb, const T* array, T gain) {
+        lock_guard<Lock> mutex_lock(rb.mutex());
+        detail::apply_segments(rb, array, [gain](T* p, const T* a, int size) { simd::multiply_accumulate(p, a, gain, size); });
+    }
+    template<typename T, typename Lock, typename Allocator, typename Lock2, typename Allocator2>
+    inline void multiply_accumulate(ringbuffer<T, Lock, Allocator>& rb, const ringbuffer<T, Lock2, Allocator2>& rb2, T gain) {
+        lock_guard_pair<Lock, Lock2> mutex_lock(rb.mutex(), rb2.mutex());
+        detail::apply_segments(rb, rb2, [gain](T* p, const T* a, int size) { simd::multiply_accumulate(p, a, gain, size); });
+    }
+
+    //! Linear gain from gain_start at the front, towards gain_end after the back
+    //  (ie. the next block starts at gain_end, as when smoothing a gain change over consecutive blocks).
+    template<typename T, typename Lock, typename Allocator>
+    inline void gain_ramp(ringbuffer<T, Lock, Allocator>& rb, T gain_start, T gain_end) {
+        lock_guard<Lock> mutex_lock(rb.mutex());
+        if (rb.size() == 0)
+            return;
+        T step = (gain_end - gain_start) / static_cast<T>(rb.size());
+        segment_pair<T> segs = rb.segments();
+        simd::gain_ramp(segs.first.data(), segs.first.size(), gain_start, step);
+        simd::gain_ramp(segs.second.data(), segs.second.size(), gain_start + static_cast<T>(segs.first.size())*step, step);
+    }
+
+    template<typename T, typename Lock, typename Allocator>
+    inline T sum(const ringbuffer<T, Lock, Allocator>& rb) {
+        lock_guard<Lock> mutex_lock(rb.mutex());
+        segment_pair<const T> segs = rb.segments();
+        return simd::sum(segs.first.data(), segs.first.size()) + simd::sum(segs.second.data(), segs.second.size());
+    }
+    //! Root mean square (0 if empty)
+    template<typename T, typename Lock, typename Allocator>
+    inline T rms(const ringbuffer<T, Lock, Allocator>& rb) {
+        lock_guard<Lock> mutex_lock(rb.mutex());
+        if (rb.size() == 0)
+            return T(0);
+        segment_pair<const T> segs = rb.segments();
+        T sum_squares = simd::sum_squares(segs.first.data(), segs.first.size()) + simd::sum_squares(segs.second.data(), segs.second.size());
+        return std::sqrt(sum_squares / static_cast<T>(rb.size()));
+    }
+    //! Maximum absolute value (0 if empty)
+    template<typename T, typename Lock, typename Allocator>
+    inline T peak(const ringbuffer<T, Lock, Allocator>& rb) {
+        lock_guard<Lock> mutex_lock(rb.mutex());
+        segment_pair<const T> segs = rb.segments();
+        return std::max(simd::peak(segs.first.data(), segs.first.size()), simd::peak(segs.second.data(), segs.second.size()));
+    }
+
+}  // namespace acbench
+
+#endif  // ACBENCH_RINGBUFFER_MATH_H_
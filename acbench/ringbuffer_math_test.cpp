@@ -0,0 +1,140 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#include <acbench/ringbuffer_math.h>
+
+#include "utils.h"
+
+#include <cmath>
+#include <deque>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+typedef acbench::ringbuffer<float> test_t;
+typedef std::deque<double> ref_t;
+
+// Fills with size random values in [-1,1], with the front at the given index of the allocation
+void rbm_fill(test_t& test, ref_t& ref, int size_max, int front, int size) {
+    test.resize_allocation(size_max);
+    ref.clear();
+    // Popping all the values would clear the ringbuffer and bring the front back to 0, so keep one until the end
+    test.push_back(0.0f, front+1);
+    test.pop_front(front);
+    for (int n = 0; n < size; ++n) {
+        float v = 2.0f*acbench::rand_uniform_continuous_01<float>() - 1.0f;
+        test.push_back(v);
+        ref.push_back(v);
+    }
+    test.pop_front();
+}
+
+void rbm_require_equals(const test_t& test, const ref_t& ref) {
+    REQUIRE(test.size() == static_cast<int>(ref.size()));
+    for (int n = 0; n < test.size(); ++n)
+        REQUIRE(std::abs(test[n] - ref[n]) < 1e-5);
+}
+
+TEST_CASE("ringbuffer_math_unary") {
+    for (int front : {0, 30, 90}) {
+        test_t test;
+        ref_t ref;
+        rbm_fill(test, ref, 100, front, 50);
+
+        acbench::scale(test, 0.5f);
+        for (double& v : ref)
+            v *= 0.5;
+        rbm_require_equals(test, ref);
+
+        std::vector<float> array(50);
+        for (int n = 0; n < 50; ++n)
+            array[n] = 2.0f*acbench::rand_uniform_continuous_01<float>() - 1.0f;
+        acbench::add(test, array.data());
+        for (int n = 0; n < 50; ++n)
+            ref[n] += array[n];
+        rbm_require_equals(test, ref);
+        acbench::multiply(test, array.data());
+        for (int n = 0; n < 50; ++n)
+            ref[n] *= array[n];
+        rbm_require_equals(test, ref);
+        acbench::multiply_accumulate(test, array.data(), 0.25f);
+        for (int n = 0; n < 50; ++n)
+            ref[n] += 0.25*array[n];
+        rbm_require_equals(test, ref);
+
+        acbench::gain_ramp(test, 1.0f, 0.5f);
+        for (int n = 0; n < 50; ++n)
+            ref[n] *= 1.0 - 0.5*n/50.0;
+        rbm_require_equals(test, ref);
+
+        double sum = 0.0, sum_squares = 0.0, peak = 0.0;
+        for (double v : ref) {
+            sum += v;
+            sum_squares += v*v;
+            peak = std::max(peak, std::abs(v));
+        }
+        REQUIRE(std::abs(acbench::sum(test) - sum) < 1e-5);
+        REQUIRE(std::abs(acbench::rms(test) - std::sqrt(sum_squares/50)) < 1e-5);
+        REQUIRE(std::abs(acbench::peak(test) - peak) < 1e-6);
+    }
+
+    // Empty
+    test_t test;
+    acbench::scale(test, 2.0f);
+    acbench::gain_ramp(test, 0.0f, 1.0f);
+    REQUIRE(acbench::sum(test) == 0.0f);
+    REQUIRE(acbench::rms(test) == 0.0f);
+    REQUIRE(acbench::peak(test) == 0.0f);
+
+    // Other value types use the generic kernels
+    acbench::ringbuffer<double, acbench::lock_none> test_double;
+    test_double.resize_allocation(10);
+    test_double.push_back(-2.0, 10);
+    acbench::scale(test_double, 0.5);
+    REQUIRE(acbench::sum(test_double) == -10.0);
+    REQUIRE(acbench::peak(test_double) == 1.0);
+}
+
+TEST_CASE("ringbuffer_math_binary") {
+    // All combinations of wrap points between the two ringbuffers
+    for (int front : {0, 30, 70, 90}) {
+        for (int front2 : {0, 20, 60, 95}) {
+            test_t test, test2;
+            ref_t ref, ref2;
+            rbm_fill(test, ref, 100, front, 50);
+            rbm_fill(test2, ref2, 100, front2, 60);
+
+            acbench::add(test, test2);
+            for (int n = 0; n < 50; ++n)
+                ref[n] += ref2[n];
+            rbm_require_equals(test, ref);
+
+            acbench::multiply(test, test2);
+            for (int n = 0; n < 50; ++n)
+                ref[n] *= ref2[n];
+            rbm_require_equals(test, ref);
+
+            acbench::multiply_accumulate(test, test2, -0.5f);
+            for (int n = 0; n < 50; ++n)
+                ref[n] += -0.5*ref2[n];
+            rbm_require_equals(test, ref);
+        }
+    }
+
+    // Between different locking policies
+    test_t test;
+    ref_t ref;
+    rbm_fill(test, ref, 100, 80, 40);
+    acbench::ringbuffer<float, acbench::lock_none> test_nolock;
+    test_nolock.resize_allocation(40);
+    test_nolock.push_back(1.0f, 40);
+    acbench::add(test, test_nolock);
+    acbench::add(test_nolock, test);  // Locks in the other order
+    for (int n = 0; n < 40; ++n)
+        REQUIRE(std::abs(test_nolock[n] - (2.0 + ref[n])) < 1e-5);
+}
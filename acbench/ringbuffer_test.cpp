@@ -10,7 +10,13 @@
 
 #include "utils.h"
 
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -1546,3 +1552,1047 @@ TEST_CASE("ringbuffer_pop_back_wrap_coverage") {
     REQUIRE(val == 2.0f);
     REQUIRE(test.size() == 2);
 }
+
+TEST_CASE("spsc_ringbuffer_single_thread") {
+    acbench::spsc_ringbuffer<float> test;
+    ref_t ref;
+    test.resize_allocation(8);
+    REQUIRE(test.is_thread_safe());
+    REQUIRE(test.capacity() == 8);
+    REQUIRE(test.size_max() == 8);
+    REQUIRE(test.data() != nullptr);
+    REQUIRE(test.empty());
+    REQUIRE(test.size_free() == 8);
+
+    float data[10];
+    for (int i = 0; i < 10; ++i)
+        data[i] = static_cast<float>(i);
+
+    // Shortcuts
+    REQUIRE(test.push_back(data, 0) == 0);
+    REQUIRE(test.pop_front(data, 0) == 0);
+    REQUIRE(test.pop_front(0) == 0);
+
+    // Only what fits is pushed
+    REQUIRE(test.push_back(data, 10) == 8);
+    REQUIRE(test.size() == 8);
+    REQUIRE(test.push_back(1.0f) == 0);
+    REQUIRE(test.push_back(1.0f, 3) == 0);
+    for (int i = 0; i < 8; ++i)
+        ref.push_back(data[i]);
+    rb_require_equals(test, ref);
+
+    // Wrap the array in two segments
+    float out[10];
+    REQUIRE(test.pop_front(out, 6) == 6);
+    rb_require_equals_array(out, data, 6);
+    for (int i = 0; i < 6; ++i)
+        ref.pop_front();
+    REQUIRE(test.push_back(data, 5) == 5);
+    for (int i = 0; i < 5; ++i)
+        ref.push_back(data[i]);
+    rb_require_equals(test, ref);
+
+    // Pop as many values as possible, across the wrap
+    REQUIRE(test.pop_front(out, 10) == 7);
+    for (int i = 0; i < 7; ++i) {
+        REQUIRE(out[i] == ref.front());
+        ref.pop_front();
+    }
+    REQUIRE(test.empty());
+
+    // Constant values, across the wrap
+    REQUIRE(test.push_back(2.0f, 4) == 4);
+    REQUIRE(test.push_back(3.0f, 4) == 4);
+    for (int i = 0; i < 4; ++i)
+        ref.push_back(2.0f);
+    for (int i = 0; i < 4; ++i)
+        ref.push_back(3.0f);
+    rb_require_equals(test, ref);
+    REQUIRE(test.front() == 2.0f);
+
+    // Single values and skips
+    REQUIRE(test.pop_front(3) == 3);
+    REQUIRE(test.pop_front() == 2.0f);
+    REQUIRE(test.push_back(4.0f) == 1);
+    REQUIRE(test.pop_front(10) == 5);
+    REQUIRE(test.empty());
+
+    // Reaching the end exactly
+    test.resize_allocation(4);
+    REQUIRE(test.push_back(data, 4) == 4);
+    REQUIRE(test.pop_front(out, 4) == 4);
+    rb_require_equals_array(out, data, 4);
+    REQUIRE(test.push_back(data, 1) == 1);
+    REQUIRE(test.pop_front(out, 1) == 1);
+    REQUIRE(test.empty());
+
+    test.resize_allocation(16);
+    REQUIRE(test.capacity() == 16);
+    test.push_back(data, 3);
+    test.clear();
+    REQUIRE(test.empty());
+}
+
+TEST_CASE("spsc_ringbuffer_two_threads") {
+    acbench::spsc_ringbuffer<float> test;
+    test.resize_allocation(100);
+
+    const int nb_values = 100000;
+    const int chunk_size = 37;
+
+    std::thread producer([&]() {
+        float chunk[chunk_size];
+        int n = 0;
+        while (n < nb_values) {
+            int size = std::min(chunk_size, nb_values - n);
+            for (int i = 0; i < size; ++i)
+                chunk[i] = static_cast<float>(n + i);
+            int pushed = 0;
+            while (pushed < size)
+                pushed += test.push_back(chunk + pushed, size - pushed);
+            n += size;
+        }
+    });
+
+    std::vector<float> received;
+    received.reserve(nb_values);
+    float chunk[chunk_size];
+    while (static_cast<int>(received.size()) < nb_values) {
+        int n = test.pop_front(chunk, chunk_size);
+        for (int i = 0; i < n; ++i)
+            received.push_back(chunk[i]);
+    }
+    producer.join();
+
+    REQUIRE(test.empty());
+    for (int n = 0; n < nb_values; ++n)
+        REQUIRE(received[n] == static_cast<float>(n));
+}
+
+TEST_CASE("mpmc_ringbuffer_single_thread") {
+    acbench::mpmc_ringbuffer<float> test;
+    ref_t ref;
+    test.resize_allocation(6);  // Allocated with 8 values
+    REQUIRE(test.is_thread_safe());
+    REQUIRE(test.capacity() == 6);
+    REQUIRE(test.size_max() == 6);
+    REQUIRE(test.data() != nullptr);
+    REQUIRE(test.empty());
+    REQUIRE(test.size_free() == 6);
+
+    float data[10];
+    for (int i = 0; i < 10; ++i)
+        data[i] = static_cast<float>(i);
+    float out[10];
+
+    // Shortcuts
+    REQUIRE(test.push_back(data, 0) == 0);
+    REQUIRE(test.pop_front(out, 0) == 0);
+    REQUIRE(test.pop_front(out, 3) == 0);
+    REQUIRE(test.pop_front_all(out, 3) == 0);
+    REQUIRE(test.pop_front(3) == 0);
+
+    // Zero and negative sizes are ignored, also when there are values and space
+    REQUIRE(test.push_back(data, 2) == 2);
+    REQUIRE(test.push_back(data, -1) == 0);
+    REQUIRE(test.push_back_all(data, -1) == 0);
+    REQUIRE(test.push_back_all(data, 0) == 0);
+    REQUIRE(test.pop_front(out, -1) == 0);
+    REQUIRE(test.pop_front_all(out, -1) == 0);
+    REQUIRE(test.pop_front_all(out, 0) == 0);
+    REQUIRE(test.pop_front(-1) == 0);
+    REQUIRE(test.size() == 2);
+    REQUIRE(test.pop_front(2) == 2);
+
+    // Only what fits is pushed, and all or nothing
+    REQUIRE(test.push_back_all(data, 7) == 0);
+    REQUIRE(test.empty());
+    REQUIRE(test.push_back(data, 10) == 6);
+    REQUIRE(test.size() == 6);
+    REQUIRE(test.push_back(1.0f) == 0);
+    REQUIRE(test.push_back(data, 1) == 0);
+
+    // Pops all or nothing
+    REQUIRE(test.pop_front_all(out, 7) == 0);
+    REQUIRE(test.pop_front_all(out, 5) == 5);
+    rb_require_equals_array(out, data, 5);
+    REQUIRE(test.size() == 1);
+
+    // Wrap the chunks in two segments
+    REQUIRE(test.push_back_all(data, 4) == 4);
+    REQUIRE(test.push_back(7.0f) == 1);
+    ref.push_back(data[5]);
+    for (int i = 0; i < 4; ++i)
+        ref.push_back(data[i]);
+    ref.push_back(7.0f);
+    REQUIRE(test.pop_front(out, 10) == 6);
+    for (int i = 0; i < 6; ++i) {
+        REQUIRE(out[i] == ref.front());
+        ref.pop_front();
+    }
+    REQUIRE(test.empty());
+
+    // Skips
+    REQUIRE(test.push_back(data, 5) == 5);
+    REQUIRE(test.pop_front(2) == 2);
+    REQUIRE(test.pop_front(out, 1) == 1);
+    REQUIRE(out[0] == data[2]);
+    REQUIRE(test.pop_front(10) == 2);
+    REQUIRE(test.empty());
+
+    // Same allocation, then a new one
+    test.resize_allocation(8);
+    REQUIRE(test.capacity() == 8);
+    REQUIRE(test.push_back(data, 10) == 8);
+    test.resize_allocation(9);
+    REQUIRE(test.capacity() == 9);
+    REQUIRE(test.empty());
+    REQUIRE(test.push_back(data, 10) == 9);
+    test.clear();
+    REQUIRE(test.empty());
+
+    acbench::allocator_new<float> allocator;
+    acbench::mpmc_ringbuffer<float> test_allocator(allocator);
+    REQUIRE(test_allocator.data() == nullptr);
+}
+
+TEST_CASE("mpmc_ringbuffer_threads") {
+    acbench::mpmc_ringbuffer<int> test;
+    test.resize_allocation(100);
+
+    // Each value is the producer's index times nb_values plus its position in the producer's sequence
+    const int nb_producers = 4;
+    const int nb_consumers = 3;
+    const int nb_values = 20000;
+    const int chunk_size = 16;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < nb_producers; ++p) {
+        producers.push_back(std::thread([&test, p, nb_values, chunk_size]() {
+            int chunk[chunk_size];
+            for (int n = 0; n < nb_values; n += chunk_size) {
+                for (int i = 0; i < chunk_size; ++i)
+                    chunk[i] = p*nb_values + n + i;
+                while (test.push_back_all(chunk, chunk_size) == 0) {}
+            }
+        }));
+    }
+
+    std::atomic<int> nb_popped(0);
+    std::vector<std::vector<int>> received(nb_consumers);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < nb_consumers; ++c) {
+        consumers.push_back(std::thread([&test, &nb_popped, &received, c, nb_producers, nb_values, chunk_size]() {
+            int chunk[chunk_size];
+            while (nb_popped.load() < nb_producers*nb_values) {
+                int n = test.pop_front_all(chunk, chunk_size);
+                for (int i = 0; i < n; ++i)
+                    received[c].push_back(chunk[i]);
+                nb_popped += n;
+            }
+        }));
+    }
+    for (auto& producer : producers)
+        producer.join();
+    for (auto& consumer : consumers)
+        consumer.join();
+
+    REQUIRE(test.empty());
+
+    // Chunks are never interleaved, and each producer's chunks are popped in order by each consumer
+    std::vector<int> all;
+    for (int c = 0; c < nb_consumers; ++c) {
+        std::vector<int> last(nb_producers, -1);
+        for (std::size_t k = 0; k < received[c].size(); k += chunk_size) {
+            int p = received[c][k] / nb_values;
+            REQUIRE(received[c][k] % chunk_size == 0);
+            REQUIRE(received[c][k] > last[p]);
+            last[p] = received[c][k];
+            for (int i = 1; i < chunk_size; ++i)
+                REQUIRE(received[c][k+i] == received[c][k] + i);
+        }
+        all.insert(all.end(), received[c].begin(), received[c].end());
+    }
+    std::sort(all.begin(), all.end());
+    REQUIRE(static_cast<int>(all.size()) == nb_producers*nb_values);
+    for (int n = 0; n < nb_producers*nb_values; ++n)
+        REQUIRE(all[n] == n);
+}
+
+template<typename Lock>
+void rb_lock_policy_check(bool thread_safe) {
+    acbench::ringbuffer<float, Lock> test;
+    ref_t ref;
+    test.resize_allocation(8);
+    REQUIRE(test.is_thread_safe() == thread_safe);
+
+    float data[8];
+    for (int i = 0; i < 8; ++i)
+        data[i] = static_cast<float>(i);
+
+    test.push_back(data, 6);
+    for (int i = 0; i < 6; ++i)
+        ref.push_back(data[i]);
+    test.pop_front(4);
+    for (int i = 0; i < 4; ++i)
+        ref.pop_front();
+    test.push_back(data, 5);  // Wraps
+    for (int i = 0; i < 5; ++i)
+        ref.push_back(data[i]);
+    rb_require_equals(test, ref);
+
+    // Element-wise access within a lock() / unlock() block
+    test.lock();
+    REQUIRE(test[0] == ref[0]);
+    test.unlock();
+    {
+        acbench::lock_guard<typename acbench::ringbuffer<float, Lock>::lock_type> guard(test.mutex());
+        REQUIRE(test[1] == ref[1]);
+    }
+    REQUIRE(test.mutex().try_lock());
+    test.mutex().unlock();
+
+    // Exchange data with ringbuffers using another locking policy
+    acbench::ringbuffer<float, acbench::lock_none> local;
+    local.resize_allocation(16);
+    local.push_back(test);
+    rb_require_equals(local, ref);
+    local.push_back(test, 2, 3);
+    REQUIRE(local.size() == 10);
+    REQUIRE(local[7] == ref[2]);
+
+    test.clear();
+    test.push_back(local, 0, 7);
+    rb_require_equals(test, ref);
+    test.clear();
+    local.pop_front(5);
+    REQUIRE(local.pop_front(test) == 5);
+    REQUIRE(local.empty());
+    REQUIRE(test.size() == 5);
+}
+
+TEST_CASE("ringbuffer_lock_policies") {
+    rb_lock_policy_check<acbench::lock_none>(false);
+    rb_lock_policy_check<acbench::lock_spinlock>(true);
+    rb_lock_policy_check<std::mutex>(true);
+    REQUIRE(test_t().is_thread_safe());
+}
+
+TEST_CASE("ringbuffer_spinlock_two_threads") {
+    acbench::ringbuffer<float, acbench::lock_spinlock> test;
+    test.resize_allocation(20000);
+
+    const int nb_values = 10000;
+    std::thread producer([&]() {
+        for (int n = 0; n < nb_values; ++n)
+            test.push_back(1.0f);
+    });
+    for (int n = 0; n < nb_values; ++n)
+        test.push_back(2.0f);
+    producer.join();
+
+    REQUIRE(test.size() == 2*nb_values);
+    float sum = 0.0f;
+    while (!test.empty())
+        sum += test.pop_front();
+    REQUIRE(sum == 3.0f*nb_values);
+}
+
+TEST_CASE("ringbuffer_zero_copy") {
+    test_t test;
+    ref_t ref;
+    test.resize_allocation(8);
+
+    float* pw1 = nullptr; float* pw2 = nullptr;
+    const float* pr1 = nullptr; const float* pr2 = nullptr;
+    int size1 = 0, size2 = 0;
+
+    // Contiguous
+    REQUIRE(test.write_reserve(5, &pw1, &size1, &pw2, &size2) == 5);
+    REQUIRE(pw1 == test.data());
+    REQUIRE(size1 == 5);
+    REQUIRE(pw2 == nullptr);
+    REQUIRE(size2 == 0);
+    for (int i = 0; i < 5; ++i) {
+        pw1[i] = static_cast<float>(i);
+        ref.push_back(static_cast<float>(i));
+    }
+    test.write_commit(5);
+    rb_require_equals(test, ref);
+
+    REQUIRE(test.read_peek(3, &pr1, &size1, &pr2, &size2) == 3);
+    REQUIRE(size1 == 3);
+    REQUIRE(size2 == 0);
+    REQUIRE(pr1[2] == 2.0f);
+    test.read_consume(3);
+    ref.pop_front(); ref.pop_front(); ref.pop_front();
+    rb_require_equals(test, ref);
+
+    // Two regions, and clipped to the free space
+    REQUIRE(test.write_reserve(10, &pw1, &size1, &pw2, &size2) == 6);
+    REQUIRE(size1 == 3);
+    REQUIRE(pw2 == test.data());
+    REQUIRE(size2 == 3);
+    for (int i = 0; i < size1; ++i) {
+        pw1[i] = static_cast<float>(10+i);
+        ref.push_back(static_cast<float>(10+i));
+    }
+    for (int i = 0; i < size2; ++i) {
+        pw2[i] = static_cast<float>(20+i);
+        ref.push_back(static_cast<float>(20+i));
+    }
+    test.write_commit(6);
+    REQUIRE(test.size() == 8);
+    rb_require_equals(test, ref);
+
+    REQUIRE(test.read_peek(10, &pr1, &size1, &pr2, &size2) == 8);
+    REQUIRE(size1 == 5);
+    REQUIRE(size2 == 3);
+    for (int i = 0; i < size1; ++i)
+        REQUIRE(pr1[i] == ref[i]);
+    for (int i = 0; i < size2; ++i)
+        REQUIRE(pr2[i] == ref[size1+i]);
+    test.read_consume(8);
+    REQUIRE(test.empty());
+
+    // Shortcuts
+    test.write_commit(0);
+    REQUIRE(test.write_reserve(-1, &pw1, &size1, &pw2, &size2) == 0);
+    REQUIRE(test.read_peek(-1, &pr1, &size1, &pr2, &size2) == 0);
+
+    // Dynamic allocation grows to fit the reservation
+    test.set_dynamic_allocation(true);
+    test.push_back(1.0f, 6);
+    REQUIRE(test.write_reserve(10, &pw1, &size1, &pw2, &size2) == 10);
+    REQUIRE(test.capacity() >= 16);
+}
+
+TEST_CASE("spsc_ringbuffer_zero_copy") {
+    acbench::spsc_ringbuffer<float> test;
+    ref_t ref;
+    test.resize_allocation(8);  // 9 slots allocated
+
+    float* pw1 = nullptr; float* pw2 = nullptr;
+    const float* pr1 = nullptr; const float* pr2 = nullptr;
+    int size1 = 0, size2 = 0;
+
+    REQUIRE(test.write_reserve(6, &pw1, &size1, &pw2, &size2) == 6);
+    REQUIRE(size1 == 6);
+    REQUIRE(size2 == 0);
+    for (int i = 0; i < 6; ++i) {
+        pw1[i] = static_cast<float>(i);
+        ref.push_back(static_cast<float>(i));
+    }
+    test.write_commit(6);
+    rb_require_equals(test, ref);
+
+    REQUIRE(test.read_peek(4, &pr1, &size1, &pr2, &size2) == 4);
+    REQUIRE(size1 == 4);
+    REQUIRE(size2 == 0);
+    REQUIRE(test.read_consume(4) == 4);
+    for (int i = 0; i < 4; ++i)
+        ref.pop_front();
+
+    // Two regions, and clipped to the free space
+    REQUIRE(test.write_reserve(10, &pw1, &size1, &pw2, &size2) == 6);
+    REQUIRE(size1 == 3);
+    REQUIRE(size2 == 3);
+    REQUIRE(pw2 == test.data());
+    for (int i = 0; i < size1; ++i) {
+        pw1[i] = static_cast<float>(10+i);
+        ref.push_back(static_cast<float>(10+i));
+    }
+    for (int i = 0; i < size2; ++i) {
+        pw2[i] = static_cast<float>(20+i);
+        ref.push_back(static_cast<float>(20+i));
+    }
+    test.write_commit(6);
+    REQUIRE(test.size() == 8);
+    rb_require_equals(test, ref);
+
+    REQUIRE(test.read_peek(10, &pr1, &size1, &pr2, &size2) == 8);
+    REQUIRE(size1 == 5);
+    REQUIRE(size2 == 3);
+    for (int i = 0; i < size1; ++i)
+        REQUIRE(pr1[i] == ref[i]);
+    for (int i = 0; i < size2; ++i)
+        REQUIRE(pr2[i] == ref[size1+i]);
+    REQUIRE(test.read_consume(8) == 8);
+    REQUIRE(test.empty());
+
+    // Commit up to the end of the allocation
+    REQUIRE(test.write_reserve(5, &pw1, &size1, &pw2, &size2) == 5);
+    REQUIRE(size1 == 5);
+    test.write_commit(5);
+    REQUIRE(test.read_consume(5) == 5);
+
+    // Shortcuts
+    test.write_commit(0);
+    REQUIRE(test.write_reserve(-1, &pw1, &size1, &pw2, &size2) == 0);
+    REQUIRE(test.read_peek(-1, &pr1, &size1, &pr2, &size2) == 0);
+}
+
+TEST_CASE("ringbuffer_pow2") {
+    test_t test;
+    ref_t ref;
+
+    test.resize_allocation_pow2(100);
+    REQUIRE(test.capacity() == 128);
+    REQUIRE(test.is_size_max_pow2());
+    test.resize_allocation_pow2(128);
+    REQUIRE(test.capacity() == 128);
+
+    // Element-wise access with wrapped data
+    rb_push_back_rand(test, ref, 100);
+    rb_pop_front(test, ref, 90);
+    rb_push_back_rand(test, ref, 100);
+    rb_require_equals(test, ref);
+    test[105] = 1.0f;
+    ref[105] = 1.0f;
+    const test_t& test_const = test;
+    REQUIRE(test_const[105] == 1.0f);
+    rb_require_equals(test, ref);
+
+    // Dynamic growth keeps a power of two
+    test.set_dynamic_allocation(true);
+    rb_push_back_rand(test, ref, 100);
+    REQUIRE(test.capacity() == 256);
+    REQUIRE(test.is_size_max_pow2());
+    rb_require_equals(test, ref);
+
+    // Any allocation to a non power of two falls back on the modulo
+    test.reserve(300);
+    REQUIRE(!test.is_size_max_pow2());
+    test.resize_allocation(64);
+    REQUIRE(test.is_size_max_pow2());
+    test.resize_allocation(1);
+    REQUIRE(!test.is_size_max_pow2());
+    test.resize_allocation_pow2(1);
+    REQUIRE(test.capacity() == 1);
+    test.push_back(2.0f);
+    REQUIRE(test[0] == 2.0f);
+}
+
+TEST_CASE("ringbuffer_iterators") {
+    test_t test;
+    ref_t ref;
+    test.resize_allocation(100);
+
+    REQUIRE(test.begin() == test.end());
+    REQUIRE(std::accumulate(test.begin(), test.end(), 0.0f) == 0.0f);
+
+    // Wrapped data
+    rb_push_back_rand(test, ref, 80);
+    rb_pop_front(test, ref, 70);
+    rb_push_back_rand(test, ref, 60);
+    REQUIRE(test.front_data_index() + test.size() > test.size_max());
+    REQUIRE(test.end() - test.begin() == test.size());
+    REQUIRE(std::equal(test.begin(), test.end(), ref.begin()));
+
+    int n = 0;
+    for (float v : test)
+        REQUIRE(v == ref[n++]);
+    REQUIRE(n == test.size());
+
+    // Random access
+    test_t::iterator it = test.begin();
+    REQUIRE(*(it+40) == ref[40]);
+    REQUIRE(*(40+it) == ref[40]);
+    REQUIRE(it[50] == ref[50]);
+    it += 50;
+    REQUIRE(*it == ref[50]);
+    it -= 20;
+    REQUIRE(*it == ref[30]);
+    REQUIRE(*(it-30) == ref[0]);
+    REQUIRE(*(it++) == ref[30]);
+    REQUIRE(*(it--) == ref[31]);
+    REQUIRE(*(++it) == ref[31]);
+    REQUIRE(*(--it) == ref[30]);
+    REQUIRE(it - test.begin() == 30);
+    REQUIRE(it != test.begin());
+    REQUIRE(test.begin() < it);
+    REQUIRE(it > test.begin());
+    REQUIRE(test.begin() <= it);
+    REQUIRE(it >= test.begin());
+
+    // Writes through the iterators
+    *it = 1.0f;
+    ref[30] = 1.0f;
+    for (float& v : test)
+        v *= 2.0f;
+    for (float& v : ref)
+        v *= 2.0f;
+    rb_require_equals(test, ref);
+    std::sort(test.begin(), test.end());
+    std::sort(ref.begin(), ref.end());
+    rb_require_equals(test, ref);
+
+    // Const iterators
+    const test_t& test_const = test;
+    test_t::const_iterator cit = test.begin();  // Conversion from iterator
+    REQUIRE(cit == test_const.begin());
+    REQUIRE(test.cbegin() == test_const.begin());
+    REQUIRE(test.cend() == test_const.end());
+    REQUIRE(*std::max_element(test_const.begin(), test_const.end()) == ref.back());
+    REQUIRE(test_t::const_iterator() == test_t::const_iterator());
+
+    struct point { float x; };
+    acbench::ringbuffer<point> test_points;
+    test_points.resize_allocation(4);
+    test_points.push_back(point{3.0f});
+    REQUIRE(test_points.begin()->x == 3.0f);
+}
+
+TEST_CASE("ringbuffer_segments") {
+    test_t test;
+    ref_t ref;
+
+    // No allocation
+    auto segs_empty = test.segments();
+    REQUIRE(segs_empty.first.empty());
+    REQUIRE(segs_empty.second.empty());
+
+    test.resize_allocation(100);
+
+    // Contiguous data
+    rb_push_back_rand(test, ref, 60);
+    rb_pop_front(test, ref, 40);
+    auto segs = test.segments();
+    REQUIRE(segs.first.data() == test.data()+40);
+    REQUIRE(segs.first.size() == 20);
+    REQUIRE(segs.second.size() == 0);
+    REQUIRE(segs.second.begin() == segs.second.end());
+
+    // Wrapped data
+    rb_push_back_rand(test, ref, 70);
+    segs = test.segments();
+    REQUIRE(segs.first.size() == 60);
+    REQUIRE(segs.second.data() == test.data());
+    REQUIRE(segs.second.size() == 30);
+    int n = 0;
+    for (const auto& seg : {segs.first, segs.second})
+        for (float v : seg)
+            REQUIRE(v == ref[n++]);
+    REQUIRE(n == test.size());
+    REQUIRE(segs.second[0] == ref[60]);
+
+    float sum = std::accumulate(segs.first.begin(), segs.first.end(), 0.0f);
+    sum = std::accumulate(segs.second.begin(), segs.second.end(), sum);
+    REQUIRE(sum == std::accumulate(ref.begin(), ref.end(), 0.0f));
+
+    // Writes through the segments
+    for (float& v : segs.second)
+        v = 0.0f;
+    for (int i = 60; i < 90; ++i)
+        ref[i] = 0.0f;
+    rb_require_equals(test, ref);
+
+    // Const version
+    const test_t& test_const = test;
+    auto csegs = test_const.segments();
+    REQUIRE(csegs.first.size() == 60);
+    REQUIRE(csegs.second.size() == 30);
+    REQUIRE(csegs.first[0] == ref[0]);
+    test.pop_front(70);
+    csegs = test_const.segments();
+    REQUIRE(csegs.first.size() == 20);
+    REQUIRE(csegs.second.empty());
+}
+
+TEST_CASE("ringbuffer_allocator") {
+    acbench::ringbuffer<float, acbench::lock_none, acbench::allocator_new<float>> test;
+    acbench::allocator_new<float> alloc = test.get_allocator();
+    acbench::allocator_new<double> alloc_rebound(alloc);
+    REQUIRE(alloc_rebound == acbench::allocator_new<double>());
+    REQUIRE(!(alloc_rebound != acbench::allocator_new<double>()));
+
+    test.resize_allocation(30);
+    test.push_back(1.0f, 10);
+    test_t test_default;
+    test_default.resize_allocation(20);
+    test_default.push_back(test);
+    test_default.pop_front(test);
+    REQUIRE(test.size() == 20);
+}
+
+TEST_CASE("ringbuffer_read_frame") {
+    test_t test;
+    ref_t ref;
+    rb_init(test, ref, 100);
+
+    float frame[40];
+    float window[40];
+    for (int k = 0; k < 40; ++k)
+        window[k] = 0.5f + 0.01f*k;
+
+    // Not enough values
+    rb_push_back_rand(test, ref, 30);
+    REQUIRE(test.read_frame(frame, 40, 10) == 0);
+    REQUIRE(test.size() == 30);
+
+    // Contiguous frames, without and with window
+    rb_push_back_rand(test, ref, 30);
+    REQUIRE(test.read_frame(frame, 40, 10) == 40);
+    for (int k = 0; k < 40; ++k)
+        REQUIRE(frame[k] == ref[k]);
+    for (int k = 0; k < 10; ++k)
+        ref.pop_front();
+    rb_require_equals(test, ref);
+    REQUIRE(test.read_frame(frame, 40, 10, window) == 40);
+    for (int k = 0; k < 40; ++k)
+        REQUIRE(frame[k] == ref[k]*window[k]);
+    for (int k = 0; k < 10; ++k)
+        ref.pop_front();
+
+    // Frames across the end of the allocation, without and with window
+    rb_pop_front(test, ref, 30);
+    rb_push_back_rand(test, ref, 70);
+    REQUIRE(test.front_data_index() == 50);
+    REQUIRE(test.read_frame(frame, 40, 20) == 40);
+    for (int k = 0; k < 40; ++k)
+        REQUIRE(frame[k] == ref[k]);
+    for (int k = 0; k < 20; ++k)
+        ref.pop_front();
+    REQUIRE(test.front_data_index() == 70);
+    REQUIRE(test.read_frame(frame, 40, 20, window) == 40);
+    for (int k = 0; k < 40; ++k)
+        REQUIRE(frame[k] == ref[k]*window[k]);
+    for (int k = 0; k < 20; ++k)
+        ref.pop_front();
+    rb_require_equals(test, ref);
+
+    // Hop larger than the content
+    REQUIRE(test.read_frame_nolock(frame, 30, 50) == 30);
+    REQUIRE(test.empty());
+}
+
+TEST_CASE("ringbuffer_add_overlap") {
+    test_t test;
+    ref_t ref;
+    rb_init(test, ref, 100);
+
+    float frame[40];
+    for (int k = 0; k < 40; ++k)
+        frame[k] = acbench::rand_uniform_continuous_01<float>();
+
+    // Nothing to add
+    test.add_overlap(frame, 0);
+    REQUIRE(test.empty());
+
+    // Empty, all is pushed
+    test.add_overlap(frame, 40);
+    for (int k = 0; k < 40; ++k)
+        ref.push_back(frame[k]);
+    rb_require_equals(test, ref);
+
+    // Partial overlap
+    rb_pop_front(test, ref, 30);
+    test.add_overlap(frame, 40);
+    for (int k = 0; k < 10; ++k)
+        ref[k] += frame[k];
+    for (int k = 10; k < 40; ++k)
+        ref.push_back(frame[k]);
+    rb_require_equals(test, ref);
+
+    // Full overlap across the end of the allocation
+    rb_pop_front(test, ref, 35);
+    rb_push_back_rand(test, ref, 55);
+    REQUIRE(test.front_data_index() == 65);
+    test.add_overlap(frame, 40);
+    for (int k = 0; k < 40; ++k)
+        ref[k] += frame[k];
+    rb_require_equals(test, ref);
+
+    // Overlap-add of frames with a hop of 10, the sum of overlapping frames
+    test.clear();
+    ref.clear();
+    std::vector<float> out(10);
+    for (int f = 0; f < 10; ++f) {
+        test.add_overlap(frame, 40);
+        test.pop_front(out.data(), 10);
+        for (int k = 0; k < 10; ++k) {
+            float expected = 0.0f;
+            for (int j = 0; j <= std::min(f, 3); ++j)
+                expected += frame[k+10*j];
+            REQUIRE(std::abs(out[k] - expected) < 1e-6f);
+        }
+    }
+}
+
+TEST_CASE("ringbuffer_sample_format") {
+    test_t test;
+    ref_t ref;
+    rb_init(test, ref, 100);
+
+    std::vector<int16_t> in(60), out(60);
+    for (int k = 0; k < 60; ++k)
+        in[k] = static_cast<int16_t>(k*1000 - 30000);
+
+    // Nothing to push or pop
+    test.push_back(in.data(), 0);
+    REQUIRE(test.empty());
+    REQUIRE(test.pop_front(out.data(), 0) == 0);
+
+    // Contiguous
+    test.push_back(in.data(), 60);
+    for (int k = 0; k < 60; ++k)
+        ref.push_back(static_cast<float>(in[k])/32768.0f);
+    rb_require_equals(test, ref);
+    REQUIRE(test.pop_front(out.data(), 50) == 50);
+    for (int k = 0; k < 50; ++k)
+        REQUIRE(out[k] == in[k]);
+    ref.erase(ref.begin(), ref.begin()+50);
+
+    // Across the end of the allocation
+    test.push_back(in.data(), 60);
+    for (int k = 0; k < 60; ++k)
+        ref.push_back(static_cast<float>(in[k])/32768.0f);
+    REQUIRE(test.front_data_index() == 50);
+    rb_require_equals(test, ref);
+    REQUIRE(test.pop_front(out.data(), 60) == 60);
+    for (int k = 0; k < 10; ++k)
+        REQUIRE(out[k] == in[50+k]);
+    for (int k = 10; k < 60; ++k)
+        REQUIRE(out[k] == in[k-10]);
+    ref.erase(ref.begin(), ref.begin()+60);
+
+    // More than available
+    REQUIRE(test.pop_front(out.data(), 60) == 10);
+    for (int k = 0; k < 10; ++k)
+        REQUIRE(out[k] == in[50+k]);
+    REQUIRE(test.empty());
+
+    // Other formats
+    std::vector<int32_t> in32(30), out32(30);
+    for (int k = 0; k < 30; ++k)
+        in32[k] = (k - 15)*(1 << 24);
+    test.push_back(in32.data(), 30);
+    REQUIRE(test.pop_front(out32.data(), 30) == 30);
+    REQUIRE(out32 == in32);
+    std::vector<acbench::int24> in24(30), out24(30);
+    for (int k = 0; k < 30; ++k) {
+        in24[k].bytes[0] = static_cast<unsigned char>(k);
+        in24[k].bytes[1] = static_cast<unsigned char>(3*k);
+        in24[k].bytes[2] = static_cast<unsigned char>(255-k);
+    }
+    test.push_back(in24.data(), 30);
+    REQUIRE(test.pop_front(out24.data(), 30) == 30);
+    for (int k = 0; k < 30; ++k)
+        for (int b = 0; b < 3; ++b)
+            REQUIRE(out24[k].bytes[b] == in24[k].bytes[b]);
+}
+
+TEST_CASE("ringbuffer_move_swap") {
+    test_t test;
+    ref_t ref;
+    rb_init(test, ref, 100);
+    rb_pop_front(test, ref, 30);
+    rb_push_back_rand(test, ref, 50);  // Across the end of the allocation
+    const float* data = test.data();
+
+    // Move constructor, the allocation is taken over
+    test_t moved(std::move(test));
+    REQUIRE(moved.data() == data);
+    REQUIRE(moved.size_max() == 100);
+    rb_require_equals(moved, ref);
+    REQUIRE(test.data() == nullptr);
+    REQUIRE(test.size_max() == 0);
+    REQUIRE(test.empty());
+
+    // A moved-from ringbuffer can be allocated again
+    test.resize_allocation(64);
+    rb_push_back_rand_single(test, 10);
+    REQUIRE(test.is_size_max_pow2());
+
+    // Swap
+    const float* data2 = test.data();
+    ref_t ref2;
+    for (int n = 0; n < test.size(); ++n)
+        ref2.push_back(test[n]);
+    swap(test, moved);
+    REQUIRE(test.data() == data);
+    REQUIRE(moved.data() == data2);
+    REQUIRE(!test.is_size_max_pow2());
+    REQUIRE(moved.is_size_max_pow2());
+    rb_require_equals(test, ref);
+    rb_require_equals(moved, ref2);
+    test.swap(test);
+    rb_require_equals(test, ref);
+
+    // Move assignment, the previous allocation is released
+    moved = std::move(test);
+    REQUIRE(moved.data() == data);
+    rb_require_equals(moved, ref);
+    REQUIRE(test.data() == nullptr);
+    REQUIRE(test.empty());
+    test_t& self = moved;
+    moved = std::move(self);
+    rb_require_equals(moved, ref);
+
+    // The dynamic allocation flag follows the content
+    acbench::ringbuffer<float> dyn;
+    dyn.set_dynamic_allocation(true);
+    acbench::ringbuffer<float> dyn_moved;
+    dyn_moved = std::move(dyn);
+    REQUIRE(dyn_moved.dynamic_allocation());
+    REQUIRE(!dyn.dynamic_allocation());
+
+    // Storage in a std::vector, the values are never copied when it grows
+    std::vector<acbench::ringbuffer<float, acbench::lock_none>> rbs;
+    std::vector<const float*> datas;
+    for (int i = 0; i < 20; ++i) {
+        rbs.emplace_back();
+        rbs.back().resize_allocation(10);
+        rbs.back().push_back(static_cast<float>(i));
+        datas.push_back(rbs.back().data());
+    }
+    for (int i = 0; i < 20; ++i) {
+        REQUIRE(rbs[i].data() == datas[i]);
+        REQUIRE(rbs[i].front() == static_cast<float>(i));
+    }
+}
+
+TEST_CASE("ringbuffer_size_type") {
+    typedef acbench::ringbuffer<float, acbench::lock_none, acbench::allocator_new<float>, std::int64_t> test64_t;
+    REQUIRE(std::is_same<test64_t::size_type, std::int64_t>::value);
+    REQUIRE(std::is_same<test_t::size_type, int>::value);
+
+    // Same behavior as with int sizes
+    test64_t test;
+    ref_t ref;
+    test.resize_allocation(100);
+    for (int iter = 0; iter < 20; ++iter) {
+        std::vector<float> array(40);
+        for (auto& v : array) {
+            v = acbench::rand_uniform_continuous_01<float>();
+            ref.push_back(v);
+        }
+        test.push_back(array.data(), 40);
+        test.push_back(test, 10, 5);
+        for (int k = 0; k < 5; ++k)
+            ref.push_back(ref[10+k]);
+        REQUIRE(test.pop_front(array.data(), 40) == 40);
+        for (int k = 0; k < 40; ++k) {
+            REQUIRE(array[k] == ref.front());
+            ref.pop_front();
+        }
+        test.pop_front(5);
+        ref.erase(ref.begin(), ref.begin()+5);
+        REQUIRE(acbench::compare(ref, test));
+    }
+    std::int64_t n = 0;
+    for (float v : test)
+        REQUIRE(v == ref[n++]);
+    auto segs = test.segments();
+    REQUIRE(segs.first.size() + segs.second.size() == test.size());
+
+    // Beyond 2^31 values (only the touched pages are actually committed, the rest is never written)
+    if (sizeof(void*) == 8) {
+        typedef acbench::ringbuffer<char, acbench::lock_none, acbench::allocator_new<char>, std::int64_t> large_t;
+        large_t large;
+        const std::int64_t size_max = (std::int64_t(1) << 31) + 64;
+        bool allocated = true;
+        try {
+            large.resize_allocation(size_max);
+        } catch (const std::bad_alloc&) {  // GCOVR_EXCL_LINE
+            allocated = false;  // GCOVR_EXCL_LINE
+        }
+        if (allocated) {
+            large.write_commit(size_max - 10);
+            large.read_consume(size_max - 20);
+            REQUIRE(large.size() == 10);
+            REQUIRE(large.back_data_index() == size_max - 11);
+            char array[40];
+            for (int k = 0; k < 40; ++k)
+                array[k] = static_cast<char>(k);
+            large.push_back(array, 40);  // Across the end of the allocation
+            REQUIRE(large.size() == 50);
+            REQUIRE(large.back_data_index() == 29);
+            REQUIRE(large[10+35] == 35);
+            large.pop_front(10);
+            char out[40];
+            REQUIRE(large.pop_front(out, 40) == 40);
+            for (int k = 0; k < 40; ++k)
+                REQUIRE(out[k] == static_cast<char>(k));
+        }
+    }
+}
+
+TEST_CASE("ringbuffer_stream") {
+    test_t test;
+    ref_t ref;
+    rb_init(test, ref, 1000);
+    REQUIRE(test.stream_threshold() == 0);
+    test.set_stream_threshold(16);
+    REQUIRE(test.stream_threshold() == 16);
+
+    // Chunks below and above the threshold, at any alignment, across the end of the allocation
+    std::vector<float> chunk(300);
+    for (int iter = 0; iter < 20; ++iter) {
+        for (int chunk_size : {1, 15, 16, 17, 63, 64, 65, 257}) {
+            for (int n = 0; n < chunk_size; ++n)
+                chunk[n] = acbench::rand_uniform_continuous_01<float>();
+            test.push_back(chunk.data(), chunk_size);
+            ref.insert(ref.end(), chunk.begin(), chunk.begin()+chunk_size);
+        }
+        rb_pop_front(test, ref, 490);
+        rb_require_equals(test, ref);
+    }
+
+    // Blocks of a size known at compile time, below and above the threshold
+    for (int iter = 0; iter < 20; ++iter) {
+        for (int n = 0; n < 64; ++n)
+            chunk[n] = acbench::rand_uniform_continuous_01<float>();
+        test.push_back<8>(chunk.data());
+        test.push_back<64>(chunk.data());
+        ref.insert(ref.end(), chunk.begin(), chunk.begin()+8);
+        ref.insert(ref.end(), chunk.begin(), chunk.begin()+64);
+        rb_pop_front(test, ref, 72);
+        rb_require_equals(test, ref);
+    }
+
+    // The threshold follows the content
+    test_t moved;
+    moved = std::move(test);
+    REQUIRE(moved.stream_threshold() == 16);
+    REQUIRE(test.stream_threshold() == 0);
+}
+
+TEST_CASE("ringbuffer_block_size") {
+    test_t test;
+    ref_t ref;
+    rb_init(test, ref, 1000);
+
+    // Blocks of a size known at compile time, across the end of the allocation
+    std::vector<float> block(64);
+    for (int iter = 0; iter < 50; ++iter) {
+        for (int n = 0; n < 64; ++n)
+            block[n] = acbench::rand_uniform_continuous_01<float>();
+        test.push_back<64>(block.data());
+        ref.insert(ref.end(), block.begin(), block.end());
+        test.push_back<32>(block.data());
+        ref.insert(ref.end(), block.begin(), block.begin()+32);
+        rb_require_equals(test, ref);
+
+        REQUIRE(test.pop_front<64>(block.data()) == 64);
+        for (int n = 0; n < 64; ++n)
+            REQUIRE(block[n] == ref[n]);
+        ref.erase(ref.begin(), ref.begin()+64);
+        rb_pop_front(test, ref, 28);
+        rb_require_equals(test, ref);
+    }
+
+    // Less values than the block size
+    rb_pop_front(test, ref, test.size()-10);
+    REQUIRE(test.pop_front<32>(block.data()) == 10);
+    REQUIRE(test.empty());
+    ref.clear();
+
+    // Until the end of the allocation exactly
+    test.resize_allocation(64);
+    test.push_back<64>(block.data());
+    REQUIRE(test.size() == 64);
+    REQUIRE(test.pop_front<64>(block.data()) == 64);
+    REQUIRE(test.empty());
+}
@@ -0,0 +1,183 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#ifndef ACBENCH_SAMPLE_FORMAT_H_
+#define ACBENCH_SAMPLE_FORMAT_H_
+
+/**
+
+Conversions between the PCM sample formats of audio devices and float, as used by the converting
+push_back(.) and pop_front(.) of acbench::ringbuffer.
+
+    convert_samples(float* out, const S* in, int size)     S to float, in [-1, 1)
+    convert_samples(S* out, const float* in, int size)     float to S, rounded to nearest and clipped
+    with S among:
+        int16_t             scaled by 2^15
+        acbench::int24      packed 24 bits little-endian (3 bytes), scaled by 2^23
+        int32_t             scaled by 2^31
+
+    The int16_t and int32_t conversions are vectorized with SSE2 (also when AVX is enabled, as the integer part
+    of AVX needs AVX2) or NEON (see acbench/simd.h). For int24, only the rounding of float to int24 is vectorized (SSE2),
+    the packing and unpacking of the 3 bytes are scalar.
+
+**/
+
+#include <acbench/simd.h>
+
+#include <cmath>    // For std::lrint(.)
+#include <cstdint>  // For int16_t and int32_t
+
+
+namespace acbench {
+
+    //! Packed 24 bits signed sample, little-endian
+    struct int24 {
+        unsigned char bytes[3];
+    };
+    static_assert(sizeof(int24) == 3, "int24 must be packed");
+
+namespace detail {
+
+    // Largest floats that convert to the integer types without overflow
+    static const float float_max_int16 = 32767.0f;
+    static const float float_max_int24 = 8388607.0f;
+    static const float float_max_int32 = 2147483520.0f;  // 2^31-128, the largest float below 2^31
+
+    inline float clip(float v, float min, float max) {
+        return v < min ? min : (v > max ? max : v);
+    }
+
+}  // namespace detail
+
+    // int16_t ------------------------------------------------------------
+
+    inline void convert_samples(float* out, const int16_t* in, int size) {
+        const float scale = 1.0f/32768.0f;
+        int k = 0;
+        #if defined(ACBENCH_SIMD_AVX) || defined(ACBENCH_SIMD_SSE)
+        const __m128 vscale = _mm_set1_ps(scale);
+        for (; k+8 <= size; k += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in+k));
+            // Sign extension to 32 bits: the values in the upper halves, then an arithmetic shift
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(out+k, _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+            _mm_storeu_ps(out+k+4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+        }
+        #elif defined(ACBENCH_SIMD_NEON)
+        const float32x4_t vscale = vdupq_n_f32(scale);
+        for (; k+8 <= size; k += 8) {
+            int16x8_t v = vld1q_s16(in+k);
+            vst1q_f32(out+k, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), vscale));
+            vst1q_f32(out+k+4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), vscale));
+        }
+        #endif
+        for (; k < size; ++k)
+            out[k] = static_cast<float>(in[k])*scale;
+    }
+    inline void convert_samples(int16_t* out, const float* in, int size) {
+        const float scale = 32768.0f;
+        int k = 0;
+        #if defined(ACBENCH_SIMD_AVX) || defined(ACBENCH_SIMD_SSE)
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128 vmin = _mm_set1_ps(-scale);
+        const __m128 vmax = _mm_set1_ps(detail::float_max_int16);
+        for (; k+8 <= size; k += 8) {
+            // Rounded to nearest (the default rounding mode), as std::lrint(.)
+            __m128i lo = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in+k), vscale), vmin), vmax));
+            __m128i hi = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in+k+4), vscale), vmin), vmax));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out+k), _mm_packs_epi32(lo, hi));
+        }
+        #elif defined(ACBENCH_SIMD_NEON) && defined(__aarch64__)
+        const float32x4_t vscale = vdupq_n_f32(scale);
+        for (; k+8 <= size; k += 8) {
+            // Rounded to nearest, and saturated by the narrowing
+            int32x4_t lo = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(in+k), vscale));
+            int32x4_t hi = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(in+k+4), vscale));
+            vst1q_s16(out+k, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+        }
+        #endif
+        for (; k < size; ++k)
+            out[k] = static_cast<int16_t>(std::lrint(detail::clip(in[k]*scale, -scale, detail::float_max_int16)));
+    }
+
+    // int24 --------------------------------------------------------------
+
+    inline void convert_samples(float* out, const int24* in, int size) {
+        const float scale = 1.0f/8388608.0f;
+        for (int k = 0; k < size; ++k) {
+            // The 24 bits in the upper part of a 32 bits integer, then an arithmetic shift for the sign extension
+            uint32_t u = (static_cast<uint32_t>(in[k].bytes[0]) << 8) | (static_cast<uint32_t>(in[k].bytes[1]) << 16) | (static_cast<uint32_t>(in[k].bytes[2]) << 24);
+            out[k] = static_cast<float>(static_cast<int32_t>(u) >> 8)*scale;
+        }
+    }
+    inline void convert_samples(int24* out, const float* in, int size) {
+        const float scale = 8388608.0f;
+        int k = 0;
+        #if defined(ACBENCH_SIMD_AVX) || defined(ACBENCH_SIMD_SSE)
+        // The rounding and clipping are vectorized, only the packing into 3 bytes is scalar
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128 vmin = _mm_set1_ps(-scale);
+        const __m128 vmax = _mm_set1_ps(detail::float_max_int24);
+        alignas(16) int32_t values[4];
+        for (; k+4 <= size; k += 4) {
+            _mm_store_si128(reinterpret_cast<__m128i*>(values), _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in+k), vscale), vmin), vmax)));
+            for (int i = 0; i < 4; ++i) {
+                uint32_t u = static_cast<uint32_t>(values[i]);
+                out[k+i].bytes[0] = static_cast<unsigned char>(u);
+                out[k+i].bytes[1] = static_cast<unsigned char>(u >> 8);
+                out[k+i].bytes[2] = static_cast<unsigned char>(u >> 16);
+            }
+        }
+        #endif
+        for (; k < size; ++k) {
+            uint32_t u = static_cast<uint32_t>(std::lrint(detail::clip(in[k]*scale, -scale, detail::float_max_int24)));
+            out[k].bytes[0] = static_cast<unsigned char>(u);
+            out[k].bytes[1] = static_cast<unsigned char>(u >> 8);
+            out[k].bytes[2] = static_cast<unsigned char>(u >> 16);
+        }
+    }
+
+    // int32_t ------------------------------------------------------------
+
+    inline void convert_samples(float* out, const int32_t* in, int size) {
+        const float scale = 1.0f/2147483648.0f;
+        int k = 0;
+        #if defined(ACBENCH_SIMD_AVX) || defined(ACBENCH_SIMD_SSE)
+        const __m128 vscale = _mm_set1_ps(scale);
+        for (; k+4 <= size; k += 4)
+            _mm_storeu_ps(out+k, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in+k))), vscale));
+        #elif defined(ACBENCH_SIMD_NEON)
+        const float32x4_t vscale = vdupq_n_f32(scale);
+        for (; k+4 <= size; k += 4)
+            vst1q_f32(out+k, vmulq_f32(vcvtq_f32_s32(vld1q_s32(in+k)), vscale));
+        #endif
+        for (; k < size; ++k)
+            out[k] = static_cast<float>(in[k])*scale;
+    }
+    inline void convert_samples(int32_t* out, const float* in, int size) {
+        const float scale = 2147483648.0f;
+        int k = 0;
+        #if defined(ACBENCH_SIMD_AVX) || defined(ACBENCH_SIMD_SSE)
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128 vmin = _mm_set1_ps(-scale);
+        const __m128 vmax = _mm_set1_ps(detail::float_max_int32);
+        for (; k+4 <= size; k += 4)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out+k), _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in+k), vscale), vmin), vmax)));
+        #elif defined(ACBENCH_SIMD_NEON) && defined(__aarch64__)
+        const float32x4_t vscale = vdupq_n_f32(scale);
+        for (; k+4 <= size; k += 4)
+            vst1q_s32(out+k, vcvtnq_s32_f32(vmulq_f32(vld1q_f32(in+k), vscale)));  // Saturated
+        #endif
+        for (; k < size; ++k)
+            out[k] = static_cast<int32_t>(std::lrint(detail::clip(in[k]*scale, -scale, detail::float_max_int32)));
+    }
+
+}  // namespace acbench
+
+#endif  // ACBENCH_SAMPLE_FORMAT_H_
@@ -0,0 +1,107 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#include <acbench/sample_format.h>
+
+#include "utils.h"
+
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+static int32_t int24_value(const acbench::int24& v) {
+    int32_t value = v.bytes[0] | (v.bytes[1] << 8) | (v.bytes[2] << 16);
+    return value >= (1 << 23) ? value - (1 << 24) : value;
+}
+
+// Sizes around the vector sizes and unaligned pointers, so that both the vectorized and the scalar parts are checked.
+TEST_CASE("sample_format_int16") {
+    for (int size = 0; size < 20; ++size) {
+        for (int offset = 0; offset < 3; ++offset) {
+            std::vector<int16_t> in(size+offset), back(size+offset);
+            std::vector<float> x(size+offset);
+            for (int k = 0; k < size+offset; ++k)
+                in[k] = static_cast<int16_t>(static_cast<int>(65536*acbench::rand_uniform_continuous_01<float>()) - 32768);
+            if (size > 0)
+                in[offset] = -32768;
+
+            acbench::convert_samples(x.data()+offset, in.data()+offset, size);
+            for (int k = 0; k < size; ++k)
+                REQUIRE(x[offset+k] == static_cast<float>(in[offset+k])/32768.0f);
+
+            // Exact round-trip
+            acbench::convert_samples(back.data()+offset, x.data()+offset, size);
+            for (int k = 0; k < size; ++k)
+                REQUIRE(back[offset+k] == in[offset+k]);
+        }
+    }
+
+    // Rounding to nearest and clipping
+    std::vector<float> x = {0.4f/32768, 0.6f/32768, -0.6f/32768, 1.0f, 2.0f, -1.0f, -2.0f, 0.5f, 0.4f/32768, 0.6f/32768};
+    std::vector<int16_t> expected = {0, 1, -1, 32767, 32767, -32768, -32768, 16384, 0, 1};
+    std::vector<int16_t> out(x.size());
+    acbench::convert_samples(out.data(), x.data(), static_cast<int>(x.size()));
+    REQUIRE(out == expected);
+}
+
+TEST_CASE("sample_format_int24") {
+    for (int size = 0; size < 20; ++size) {
+        std::vector<acbench::int24> in(size), back(size);
+        std::vector<float> x(size);
+        for (int k = 0; k < size; ++k) {
+            int32_t value = static_cast<int32_t>(16777216*acbench::rand_uniform_continuous_01<double>()) - 8388608;
+            in[k].bytes[0] = static_cast<unsigned char>(value);
+            in[k].bytes[1] = static_cast<unsigned char>(value >> 8);
+            in[k].bytes[2] = static_cast<unsigned char>(value >> 16);
+        }
+
+        acbench::convert_samples(x.data(), in.data(), size);
+        for (int k = 0; k < size; ++k)
+            REQUIRE(x[k] == static_cast<float>(int24_value(in[k]))/8388608.0f);
+
+        acbench::convert_samples(back.data(), x.data(), size);
+        for (int k = 0; k < size; ++k)
+            REQUIRE(int24_value(back[k]) == int24_value(in[k]));
+    }
+
+    std::vector<float> x = {-1.0f/8388608, 1.0f, 2.0f, -1.0f, -2.0f, 0.5f};
+    std::vector<int32_t> expected = {-1, 8388607, 8388607, -8388608, -8388608, 4194304};
+    std::vector<acbench::int24> out(x.size());
+    acbench::convert_samples(out.data(), x.data(), static_cast<int>(x.size()));
+    for (size_t k = 0; k < x.size(); ++k)
+        REQUIRE(int24_value(out[k]) == expected[k]);
+}
+
+TEST_CASE("sample_format_int32") {
+    for (int size = 0; size < 20; ++size) {
+        for (int offset = 0; offset < 3; ++offset) {
+            std::vector<int32_t> in(size+offset), back(size+offset);
+            std::vector<float> x(size+offset);
+            for (int k = 0; k < size+offset; ++k)
+                in[k] = static_cast<int32_t>(65536*acbench::rand_uniform_continuous_01<float>() - 32768) * 256;  // 24 significant bits, exactly representable in float
+
+            acbench::convert_samples(x.data()+offset, in.data()+offset, size);
+            for (int k = 0; k < size; ++k)
+                REQUIRE(x[offset+k] == static_cast<float>(in[offset+k])/2147483648.0f);
+
+            acbench::convert_samples(back.data()+offset, x.data()+offset, size);
+            for (int k = 0; k < size; ++k)
+                REQUIRE(back[offset+k] == in[offset+k]);
+        }
+    }
+
+    std::vector<float> x = {1.0f, 2.0f, -1.0f, -2.0f, 0.5f};
+    std::vector<int32_t> out(x.size());
+    acbench::convert_samples(out.data(), x.data(), static_cast<int>(x.size()));
+    REQUIRE(out[0] >= 2147483520);  // Saturated at the largest float below 2^31 or at INT32_MAX, depending on the instruction set
+    REQUIRE(out[1] >= 2147483520);
+    REQUIRE(out[2] == -2147483647-1);
+    REQUIRE(out[3] == -2147483647-1);
+    REQUIRE(out[4] == 1073741824);
+}
@@ -0,0 +1,438 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#ifndef ACBENCH_SIMD_H_
+#define ACBENCH_SIMD_H_
+
+/**
+
+Vectorized kernels on contiguous arrays, as used by acbench/ringbuffer_math.h on the segments of ringbuffers.
+
+    The float overloads use the widest instruction set enabled at compile time:
+        AVX   (ex. -mavx or /arch:AVX)
+        SSE   (always available on x86-64)
+        NEON  (always available on arm64)
+    and a scalar loop otherwise, as do the generic versions for any other type.
+    Define ACBENCH_NO_SIMD before including this file to force the scalar loops.
+
+    The reductions (sum, sum_squares) of the vectorized versions add the values in a different order
+    than the scalar ones, so the results can differ by a few ULPs.
+
+    copy(.) is std::memcpy with inlined kernels for the small sizes (up to 64 bytes), where the call of std::memcpy
+    costs more than the copy itself.
+    copy_stream(.) copies with non-temporal stores (SSE2, also under AVX), which bypass the caches.
+    It is the same as std::memcpy on the other instruction sets.
+
+**/
+
+#include <cassert>  // For assert(.)
+#include <cmath>    // For std::abs(.)
+#include <cstddef>  // For std::size_t
+#include <cstdint>  // For std::uintptr_t and std::uint64_t
+#include <cstring>  // For std::memcpy(.)
+
+#if !defined(ACBENCH_NO_SIMD)
+    #if defined(__AVX__)
+        #include <immintrin.h>
+        #define ACBENCH_SIMD_AVX
+    #elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #include <emmintrin.h>
+        #define ACBENCH_SIMD_SSE
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #include <arm_neon.h>
+        #define ACBENCH_SIMD_NEON
+    #endif
+#endif
+
+#if defined(ACBENCH_SIMD_AVX) || defined(ACBENCH_SIMD_SSE) || defined(ACBENCH_SIMD_NEON)
+    #define ACBENCH_SIMD
+#endif
+
+
+namespace acbench {
+namespace simd {
+
+    //! Name of the instruction set used by the float kernels
+    inline const char* instruction_set() {
+        #if defined(ACBENCH_SIMD_AVX)
+            return "avx";
+        #elif defined(ACBENCH_SIMD_SSE)
+            return "sse";
+        #elif defined(ACBENCH_SIMD_NEON)
+            return "neon";
+        #else
+            return "scalar";
+        #endif
+    }
+
+    // Vector of floats ---------------------------------------------------
+
+    #if defined(ACBENCH_SIMD_AVX)
+
+    typedef __m256 vfloat;
+    static const int vfloat_size = 8;
+    inline vfloat vload(const float* p) { return _mm256_loadu_ps(p); }
+    inline void vstore(float* p, vfloat v) { _mm256_storeu_ps(p, v); }
+    inline vfloat vset1(float v) { return _mm256_set1_ps(v); }
+    inline vfloat vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+    inline vfloat vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+    inline vfloat vmax(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+    inline vfloat vabs(vfloat v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+
+    #elif defined(ACBENCH_SIMD_SSE)
+
+    typedef __m128 vfloat;
+    static const int vfloat_size = 4;
+    inline vfloat vload(const float* p) { return _mm_loadu_ps(p); }
+    inline void vstore(float* p, vfloat v) { _mm_storeu_ps(p, v); }
+    inline vfloat vset1(float v) { return _mm_set1_ps(v); }
+    inline vfloat vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+    inline vfloat vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+    inline vfloat vmax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+    inline vfloat vabs(vfloat v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+
+    #elif defined(ACBENCH_SIMD_NEON)
+
+    typedef float32x4_t vfloat;
+    static const int vfloat_size = 4;
+    inline vfloat vload(const float* p) { return vld1q_f32(p); }
+    inline void vstore(float* p, vfloat v) { vst1q_f32(p, v); }
+    inline vfloat vset1(float v) { return vdupq_n_f32(v); }
+    inline vfloat vadd(vfloat a, vfloat b) { return vaddq_f32(a, b); }
+    inline vfloat vmul(vfloat a, vfloat b) { return vmulq_f32(a, b); }
+    inline vfloat vmax(vfloat a, vfloat b) { return vmaxq_f32(a, b); }
+    inline vfloat vabs(vfloat v) { return vabsq_f32(v); }
+
+    #endif
+
+    #if defined(ACBENCH_SIMD)
+    inline float vhsum(vfloat v) {
+        float values[vfloat_size];
+        vstore(values, v);
+        float sum = 0.0f;
+        for (int k = 0; k < vfloat_size; ++k)
+            sum += values[k];
+        return sum;
+    }
+    inline float vhmax(vfloat v) {
+        float values[vfloat_size];
+        vstore(values, v);
+        float val = values[0];
+        for (int k = 1; k < vfloat_size; ++k)
+            val = values[k] > val ? values[k] : val;
+        return val;
+    }
+    #endif
+
+
+    // Copies -------------------------------------------------------------
+
+namespace detail {
+    // Copies the first and the last sizeof(W) bytes, which covers any nb_bytes in [sizeof(W), 2*sizeof(W)]
+    template<typename W>
+    inline void copy_overlap(char* pdst, const char* psrc, std::size_t nb_bytes) {
+        W first, last;
+        std::memcpy(&first, psrc, sizeof(W));
+        std::memcpy(&last, psrc+nb_bytes-sizeof(W), sizeof(W));
+        std::memcpy(pdst, &first, sizeof(W));
+        std::memcpy(pdst+nb_bytes-sizeof(W), &last, sizeof(W));
+    }
+    // Copies up to 16 bytes with two overlapping scalar copies
+    inline void copy_scalar(char* pdst, const char* psrc, std::size_t nb_bytes) {
+        if (nb_bytes >= 8)
+            copy_overlap<std::uint64_t>(pdst, psrc, nb_bytes);
+        else if (nb_bytes >= 4)
+            copy_overlap<std::uint32_t>(pdst, psrc, nb_bytes);
+        else if (nb_bytes >= 2)
+            copy_overlap<std::uint16_t>(pdst, psrc, nb_bytes);
+        else if (nb_bytes == 1)
+            *pdst = *psrc;
+    }
+}  // namespace detail
+
+    //! Same as std::memcpy(dst, src, nb_bytes) for nb_bytes <= copy_small_max, with inlined kernels
+    //  (dispatched on nb_bytes):
+    //      up to 16 bytes      Two overlapping scalar copies (of 1, 2, 4 or 8 bytes).
+    //      up to 64 bytes      Two or four overlapping 16 bytes vectors (SSE2 or NEON).
+    static const std::size_t copy_small_max = 64;
+    inline void copy_small(void* dst, const void* src, std::size_t nb_bytes) {
+        assert(nb_bytes <= copy_small_max);
+        char* pdst = reinterpret_cast<char*>(dst);
+        const char* psrc = reinterpret_cast<const char*>(src);
+        if (nb_bytes <= 16) {
+            detail::copy_scalar(pdst, psrc, nb_bytes);
+            return;
+        }
+        #if defined(ACBENCH_SIMD_AVX) || defined(ACBENCH_SIMD_SSE)
+            // The first and the last 16 bytes (and the 16 bytes after and before them above 32 bytes), all loaded before storing
+            __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(psrc));
+            __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(psrc+nb_bytes-16));
+            if (nb_bytes > 32) {
+                __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(psrc+16));
+                __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(psrc+nb_bytes-32));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pdst+16), v1);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pdst+nb_bytes-32), v2);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pdst), v0);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pdst+nb_bytes-16), v3);
+        #elif defined(ACBENCH_SIMD_NEON)
+            uint8x16_t v0 = vld1q_u8(reinterpret_cast<const uint8_t*>(psrc));
+            uint8x16_t v3 = vld1q_u8(reinterpret_cast<const uint8_t*>(psrc+nb_bytes-16));
+            if (nb_bytes > 32) {
+                uint8x16_t v1 = vld1q_u8(reinterpret_cast<const uint8_t*>(psrc+16));
+                uint8x16_t v2 = vld1q_u8(reinterpret_cast<const uint8_t*>(psrc+nb_bytes-32));
+                vst1q_u8(reinterpret_cast<uint8_t*>(pdst+16), v1);
+                vst1q_u8(reinterpret_cast<uint8_t*>(pdst+nb_bytes-32), v2);
+            }
+            vst1q_u8(reinterpret_cast<uint8_t*>(pdst), v0);
+            vst1q_u8(reinterpret_cast<uint8_t*>(pdst+nb_bytes-16), v3);
+        #else
+            std::memcpy(dst, src, nb_bytes);
+        #endif
+    }
+
+    //! Same as std::memcpy(dst, src, nb_bytes), with copy_small(.) if nb_bytes_max <= copy_small_max, and std::memcpy
+    //  otherwise, whose wider vectors and alignment handling are faster from there.
+    //  nb_bytes_max is a bound of nb_bytes known by the caller, ex. the size of the whole chunk when copying one of its
+    //  segments. The kernel being selected on this bound, a copy into or from a small object never reaches the kernels
+    //  of the larger sizes (which the compiler might otherwise see as out of bounds accesses).
+    //  When the bound is known at compile time, the dispatch is resolved at compile time too.
+    inline void copy(void* dst, const void* src, std::size_t nb_bytes, std::size_t nb_bytes_max) {
+        assert(nb_bytes <= nb_bytes_max);
+        if (nb_bytes_max <= 16)
+            detail::copy_scalar(reinterpret_cast<char*>(dst), reinterpret_cast<const char*>(src), nb_bytes);
+        else if (nb_bytes_max <= copy_small_max)
+            copy_small(dst, src, nb_bytes);
+        else
+            std::memcpy(dst, src, nb_bytes);
+    }
+    inline void copy(void* dst, const void* src, std::size_t nb_bytes) {
+        copy(dst, src, nb_bytes, nb_bytes);
+    }
+
+    //! Same as std::memcpy(dst, src, nb_bytes), but with non-temporal stores, which don't keep the destination in the caches.
+    //  For large copies whose destination won't be read soon (ex. pushes into a large ringbuffer, popped much later),
+    //  so that they don't evict the working set of the running threads.
+    //  Ends with a store fence, so that the copied bytes are visible to the other threads before anything written after
+    //  (ex. the end index of a ringbuffer), the non-temporal stores being weakly ordered.
+    inline void copy_stream(void* dst, const void* src, std::size_t nb_bytes) {
+        #if defined(ACBENCH_SIMD_AVX) || defined(ACBENCH_SIMD_SSE)
+        char* pdst = reinterpret_cast<char*>(dst);
+        const char* psrc = reinterpret_cast<const char*>(src);
+        // Up to the first 16 bytes boundary of dst, as the non-temporal stores need aligned addresses
+        std::size_t head = (16 - (reinterpret_cast<std::uintptr_t>(pdst) & 15)) & 15;
+        if (head > nb_bytes)
+            head = nb_bytes;
+        std::memcpy(pdst, psrc, head);
+        pdst += head;
+        psrc += head;
+        nb_bytes -= head;
+        // A cache line per iteration
+        for (; nb_bytes >= 64; nb_bytes -= 64, pdst += 64, psrc += 64) {
+            __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(psrc));
+            __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(psrc+16));
+            __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(psrc+32));
+            __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(psrc+48));
+            _mm_stream_si128(reinterpret_cast<__m128i*>(pdst), v0);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(pdst+16), v1);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(pdst+32), v2);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(pdst+48), v3);
+        }
+        for (; nb_bytes >= 16; nb_bytes -= 16, pdst += 16, psrc += 16)
+            _mm_stream_si128(reinterpret_cast<__m128i*>(pdst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(psrc)));
+        std::memcpy(pdst, psrc, nb_bytes);
+        _mm_sfence();
+        #else
+        std::memcpy(dst, src, nb_bytes);
+        #endif
+    }
+
+
+    // Generic kernels ----------------------------------------------------
+
+    //! p[k] *= gain
+    template<typename T>
+    inline void scale(T* p, int size, T gain) {
+        for (int k = 0; k < size; ++k)
+            p[k] *= gain;
+    }
+    //! out[k] = gain*array[k]
+    template<typename T>
+    inline void copy_scale(T* out, const T* array, T gain, int size) {
+        for (int k = 0; k < size; ++k)
+            out[k] = gain*array[k];
+    }
+    //! p[k] += array[k]
+    template<typename T>
+    inline void add(T* p, const T* array, int size) {
+        for (int k = 0; k < size; ++k)
+            p[k] += array[k];
+    }
+    //! p[k] *= array[k]
+    template<typename T>
+    inline void multiply(T* p, const T* array, int size) {
+        for (int k = 0; k < size; ++k)
+            p[k] *= array[k];
+    }
+    //! p[k] += gain*array[k]
+    template<typename T>
+    inline void multiply_accumulate(T* p, const T* array, T gain, int size) {
+        for (int k = 0; k < size; ++k)
+            p[k] += gain*array[k];
+    }
+    //! p[k] *= gain + k*step
+    template<typename T>
+    inline void gain_ramp(T* p, int size, T gain, T step) {
+        for (int k = 0; k < size; ++k)
+            p[k] *= gain + static_cast<T>(k)*step;
+    }
+    template<typename T>
+    inline T sum(const T* p, int size) {
+        T acc = T(0);
+        for (int k = 0; k < size; ++k)
+            acc += p[k];
+        return acc;
+    }
+    template<typename T>
+    inline T sum_squares(const T* p, int size) {
+        T acc = T(0);
+        for (int k = 0; k < size; ++k)
+            acc += p[k]*p[k];
+        return acc;
+    }
+    //! Maximum absolute value (0 if size is 0)
+    template<typename T>
+    inline T peak(const T* p, int size) {
+        T val = T(0);
+        for (int k = 0; k < size; ++k) {
+            T a = std::abs(p[k]);
+            if (a > val)
+                val = a;
+        }
+        return val;
+    }
+
+
+    // Float kernels ------------------------------------------------------
+    // Same as the generic ones, the vector loops run over most of the array and the scalar loops over the remainder.
+
+    inline void scale(float* p, int size, float gain) {
+        int k = 0;
+        #if defined(ACBENCH_SIMD)
+        vfloat vgain = vset1(gain);
+        for (; k+vfloat_size <= size; k += vfloat_size)
+            vstore(p+k, vmul(vload(p+k), vgain));
+        #endif
+        for (; k < size; ++k)
+            p[k] *= gain;
+    }
+    inline void copy_scale(float* out, const float* array, float gain, int size) {
+        int k = 0;
+        #if defined(ACBENCH_SIMD)
+        vfloat vgain = vset1(gain);
+        for (; k+vfloat_size <= size; k += vfloat_size)
+            vstore(out+k, vmul(vgain, vload(array+k)));
+        #endif
+        for (; k < size; ++k)
+            out[k] = gain*array[k];
+    }
+    inline void add(float* p, const float* array, int size) {
+        int k = 0;
+        #if defined(ACBENCH_SIMD)
+        for (; k+vfloat_size <= size; k += vfloat_size)
+            vstore(p+k, vadd(vload(p+k), vload(array+k)));
+        #endif
+        for (; k < size; ++k)
+            p[k] += array[k];
+    }
+    inline void multiply(float* p, const float* array, int size) {
+        int k = 0;
+        #if defined(ACBENCH_SIMD)
+        for (; k+vfloat_size <= size; k += vfloat_size)
+            vstore(p+k, vmul(vload(p+k), vload(array+k)));
+        #endif
+        for (; k < size; ++k)
+            p[k] *= array[k];
+    }
+    inline void multiply_accumulate(float* p, const float* array, float gain, int size) {
+        int k = 0;
+        #if defined(ACBENCH_SIMD)
+        vfloat vgain = vset1(gain);
+        for (; k+vfloat_size <= size; k += vfloat_size)
+            vstore(p+k, vadd(vload(p+k), vmul(vgain, vload(array+k))));
+        #endif
+        for (; k < size; ++k)
+            p[k] += gain*array[k];
+    }
+    inline void gain_ramp(float* p, int size, float gain, float step) {
+        int k = 0;
+        #if defined(ACBENCH_SIMD)
+        if (size >= vfloat_size) {
+            float gains[vfloat_size];
+            for (int i = 0; i < vfloat_size; ++i)
+                gains[i] = gain + static_cast<float>(i)*step;
+            vfloat vgains = vload(gains);
+            vfloat vinc = vset1(static_cast<float>(vfloat_size)*step);
+            for (; k+vfloat_size <= size; k += vfloat_size) {
+                vstore(p+k, vmul(vload(p+k), vgains));
+                vgains = vadd(vgains, vinc);
+            }
+        }
+        #endif
+        for (; k < size; ++k)
+            p[k] *= gain + static_cast<float>(k)*step;
+    }
+    inline float sum(const float* p, int size) {
+        int k = 0;
+        float acc = 0.0f;
+        #if defined(ACBENCH_SIMD)
+        vfloat vacc = vset1(0.0f);
+        for (; k+vfloat_size <= size; k += vfloat_size)
+            vacc = vadd(vacc, vload(p+k));
+        acc = vhsum(vacc);
+        #endif
+        for (; k < size; ++k)
+            acc += p[k];
+        return acc;
+    }
+    inline float sum_squares(const float* p, int size) {
+        int k = 0;
+        float acc = 0.0f;
+        #if defined(ACBENCH_SIMD)
+        vfloat vacc = vset1(0.0f);
+        for (; k+vfloat_size <= size; k += vfloat_size) {
+            vfloat v = vload(p+k);
+            vacc = vadd(vacc, vmul(v, v));
+        }
+        acc = vhsum(vacc);
+        #endif
+        for (; k < size; ++k)
+            acc += p[k]*p[k];
+        return acc;
+    }
+    inline float peak(const float* p, int size) {
+        int k = 0;
+        float val = 0.0f;
+        #if defined(ACBENCH_SIMD)
+        vfloat vval = vset1(0.0f);
+        for (; k+vfloat_size <= size; k += vfloat_size)
+            vval = vmax(vval, vabs(vload(p+k)));
+        val = vhmax(vval);
+        #endif
+        for (; k < size; ++k) {
+            float a = std::abs(p[k]);
+            if (a > val)
+                val = a;
+        }
+        return val;
+    }
+
+}  // namespace simd
+}  // namespace acbench
+
+#endif  // ACBENCH_SIMD_H_
@@ -0,0 +1,113 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#include <acbench/simd.h>
+
+#include "utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+// The float kernels against the generic ones in double precision, for sizes around the vector sizes and unaligned pointers.
+TEST_CASE("simd_kernels") {
+    std::string instruction_set = acbench::simd::instruction_set();
+    REQUIRE(!instruction_set.empty());
+
+    for (int size = 0; size < 40; ++size) {
+        for (int offset = 0; offset < 3; ++offset) {
+            std::vector<float> x(size+offset), a(size+offset);
+            std::vector<double> xd(size), ad(size);
+            for (int k = 0; k < size+offset; ++k) {
+                x[k] = 2.0f*acbench::rand_uniform_continuous_01<float>() - 1.0f;
+                a[k] = 2.0f*acbench::rand_uniform_continuous_01<float>() - 1.0f;
+            }
+            float* px = x.data() + offset;
+            const float* pa = a.data() + offset;
+            for (int k = 0; k < size; ++k) {
+                xd[k] = px[k];
+                ad[k] = pa[k];
+            }
+
+            // Reductions
+            REQUIRE(std::abs(acbench::simd::sum(px, size) - acbench::simd::sum(xd.data(), size)) < 1e-5);
+            REQUIRE(std::abs(acbench::simd::sum_squares(px, size) - acbench::simd::sum_squares(xd.data(), size)) < 1e-5);
+            REQUIRE(acbench::simd::peak(px, size) == static_cast<float>(acbench::simd::peak(xd.data(), size)));
+
+            // In-place operations
+            acbench::simd::scale(px, size, 0.5f);
+            acbench::simd::scale(xd.data(), size, 0.5);
+            acbench::simd::add(px, pa, size);
+            acbench::simd::add(xd.data(), ad.data(), size);
+            acbench::simd::multiply(px, pa, size);
+            acbench::simd::multiply(xd.data(), ad.data(), size);
+            acbench::simd::multiply_accumulate(px, pa, 0.25f, size);
+            acbench::simd::multiply_accumulate(xd.data(), ad.data(), 0.25, size);
+            acbench::simd::gain_ramp(px, size, 1.0f, -0.01f);
+            acbench::simd::gain_ramp(xd.data(), size, 1.0, -0.01);
+            for (int k = 0; k < size; ++k)
+                REQUIRE(std::abs(px[k] - xd[k]) < 1e-6);
+
+            // Out-of-place operations
+            std::vector<float> out(size+1);
+            std::vector<double> outd(size);
+            acbench::simd::copy_scale(out.data()+1, pa, -0.5f, size);
+            acbench::simd::copy_scale(outd.data(), ad.data(), -0.5, size);
+            for (int k = 0; k < size; ++k)
+                REQUIRE(out[1+k] == static_cast<float>(outd[k]));
+        }
+    }
+}
+
+TEST_CASE("simd_copy_stream") {
+    std::vector<char> src(1000), dst(1000+16);
+    for (int k = 0; k < 1000; ++k)
+        src[k] = static_cast<char>(k);
+
+    // Sizes around a cache line, at any alignment of the destination
+    for (int size : {0, 1, 15, 16, 17, 63, 64, 65, 127, 128, 999}) {
+        for (int offset = 0; offset < 16; ++offset) {
+            std::fill(dst.begin(), dst.end(), 0);
+            acbench::simd::copy_stream(dst.data()+offset, src.data(), size);
+            for (int k = 0; k < size; ++k)
+                REQUIRE(dst[offset+k] == src[k]);
+            REQUIRE(dst[offset+size] == 0);
+        }
+    }
+}
+
+TEST_CASE("simd_copy") {
+    std::vector<char> src(600), dst(600+16);
+    for (int k = 0; k < 600; ++k)
+        src[k] = static_cast<char>(k);
+
+    // All the small sizes, and some above the inlined ones, at any alignment of the destination
+    for (int size = 0; size < 300; size += (size < 270 ? 1 : 29)) {
+        for (int offset = 0; offset < 16; offset += 5) {
+            std::fill(dst.begin(), dst.end(), 0);
+            acbench::simd::copy(dst.data()+offset, src.data()+1, size);
+            for (int k = 0; k < size; ++k)
+                REQUIRE(dst[offset+k] == src[1+k]);
+            REQUIRE(dst[offset+size] == 0);
+
+            // Same, as a segment of a larger chunk (the kernel being selected on the chunk size)
+            for (int size_max : {size, 16, 64, 300}) {
+                if (size_max < size)
+                    continue;
+                std::fill(dst.begin(), dst.end(), 0);
+                acbench::simd::copy(dst.data()+offset, src.data()+1, size, size_max);
+                for (int k = 0; k < size; ++k)
+                    REQUIRE(dst[offset+k] == src[1+k]);
+                REQUIRE(dst[offset+size] == 0);
+            }
+        }
+    }
+}
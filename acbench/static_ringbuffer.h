@@ -0,0 +1,308 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#ifndef ACBENCH_STATIC_RINGBUFFER_H_
+#define ACBENCH_STATIC_RINGBUFFER_H_
+
+/**
+
+Ringbuffer with a capacity fixed at compile time, for the many small buffers whose size is known in advance
+(ex. block FIFOs, delay lines).
+
+    The values are stored in the object itself (an std::array of N values), so there is no allocation at all,
+    and the capacity N is a compile-time constant: the wrap-around checks are folded to a bitmask when N is a power of two
+    (a compare otherwise), and the copies of fixed sizes can be unrolled and vectorized by the compiler.
+
+    Same chunked push/pop API as acbench::ringbuffer (push_back, pop_front, zero-copy write_reserve/read_peek, segments),
+    except that there is no allocation function, thus no dynamic allocation.
+    WARNING: The object is as big as N values. Big static_ringbuffer should not be put on the stack.
+
+Thread-safety:
+    Same as acbench::ringbuffer, chosen with the Lock template argument (std::mutex, lock_spinlock or lock_none).
+
+**/
+
+#include <acbench/ringbuffer.h>  // For the locking policies and segments
+
+#include <array>
+
+
+namespace acbench {
+
+    template<typename T, int N, typename Lock = lock_default>
+    class static_ringbuffer {
+        static_assert(N > 0, "The capacity must be positive");
+        static_assert(!is_lock_free_policy<Lock>::value, "lock_spsc and lock_mpmc are not supported by static_ringbuffer");
+
+     public:
+        typedef T value_type;
+        typedef Lock lock_type;
+
+     protected:
+        ACBENCH_MUTEX_DECLARE
+
+        std::array<T, N> m_data;
+        int m_size = 0;
+        int m_front = 0;
+        int m_end = 0;  // One after the last element
+
+        // Index in m_data of index i in [0, 2N)
+        static inline int wrap(int i) {
+            return ((N & (N-1)) == 0) ? (i & (N-1)) : (i >= N ? i-N : i);
+        }
+
+        static inline void memory_copy_nolock(value_type* pdest, const value_type* psrc, int size) {
+            std::memcpy(reinterpret_cast<void*>(pdest), reinterpret_cast<const void*>(psrc), sizeof(value_type)*static_cast<std::size_t>(size));
+        }
+
+        // Copy constructor is forbidden to avoid implicit calls.
+        explicit static_ringbuffer(const static_ringbuffer& rb) {
+            (void)rb;
+        }
+
+        inline void clear_nolock() {
+            m_front = 0;
+            m_end = 0;
+            m_size = 0;
+        }
+
+     public:
+        //! Only allowed constructor
+        static_ringbuffer() {
+        }
+
+        //! Does keep the allocation
+        inline void clear() {
+            ACBENCH_MUTEX_GUARD
+            this->clear_nolock();
+        }
+
+        inline void lock() {
+            ACBENCH_MUTEX_LOCK
+        }
+        inline void unlock() {
+            ACBENCH_MUTEX_UNLOCK
+        }
+        //! This is usefull to build a guard object out of the ringbuffer's mutex.
+        inline lock_type& mutex() const {
+            return m_mutex;
+        }
+        inline bool is_thread_safe() const {
+            return !std::is_same<lock_type, lock_none>::value;
+        }
+
+        inline value_type* data() {
+            return m_data.data();
+        }
+        inline const value_type* data() const {
+            return m_data.data();
+        }
+        static constexpr int capacity() {
+            return N;
+        }
+        static constexpr int size_max() {
+            return N;
+        }
+        inline int size() const {
+            return m_size;                // Atomic, no need of locked mutex
+        }
+        inline int size_free() const {
+            return N - m_size;            // Atomic, no need of locked mutex
+        }
+        inline bool empty() const {
+            return m_size == 0;           // Atomic, no need of locked mutex
+        }
+        inline value_type front() const {
+            assert(m_size > 0);
+            ACBENCH_MUTEX_GUARD
+            return m_data[m_front];
+        }
+        inline value_type back() const {
+            assert(m_size > 0);
+            ACBENCH_MUTEX_GUARD
+            return m_data[wrap(m_front+m_size-1)];
+        }
+
+        //! WARNING: Not thread-safe
+        inline value_type operator[](int n) const {
+            assert((n >= 0) && (n < m_size));
+            return m_data[wrap(m_front+n)];
+        }
+        //! WARNING: Not thread-safe
+        inline value_type& operator[](int n) {
+            assert((n >= 0) && (n < m_size));
+            return m_data[wrap(m_front+n)];
+        }
+
+        //! The content as (at most) two contiguous segments, from front to back.
+        //  WARNING: Not thread-safe
+        inline segment_pair<value_type> segments() {
+            int seg1size = std::min(m_size, N - m_front);
+            return segment_pair<value_type>{segment<value_type>(data()+m_front, seg1size), segment<value_type>(data(), m_size-seg1size)};
+        }
+        //! WARNING: Not thread-safe
+        inline segment_pair<const value_type> segments() const {
+            int seg1size = std::min(m_size, N - m_front);
+            return segment_pair<const value_type>{segment<const value_type>(data()+m_front, seg1size), segment<const value_type>(data(), m_size-seg1size)};
+        }
+
+        inline void push_back_nolock(const value_type v) {
+            assert(m_size+1 <= N);
+            m_data[m_end] = v;
+            m_end = wrap(m_end+1);
+            ++m_size;
+        }
+        inline void push_back(const value_type v) {
+            ACBENCH_MUTEX_GUARD
+            push_back_nolock(v);
+        }
+        inline void push_back_nolock(const value_type value, int nb_values) {
+            if (nb_values <= 0)             // Ignore pushing no values
+                return;
+            assert(m_size+nb_values <= N);
+
+            if (m_end+nb_values <= N) {
+                std::fill(data()+m_end, data()+m_end+nb_values, value);
+            } else {
+                int seg1size = N - m_end;
+                std::fill(data()+m_end, data()+N, value);
+                std::fill(data(), data()+nb_values-seg1size, value);
+            }
+
+            m_end = wrap(m_end+nb_values);
+            m_size += nb_values;
+        }
+        inline void push_back(const value_type value, int nb_values) {
+            ACBENCH_MUTEX_GUARD
+            push_back_nolock(value, nb_values);
+        }
+        inline void push_back_nolock(const value_type* array, int array_size) {
+            if (array_size <= 0)             // Ignore push of empty buffers
+                return;
+            assert(m_size+array_size <= N);
+
+            if (m_end+array_size <= N) {
+                memory_copy_nolock(data()+m_end, array, array_size);
+            } else {
+                int seg1size = N - m_end;
+                memory_copy_nolock(data()+m_end, array, seg1size);
+                memory_copy_nolock(data(), array+seg1size, array_size-seg1size);
+            }
+
+            m_end = wrap(m_end+array_size);
+            m_size += array_size;
+        }
+        inline void push_back(const value_type* array, int array_size) {
+            ACBENCH_MUTEX_GUARD
+            push_back_nolock(array, array_size);
+        }
+
+        inline value_type pop_front_nolock() {
+            assert(m_size >= 1);
+            value_type value = m_data[m_front];
+            m_front = wrap(m_front+1);
+            --m_size;
+            return value;
+        }
+        inline value_type pop_front() {
+            ACBENCH_MUTEX_GUARD
+            return pop_front_nolock();
+        }
+        inline void pop_front_nolock(int n) {
+            if (n < 1) return;                // Just ignore pops of non-existing values
+
+            if (n >= m_size) {                // Clears all if not enough to be poped
+                clear_nolock();
+                return;
+            }
+
+            m_front = wrap(m_front+n);
+            m_size -= n;
+        }
+        inline void pop_front(int n) {
+            ACBENCH_MUTEX_GUARD
+            pop_front_nolock(n);
+        }
+        inline int pop_front_nolock(value_type* array, int n) {
+            if (n < 1) return 0;              // Just ignore pops of non-existing values
+
+            if (n > m_size)                   // Pop as many values as possible
+                n = m_size;
+
+            if (m_front+n <= N) {
+                memory_copy_nolock(array, data()+m_front, n);
+            } else {
+                int seg1size = N - m_front;
+                memory_copy_nolock(array, data()+m_front, seg1size);
+                memory_copy_nolock(array+seg1size, data(), n-seg1size);
+            }
+
+            m_front = wrap(m_front+n);
+            m_size -= n;
+
+            return n;
+        }
+        inline int pop_front(value_type* array, int n) {
+            ACBENCH_MUTEX_GUARD
+            return pop_front_nolock(array, n);
+        }
+
+        // Zero-copy access, same interface as acbench::ringbuffer.
+
+        inline int write_reserve_nolock(int n, value_type** pdata1, int* size1, value_type** pdata2, int* size2) {
+            if (n > N - m_size)               // Reserve as many values as possible
+                n = N - m_size;
+            if (n < 0)
+                n = 0;
+            *pdata1 = data() + m_end;
+            *size1 = std::min(n, N - m_end);
+            *size2 = n - *size1;
+            *pdata2 = *size2 > 0 ? data() : nullptr;
+            return n;
+        }
+        inline int write_reserve(int n, value_type** pdata1, int* size1, value_type** pdata2, int* size2) {
+            ACBENCH_MUTEX_GUARD
+            return write_reserve_nolock(n, pdata1, size1, pdata2, size2);
+        }
+        inline void write_commit_nolock(int n) {
+            if (n < 1) return;                // Ignore pushing no values
+            assert(m_size+n <= N);
+            m_end = wrap(m_end+n);
+            m_size += n;
+        }
+        inline void write_commit(int n) {
+            ACBENCH_MUTEX_GUARD
+            write_commit_nolock(n);
+        }
+        inline int read_peek_nolock(int n, const value_type** pdata1, int* size1, const value_type** pdata2, int* size2) const {
+            if (n > m_size)                   // Peek as many values as possible
+                n = m_size;
+            if (n < 0)
+                n = 0;
+            *pdata1 = data() + m_front;
+            *size1 = std::min(n, N - m_front);
+            *size2 = n - *size1;
+            *pdata2 = *size2 > 0 ? data() : nullptr;
+            return n;
+        }
+        inline int read_peek(int n, const value_type** pdata1, int* size1, const value_type** pdata2, int* size2) const {
+            ACBENCH_MUTEX_GUARD
+            return read_peek_nolock(n, pdata1, size1, pdata2, size2);
+        }
+        inline void read_consume_nolock(int n) {
+            pop_front_nolock(n);
+        }
+        inline void read_consume(int n) {
+            ACBENCH_MUTEX_GUARD
+            read_consume_nolock(n);
+        }
+    };
+
+}  // namespace acbench
+
+#endif  // ACBENCH_STATIC_RINGBUFFER_H_
@@ -0,0 +1,199 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+#include <acbench/static_ringbuffer.h>
+
+#include "utils.h"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+typedef std::deque<float> ref_t;
+
+template<typename ringbuffer1_t, typename ringbuffer2_t>
+void rb_require_equals(ringbuffer1_t& rb1, ringbuffer2_t& rb2) {
+    REQUIRE(int(rb1.size()) == int(rb2.size()));
+    for (int i=0; i < rb1.size(); ++i)
+        REQUIRE(rb1[i] == rb2[i]);
+}
+
+// Runs the chunks in and out of the static_ringbuffer and of a std::deque
+template<typename test_t>
+void rb_check_push_pop(test_t& test) {
+    const int capacity = test_t::capacity();
+    ref_t ref;
+
+    std::vector<float> data(capacity);
+    for (int i = 0; i < capacity; ++i)
+        data[i] = acbench::rand_uniform_continuous_01<float>();
+    std::vector<float> out(capacity);
+
+    // Shortcuts
+    test.push_back(data.data(), 0);
+    test.push_back(1.0f, 0);
+    test.pop_front(0);
+    REQUIRE(test.pop_front(out.data(), 0) == 0);
+    REQUIRE(test.empty());
+
+    // Move the front around the buffer many times, with chunks crossing the end of the storage
+    int chunk_size = capacity/3;
+    for (int iter = 0; iter < 20; ++iter) {
+        test.push_back(data.data(), chunk_size);
+        for (int i = 0; i < chunk_size; ++i)
+            ref.push_back(data[i]);
+        test.push_back(0.5f, 7);
+        for (int i = 0; i < 7; ++i)
+            ref.push_back(0.5f);
+        test.push_back(0.25f);
+        ref.push_back(0.25f);
+        rb_require_equals(test, ref);
+        REQUIRE(test.size_free() == capacity-test.size());
+        REQUIRE(test.front() == ref.front());
+        REQUIRE(test.back() == ref.back());
+
+        int n = test.pop_front(out.data(), chunk_size);
+        REQUIRE(n == chunk_size);
+        for (int i = 0; i < n; ++i) {
+            REQUIRE(out[i] == ref.front());
+            ref.pop_front();
+        }
+        test.pop_front(3);
+        for (int i = 0; i < 3; ++i)
+            ref.pop_front();
+        REQUIRE(test.pop_front() == ref.front());
+        ref.pop_front();
+        rb_require_equals(test, ref);
+    }
+
+    // Fill completely, then pop more than available
+    test.clear();
+    ref.clear();
+    test.push_back(data.data(), capacity-1);
+    test.push_back(2.0f);
+    REQUIRE(test.size() == capacity);
+    test[0] = 3.0f;
+    REQUIRE(test.front() == 3.0f);
+    REQUIRE(test.pop_front(out.data(), capacity+10) == capacity);
+    REQUIRE(test.empty());
+
+    test.push_back(data.data(), 10);
+    test.pop_front(20);
+    REQUIRE(test.empty());
+
+    // Single values across the end of the storage
+    for (int i = 0; i < capacity+5; ++i) {
+        test.push_back(static_cast<float>(i));
+        REQUIRE(test.pop_front() == static_cast<float>(i));
+    }
+}
+
+TEST_CASE("static_ringbuffer_accessors") {
+    acbench::static_ringbuffer<float, 64> test;
+    static_assert(acbench::static_ringbuffer<float, 64>::capacity() == 64, "constexpr capacity");
+    static_assert(acbench::static_ringbuffer<float, 100>::size_max() == 100, "constexpr size_max");
+    REQUIRE(test.empty());
+    REQUIRE(test.size() == 0);
+    REQUIRE(test.size_free() == 64);
+    REQUIRE(test.is_thread_safe());
+    REQUIRE(test.data() != nullptr);
+
+    acbench::static_ringbuffer<double, 10, acbench::lock_none> test_double;
+    REQUIRE(!test_double.is_thread_safe());
+    test_double.lock();
+    test_double.unlock();
+    acbench::lock_guard<acbench::lock_none> guard(test_double.mutex());
+
+    const acbench::static_ringbuffer<float, 64>& test_const = test;
+    REQUIRE(test_const.data() == test.data());
+}
+
+TEST_CASE("static_ringbuffer_push_pop") {
+    // Power of two capacity (bitmask), and not (compare)
+    acbench::static_ringbuffer<float, 1024> test_pow2;
+    rb_check_push_pop(test_pow2);
+    acbench::static_ringbuffer<float, 1000> test;
+    rb_check_push_pop(test);
+
+    // Big ones are not meant for the stack
+    std::unique_ptr<acbench::static_ringbuffer<float, 4096, acbench::lock_spinlock>> test_heap(new acbench::static_ringbuffer<float, 4096, acbench::lock_spinlock>());
+    rb_check_push_pop(*test_heap);
+}
+
+TEST_CASE("static_ringbuffer_segments") {
+    acbench::static_ringbuffer<float, 100> test;
+    const acbench::static_ringbuffer<float, 100>& test_const = test;
+
+    test.push_back(1.0f, 60);
+    test.pop_front(40);
+    auto segs = test.segments();
+    REQUIRE(segs.first.data() == test.data()+40);
+    REQUIRE(segs.first.size() == 20);
+    REQUIRE(segs.second.empty());
+
+    test.push_back(2.0f, 70);
+    segs = test.segments();
+    REQUIRE(segs.first.size() == 60);
+    REQUIRE(segs.second.data() == test.data());
+    REQUIRE(segs.second.size() == 30);
+    for (float& v : segs.second)
+        v = 3.0f;
+    REQUIRE(test[89] == 3.0f);
+
+    auto csegs = test_const.segments();
+    REQUIRE(csegs.first.size() == 60);
+    REQUIRE(csegs.second.size() == 30);
+    REQUIRE(test_const[0] == 1.0f);
+    REQUIRE(test_const[59] == 2.0f);
+}
+
+TEST_CASE("static_ringbuffer_zero_copy") {
+    acbench::static_ringbuffer<float, 128> test;
+
+    float* pw1 = nullptr; float* pw2 = nullptr;
+    const float* pr1 = nullptr; const float* pr2 = nullptr;
+    int size1 = 0, size2 = 0;
+
+    // Contiguous
+    REQUIRE(test.write_reserve(100, &pw1, &size1, &pw2, &size2) == 100);
+    REQUIRE(pw1 == test.data());
+    REQUIRE(size1 == 100);
+    REQUIRE(pw2 == nullptr);
+    REQUIRE(size2 == 0);
+    test.write_commit(100);
+    test.pop_front(90);
+
+    // Across the end of the storage
+    REQUIRE(test.write_reserve(200, &pw1, &size1, &pw2, &size2) == 118);
+    REQUIRE(size1 == 28);
+    REQUIRE(pw2 == test.data());
+    REQUIRE(size2 == 90);
+    for (int i = 0; i < size1; ++i)
+        pw1[i] = static_cast<float>(i);
+    for (int i = 0; i < size2; ++i)
+        pw2[i] = static_cast<float>(size1+i);
+    test.write_commit(118);
+    REQUIRE(test.size() == 128);
+
+    REQUIRE(test.read_peek(200, &pr1, &size1, &pr2, &size2) == 128);
+    REQUIRE(size1 == 38);
+    REQUIRE(size2 == 90);
+    REQUIRE(pr1[10] == 0.0f);
+    REQUIRE(pr2[0] == 28.0f);
+    test.read_consume(38);
+    REQUIRE(test.read_peek(10, &pr1, &size1, &pr2, &size2) == 10);
+    REQUIRE(pr1[0] == 28.0f);
+    REQUIRE(pr2 == nullptr);
+
+    // Shortcuts
+    test.write_commit(0);
+    REQUIRE(test.write_reserve(-1, &pw1, &size1, &pw2, &size2) == 0);
+    REQUIRE(test.read_peek(-1, &pr1, &size1, &pr2, &size2) == 0);
+}
@@ -11,41 +11,148 @@
 
 #include "utils.h"
 #include <acbench/ringbuffer.h>
+#include <acbench/allocators.h>
 // #include <acbench/vector.h>
 
 #include <chrono>  // TODO(GD) Not approved??
 #include <deque>
 #include <algorithm>
+#include <numeric>
 #include <string>
+#include <utility>  // For std::move
 #include <cmath>
 #include <mutex>
 #include <iostream>
 #include <cassert>
+#include <cstdint>
+#include <cstring>  // For std::memset(.)
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
 
 namespace acbench {
 
     //! This object stores the last million time intervals between `.start()` and `.end()` calls.
     //  ( limit can be changed with `set_size_max(.)` )
+    //  The memory is committed as the measures are stored (see allocator_lazy), so that a time_elapsed
+    //  that records only a few thousand measures doesn't cost its whole capacity.
+    //  With `set_deadline(.)`, the intervals longer than the deadline are counted as deadline misses
+    //  (ex. for a periodic real-time callback, started at its scheduled wake-up time with `start(time_point)`).
+    //  With `enable_counters()` (Linux only), the hardware performance counters of the thread that enabled them
+    //  are also sampled by `.start()` and `.end()`, and their counts between the two are stored alongside
+    //  the intervals (see `counters(.)`), to see why a measure is slow (ex. cache misses vs. branch misses).
     class time_elapsed {
+     public:
+        // Only used by the thread measuring, so no need to pay for any lock
+        typedef acbench::ringbuffer<double, acbench::lock_none, acbench::allocator_lazy<double>> buffer_type;
+
+        //! The hardware performance counters that can be sampled (see `enable_counters()`)
+        enum class counter {
+            cycles = 0,
+            instructions,
+            l1d_misses,     // L1 data cache read misses
+            llc_misses,     // Last level cache misses
+            branch_misses
+        };
+        static const int nb_counters = 5;
+        static inline const char* counter_name(counter c) {
+            static const char* names[nb_counters] = {"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+            return names[static_cast<int>(c)];
+        }
+
      private:
 
         std::chrono::high_resolution_clock::time_point m_start;
         std::chrono::high_resolution_clock::time_point m_end;
 
-        acbench::ringbuffer<double> m_elapsed;
-        acbench::ringbuffer<double> m_proced_duration;
+        buffer_type m_elapsed;
+        buffer_type m_proced_duration;
         // mutable std::mutex m_elapsed_median_mutex;
         // mutable acbench::vector<double> m_elapsed_median_sorted;
 
         int m_size_max = 1000000;
 
+        double m_deadline = 0.0;        // [s], 0 if none
+        int m_nb_deadline_misses = 0;
+
+        // The counters opened by enable_counters(), as one group so that they are all read at once
+        int m_counters_fd[nb_counters] = {-1, -1, -1, -1, -1};
+        int m_counters_group_fd = -1;
+        unsigned int m_counters_mask = 0;   // Bit i set if the counter i is measured
+        uint64_t m_counters_start[nb_counters] = {0, 0, 0, 0, 0};
+        buffer_type m_counters[nb_counters];
+
+        inline bool has_counter(int i) const {
+            return (m_counters_mask >> i) & 1u;
+        }
+        // Reads the current values of the measured counters, in the order of the counter enum.
+        inline void read_counters(uint64_t* values) const {
+            #if defined(__linux__)
+                uint64_t data[1+nb_counters];  // PERF_FORMAT_GROUP: the number of counters, then their values
+                if (read(m_counters_group_fd, data, sizeof(data)) < static_cast<ssize_t>(sizeof(uint64_t)))
+                    return;
+                for (int i = 0, k = 0; i < nb_counters && k < static_cast<int>(data[0]); ++i)
+                    if (has_counter(i))
+                        values[i] = data[1+(k++)];
+            #else
+                (void)values;
+            #endif
+        }
+        // Copies the counter values of te (but not its file descriptors, which stay owned by te).
+        inline void copy_counters(const time_elapsed& te) {
+            m_counters_mask = te.m_counters_mask;
+            for (int i = 0; i < nb_counters; ++i) {
+                m_counters[i].clear();
+                if (has_counter(i)) {
+                    m_counters[i].resize_allocation(m_size_max);
+                    m_counters[i].push_back(te.m_counters[i]);
+                }
+            }
+        }
+        // Takes over the counters of te, file descriptors included (te then measures no counter).
+        inline void take_counters(time_elapsed* pte) {
+            for (int i = 0; i < nb_counters; ++i) {
+                m_counters_fd[i] = pte->m_counters_fd[i];
+                pte->m_counters_fd[i] = -1;
+                m_counters_start[i] = pte->m_counters_start[i];
+                m_counters[i] = std::move(pte->m_counters[i]);
+            }
+            m_counters_group_fd = pte->m_counters_group_fd;
+            pte->m_counters_group_fd = -1;
+            m_counters_mask = pte->m_counters_mask;
+            pte->m_counters_mask = 0;
+        }
+        // Drops the measured counters (but keeps the file descriptors, if any).
+        inline void clear_counters() {
+            m_counters_mask = 0;
+            for (int i = 0; i < nb_counters; ++i)
+                m_counters[i].clear();
+        }
+        inline void close_counters() {
+            #if defined(__linux__)
+                for (int i = 0; i < nb_counters; ++i) {
+                    if (m_counters_fd[i] >= 0)
+                        close(m_counters_fd[i]);
+                    m_counters_fd[i] = -1;
+                }
+            #endif
+            m_counters_group_fd = -1;
+        }
+
+        // Runs over the (at most two) contiguous segments, without any modulo per value.
+        static inline double sum_segments(const buffer_type& rb) {
+            auto segs = rb.segments();
+            double sum = std::accumulate(segs.first.begin(), segs.first.end(), 0.0);
+            return std::accumulate(segs.second.begin(), segs.second.end(), sum);
+        }
+
      public:
         explicit time_elapsed(int size_max = 1000000) {
             set_size_max(size_max);
-            m_elapsed.resize_allocation(m_size_max);
-            m_proced_duration.resize_allocation(m_size_max);
             // m_elapsed_median_sorted.resize_allocation(size_max);
-            reset();
         }
         time_elapsed(const time_elapsed& te) {
             set_size_max(te.size_max());
@@ -57,15 +164,50 @@ namespace acbench {
             // m_elapsed_median_sorted.resize(te.m_elapsed_median_sorted.size());
             m_start = te.m_start;
             m_end = te.m_end;
+            m_deadline = te.m_deadline;
+            m_nb_deadline_misses = te.m_nb_deadline_misses;
+            copy_counters(te);
         }
         time_elapsed& operator=(const time_elapsed& te) {
+            if (this == &te)
+                return *this;
             m_elapsed = te.m_elapsed;
             m_start = te.m_start;
             m_end = te.m_end;
             m_proced_duration = te.m_proced_duration;
+            m_deadline = te.m_deadline;
+            m_nb_deadline_misses = te.m_nb_deadline_misses;
+            close_counters();
+            copy_counters(te);
+            return *this;
+        }
+        //! Takes over the measures of te in O(1), without copying nor allocating.
+        time_elapsed(time_elapsed&& te)
+            : m_start(te.m_start)
+            , m_end(te.m_end)
+            , m_elapsed(std::move(te.m_elapsed))
+            , m_proced_duration(std::move(te.m_proced_duration))
+            , m_size_max(te.m_size_max)
+            , m_deadline(te.m_deadline)
+            , m_nb_deadline_misses(te.m_nb_deadline_misses) {
+            take_counters(&te);
+        }
+        time_elapsed& operator=(time_elapsed&& te) {
+            if (this == &te)
+                return *this;
+            m_start = te.m_start;
+            m_end = te.m_end;
+            m_elapsed = std::move(te.m_elapsed);
+            m_proced_duration = std::move(te.m_proced_duration);
+            m_size_max = te.m_size_max;
+            m_deadline = te.m_deadline;
+            m_nb_deadline_misses = te.m_nb_deadline_misses;
+            close_counters();
+            take_counters(&te);
             return *this;
         }
         ~time_elapsed() {
+            close_counters();
         }
         inline int size() const {
             return m_elapsed.size();
@@ -79,26 +221,151 @@ namespace acbench {
             m_size_max = size_max;
             m_elapsed.resize_allocation(m_size_max);
             m_proced_duration.resize_allocation(m_size_max);
+            for (int i = 0; i < nb_counters; ++i)
+                if (has_counter(i))
+                    m_counters[i].resize_allocation(m_size_max);
             reset();
         }
+        //! The counters are kept only if both te and this measure them.
         inline void merge(const time_elapsed& te) {
             m_elapsed.push_back(te.m_elapsed);
             m_proced_duration.push_back(te.m_proced_duration);
+            m_nb_deadline_misses += te.m_nb_deadline_misses;
+            for (int i = 0; i < nb_counters; ++i) {
+                if (has_counter(i) && (te.m_counters_mask >> i) & 1u) {
+                    m_counters[i].push_back(te.m_counters[i]);
+                } else {
+                    m_counters[i].clear();
+                    m_counters_mask &= ~(1u << i);
+                }
+            }
+        }
+        //! Same, but takes over the measures of te in O(1) when there is no measure yet (te is then left empty).
+        inline void merge(time_elapsed&& te) {
+            if (m_elapsed.empty() && te.m_size_max == m_size_max && m_counters_mask == te.m_counters_mask) {
+                m_elapsed.swap(te.m_elapsed);
+                for (int i = 0; i < nb_counters; ++i)
+                    m_counters[i].swap(te.m_counters[i]);
+                m_proced_duration.swap(te.m_proced_duration);
+                m_nb_deadline_misses += te.m_nb_deadline_misses;
+                te.m_nb_deadline_misses = 0;
+                return;
+            }
+            merge(te);
+        }
+        //! Opens the hardware performance counters of the calling thread, which then has to be the one measuring.
+        //  Counts the user space only. Returns false if none of them could be opened (ex. not Linux, no access
+        //  granted by /proc/sys/kernel/perf_event_paranoid, or no PMU exposed in a virtual machine), the other
+        //  ones being skipped (see `has_counter(.)`).
+        //  The previous measures are dropped, as they have no counts (see `reset()`).
+        inline bool enable_counters() {
+            close_counters();
+            m_counters_mask = 0;
+            #if defined(__linux__)
+                const uint32_t types[nb_counters] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+                const uint64_t configs[nb_counters] = {
+                    PERF_COUNT_HW_CPU_CYCLES,
+                    PERF_COUNT_HW_INSTRUCTIONS,
+                    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+                    PERF_COUNT_HW_CACHE_MISSES,
+                    PERF_COUNT_HW_BRANCH_MISSES
+                };
+                for (int i = 0; i < nb_counters; ++i) {
+                    struct perf_event_attr attr;
+                    std::memset(&attr, 0, sizeof(attr));
+                    attr.size = sizeof(attr);
+                    attr.type = types[i];
+                    attr.config = configs[i];
+                    attr.disabled = (m_counters_group_fd < 0) ? 1 : 0;  // The group leader enables the group
+                    attr.exclude_kernel = 1;
+                    attr.exclude_hv = 1;
+                    attr.read_format = PERF_FORMAT_GROUP;
+                    int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, m_counters_group_fd, 0));
+                    if (fd < 0)
+                        continue;
+                    m_counters_fd[i] = fd;
+                    if (m_counters_group_fd < 0)
+                        m_counters_group_fd = fd;
+                    m_counters_mask |= 1u << i;
+                }
+                if (m_counters_group_fd >= 0)
+                    ioctl(m_counters_group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            #endif
+            for (int i = 0; i < nb_counters; ++i) {
+                m_counters[i].clear();
+                if (has_counter(i))
+                    m_counters[i].resize_allocation(m_size_max);
+                m_counters_start[i] = 0;
+            }
+            reset();  // Otherwise the counters would be shorter than m_elapsed, and end() would pop them when empty
+            return m_counters_mask != 0;
+        }
+        inline bool counters_enabled() const {
+            return m_counters_group_fd >= 0;
+        }
+        //! True if the counter is measured (or was, for a copy, until its next `.end()`)
+        inline bool has_counter(counter c) const {
+            return has_counter(static_cast<int>(c));
+        }
+        //! The counts of the counter c between each `.start()` and `.end()`, aligned with `elapsed()`
+        const buffer_type& counters(counter c) const {
+            return m_counters[static_cast<int>(c)];
+        }
+        inline double counter_mean(counter c) const {
+            const buffer_type& values = counters(c);
+            assert(values.size() > 0);
+            return sum_segments(values)/values.size();
         }
         inline void start() {
+            if (m_counters_group_fd >= 0)
+                read_counters(m_counters_start);  // Before the clock, so that the read isn't in the interval
             m_start = std::chrono::high_resolution_clock::now();
         }
+        //! Starts the interval at the given time, ex. the scheduled wake-up time of a periodic thread,
+        //  so that the interval also includes the wake-up latency.
+        inline void start(const std::chrono::high_resolution_clock::time_point& start_time) {
+            if (m_counters_group_fd >= 0)
+                read_counters(m_counters_start);
+            m_start = start_time;
+        }
         inline void end(float proced_duration) {
             m_end = std::chrono::high_resolution_clock::now();
+            uint64_t counters_end[nb_counters];
+            std::copy(m_counters_start, m_counters_start+nb_counters, counters_end);  // No count if the read fails
+            if (m_counters_group_fd >= 0)
+                read_counters(counters_end);
             std::chrono::duration<double> diff = (m_end-m_start);
+            if (!counters_enabled() && m_counters_mask != 0)
+                clear_counters();  // Copied counters that can't be measured anymore, they would not be aligned with elapsed()
             if ((m_size_max > 0) && (m_elapsed.size()+1 > m_size_max)) {
                 m_elapsed.pop_front();
                 m_proced_duration.pop_front();
+                for (int i = 0; i < nb_counters; ++i)
+                    if (has_counter(i))
+                        m_counters[i].pop_front();
             }
             m_elapsed.push_back(diff.count());
             m_proced_duration.push_back(proced_duration);
+            for (int i = 0; i < nb_counters; ++i)
+                if (has_counter(i))
+                    m_counters[i].push_back(static_cast<double>(counters_end[i]-m_counters_start[i]));
+            if ((m_deadline > 0.0) && (diff.count() > m_deadline))
+                ++m_nb_deadline_misses;
+        }
+        //! The intervals longer than deadline [s] are then counted as deadline misses (0 to disable).
+        inline void set_deadline(double deadline) {
+            assert(deadline >= 0.0);
+            m_deadline = deadline;
         }
-        const acbench::ringbuffer<double>& elapsed() const {
+        inline double deadline() const {
+            return m_deadline;
+        }
+        //! Number of intervals longer than the deadline since the last reset(.)
+        //  (also those that were dropped when the capacity was reached).
+        inline int nb_deadline_misses() const {
+            return m_nb_deadline_misses;
+        }
+        const buffer_type& elapsed() const {
             return m_elapsed;
         }
         double elapsed_last() const {
@@ -108,40 +375,35 @@ namespace acbench {
         inline void reset() {
             m_elapsed.clear();
             m_proced_duration.clear();
+            m_nb_deadline_misses = 0;
+            for (int i = 0; i < nb_counters; ++i)
+                m_counters[i].clear();
         }
         inline double proced_duration() const {
-            double proced_duration_sum = 0.0;
-            for (int n=0; n<m_proced_duration.size(); ++n)
-                proced_duration_sum += m_proced_duration[n];
-            return proced_duration_sum;
+            return sum_segments(m_proced_duration);
         }
         inline double sum() const {
-            double sum = 0.0;
-            for (int n=0; n<m_elapsed.size(); ++n)
-                sum += m_elapsed[n];
-            return sum;
+            return sum_segments(m_elapsed);
         }
         inline double min() const {
             assert(m_elapsed.size() > 0);
-            double val = m_elapsed[0];
-            for (int n = 1; n < int(m_elapsed.size()); ++n)
-                val = std::min(val, m_elapsed[n]);
+            auto segs = m_elapsed.segments();
+            double val = *std::min_element(segs.first.begin(), segs.first.end());
+            if (!segs.second.empty())
+                val = std::min(val, *std::min_element(segs.second.begin(), segs.second.end()));
             return val;
         }
         inline double max() const {
             assert(m_elapsed.size() > 0);
-            double val = m_elapsed[0];
-            for (int n = 1; n < int(m_elapsed.size()); ++n)
-                val = std::max(val, m_elapsed[n]);
+            auto segs = m_elapsed.segments();
+            double val = *std::max_element(segs.first.begin(), segs.first.end());
+            if (!segs.second.empty())
+                val = std::max(val, *std::max_element(segs.second.begin(), segs.second.end()));
             return val;
         }
         inline double mean() const {
             assert(m_elapsed.size() > 0);
-            double mean_sum = 0.0;
-            for (int n=0; n < int(m_elapsed.size()); ++n) {
-                mean_sum += m_elapsed[n];
-            }
-            return mean_sum/m_elapsed.size();
+            return sum_segments(m_elapsed)/m_elapsed.size();
         }
 
         // inline double median() const {
@@ -159,9 +421,12 @@ namespace acbench {
                 return 0.0;
             double meanv = mean();
             double var_sum = 0.0;
-            for (int n=0; n < int(m_elapsed.size()); ++n) {
-                double d = m_elapsed[n] - meanv;
-                var_sum += d*d;
+            auto segs = m_elapsed.segments();
+            for (const auto& seg : {segs.first, segs.second}) {
+                for (double v : seg) {
+                    double d = v - meanv;
+                    var_sum += d*d;
+                }
             }
             double var;
             if (m_elapsed.size() > 1)
@@ -189,6 +454,15 @@ namespace acbench {
             if (proced_duration() > 0.0)
                 res += ", RTX="+acbench::to_string(proced_duration()/sum(), "%5.3f");
 
+            if (m_deadline > 0.0)
+                res += ", missed="+std::to_string(m_nb_deadline_misses)+"(deadline="+acbench::to_string(m_deadline*std::pow(10,exp10), "%.2f")+unit+")";
+
+            if (has_counter(counter::cycles) && has_counter(counter::instructions) && counter_mean(counter::cycles) > 0.0)
+                res += ", IPC="+acbench::to_string(counter_mean(counter::instructions)/counter_mean(counter::cycles), "%4.2f");
+            for (int i = 0; i < nb_counters; ++i)
+                if (has_counter(i))
+                    res += std::string(", ")+counter_name(static_cast<counter>(i))+"="+std::to_string(static_cast<long long>(counter_mean(static_cast<counter>(i))+0.5));
+
             res += ", #"+std::to_string(size())+"/"+std::to_string(size_max());
 
             if (size()==size_max())
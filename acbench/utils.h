@@ -46,10 +46,12 @@ namespace acbench {
     inline void print(std::ostream* pout, const Array& array) {
         std::ostream& out = *pout;
         out << "[";
-        for (int n=0; n < int(array.size()); ++n) {
-            if (n > 0)
+        bool first = true;
+        for (const auto& v : array) {
+            if (!first)
                 out << ", ";
-            out << array[n];
+            out << v;
+            first = false;
         }
         out << "]";
     }
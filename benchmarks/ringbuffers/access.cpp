@@ -0,0 +1,205 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+// Benchmark of the element-wise accesses of acbench::ringbuffer, as used in per-sample loops,
+// compared to its iterators and segments view.
+
+#include <acbench/ringbuffer.h>
+#include <acbench/time_elapsed.h>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <iostream>
+
+#include "../ext/cxxopts/include/cxxopts.hpp"  // TODO(GD) Very slow compilation
+
+typedef acbench::ringbuffer<float, acbench::lock_none> ringbuffer_t;
+
+class Access {
+ public:
+    std::string m_name;
+    acbench::time_elapsed m_elapsed;
+    float m_acc = 0.0f;  // Output of the loops, so that the compiler can't remove them
+
+    explicit Access(const std::string& name, int nb_iter)
+        : m_name(name)
+        , m_elapsed(nb_iter+1) {
+    }
+    virtual ~Access() {
+    }
+
+    virtual void run_read(const ringbuffer_t& rb) = 0;
+    virtual void run_write(ringbuffer_t& rb) = 0;
+};
+
+// Reference: what operator[] computed before the power-of-two mode
+class AccessModulo : public Access {
+ public:
+    explicit AccessModulo(int nb_iter) : Access("modulo", nb_iter) {}
+
+    virtual void run_read(const ringbuffer_t& rb) {
+        const float* data = rb.data();
+        int front = rb.front_data_index();
+        int size_max = rb.size_max();
+        m_elapsed.start();
+        float acc = 0.0f;
+        for (int n = 0; n < rb.size(); ++n)
+            acc += data[(front+n)%size_max];
+        m_elapsed.end(0.0f);
+        m_acc += acc;
+    }
+    virtual void run_write(ringbuffer_t& rb) {
+        float* data = rb.data();
+        int front = rb.front_data_index();
+        int size_max = rb.size_max();
+        m_elapsed.start();
+        for (int n = 0; n < rb.size(); ++n)
+            data[(front+n)%size_max] *= -1.0f;
+        m_elapsed.end(0.0f);
+    }
+};
+
+// operator[] of the given ringbuffer (a power-of-two capacity uses the mask)
+class AccessOperator : public Access {
+ public:
+    explicit AccessOperator(const std::string& name, int nb_iter) : Access(name, nb_iter) {}
+
+    virtual void run_read(const ringbuffer_t& rb) {
+        m_elapsed.start();
+        float acc = 0.0f;
+        for (int n = 0; n < rb.size(); ++n)
+            acc += rb[n];
+        m_elapsed.end(0.0f);
+        m_acc += acc;
+    }
+    virtual void run_write(ringbuffer_t& rb) {
+        m_elapsed.start();
+        for (int n = 0; n < rb.size(); ++n)
+            rb[n] *= -1.0f;
+        m_elapsed.end(0.0f);
+    }
+};
+
+// STL algorithms over the segments view: plain contiguous memory, that can be vectorized
+class AccessSegments : public Access {
+ public:
+    explicit AccessSegments(int nb_iter) : Access("segments", nb_iter) {}
+
+    virtual void run_read(const ringbuffer_t& rb) {
+        m_elapsed.start();
+        auto segs = rb.segments();
+        float acc = std::accumulate(segs.first.begin(), segs.first.end(), 0.0f);
+        acc = std::accumulate(segs.second.begin(), segs.second.end(), acc);
+        m_elapsed.end(0.0f);
+        m_acc += acc;
+    }
+    virtual void run_write(ringbuffer_t& rb) {
+        m_elapsed.start();
+        auto segs = rb.segments();
+        for (const auto& seg : {segs.first, segs.second})
+            for (float& v : seg)
+                v *= -1.0f;
+        m_elapsed.end(0.0f);
+    }
+};
+
+// STL algorithms over the random-access iterators
+class AccessIterator : public Access {
+ public:
+    explicit AccessIterator(int nb_iter) : Access("iterator", nb_iter) {}
+
+    virtual void run_read(const ringbuffer_t& rb) {
+        m_elapsed.start();
+        float acc = std::accumulate(rb.begin(), rb.end(), 0.0f);
+        m_elapsed.end(0.0f);
+        m_acc += acc;
+    }
+    virtual void run_write(ringbuffer_t& rb) {
+        m_elapsed.start();
+        for (float& v : rb)
+            v *= -1.0f;
+        m_elapsed.end(0.0f);
+    }
+};
+
+int main(int argc, char* argv[]) {
+
+    cxxopts::Options options("benchmark_ringbuffers_access", "Benchmark element-wise accesses of acbench::ringbuffer");
+    options.add_options()
+        ("i,iterations", "Number of iterations.", cxxopts::value<int>()->default_value("100"))
+        ("s,size", "Number of values in the ringbuffers.", cxxopts::value<int>()->default_value("1000000"))
+        ("h,help", "Print usage")
+    ;
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    std::srand(0);
+
+    int nb_iter = result["iterations"].as<int>();
+    int size = result["size"].as<int>();
+    std::cout << "#Iterations: " << nb_iter << std::endl;
+    std::cout << "size: " << size << std::endl;
+
+    // The same content, with the front in the middle of the allocation so that the data wraps around
+    ringbuffer_t rb_any;
+    rb_any.resize_allocation(size+1);
+    if (rb_any.is_size_max_pow2())
+        rb_any.resize_allocation(size+2);
+    ringbuffer_t rb_pow2;
+    rb_pow2.resize_allocation_pow2(size);
+    for (ringbuffer_t* prb : {&rb_any, &rb_pow2}) {
+        prb->push_back(0.0f, prb->size_max()/2);
+        prb->pop_front(prb->size_max()/2);
+        for (int n = 0; n < size; ++n)
+            prb->push_back(acbench::rand_uniform_continuous_01<float>());
+    }
+    std::cout << "capacities: " << rb_any.size_max() << " and " << rb_pow2.size_max() << " (power of two)" << std::endl;
+
+    // Each access method with the ringbuffer it runs on
+    std::vector<std::pair<Access*, ringbuffer_t*>> accesses;
+    accesses.push_back(std::make_pair(new AccessModulo(nb_iter), &rb_any));
+    accesses.push_back(std::make_pair(new AccessOperator("operator[]", nb_iter), &rb_any));
+    accesses.push_back(std::make_pair(new AccessOperator("operator[]_pow2", nb_iter), &rb_pow2));
+    accesses.push_back(std::make_pair(new AccessIterator(nb_iter), &rb_any));
+    accesses.push_back(std::make_pair(new AccessSegments(nb_iter), &rb_any));
+
+    std::mt19937 gen(0);
+    std::vector<int> order(accesses.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    for (int scenario = 0; scenario < 2; ++scenario) {
+        for (int iter = 0; iter < nb_iter; ++iter) {
+            // Run each access in a randomized order
+            std::shuffle(order.begin(), order.end(), gen);
+            for (int ai : order) {
+                if (scenario == 0)
+                    accesses[ai].first->run_read(*accesses[ai].second);
+                else
+                    accesses[ai].first->run_write(*accesses[ai].second);
+            }
+        }
+
+        std::cout << (scenario == 0 ? "read:" : "write:") << std::endl;
+        for (auto& access : accesses) {
+            std::cout << "    " << access.first->m_name << ": " << access.first->m_elapsed.stats(6)
+                      << ", " << acbench::to_string(access.first->m_elapsed.mean()*1e9/size, "%5.3f") << "ns/sample" << std::endl;
+            access.first->m_elapsed.reset();
+        }
+    }
+
+    for (auto& access : accesses)
+        delete access.first;
+
+    return 0;
+}
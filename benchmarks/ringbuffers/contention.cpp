@@ -0,0 +1,228 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+// Benchmark of several producer threads pushing chunks into one ringbuffer drained by one consumer thread
+// (ex. several decoder threads fanning in), with 1 to 16 producers, for the mutex and spinlock locking policies
+// compared to the multi-producer/multi-consumer policy (lock_mpmc, see acbench/ringbuffer.h).
+// Each producer times each of its pushes, from the first attempt until the chunk is in (retrying while the
+// ringbuffer is full), which gives the tail latency. The throughput is the number of values pushed per second
+// by all the producers together.
+
+#include <acbench/ringbuffer.h>
+#include <acbench/time_elapsed.h>
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <iostream>
+
+#include "../ext/cxxopts/include/cxxopts.hpp"  // TODO(GD) Very slow compilation
+
+class Contention {
+ public:
+    std::string m_name;
+
+    explicit Contention(const std::string& name)
+        : m_name(name) {
+    }
+    virtual ~Contention() {}
+
+    virtual void resize_allocation(int capacity) = 0;
+    //! Pushes all the values of the chunk or none. Returns the number of values pushed.
+    virtual int push_back_all(const float* chunk, int chunk_size) = 0;
+    //! Pops up to n values. Returns the number of values popped.
+    virtual int pop_front(float* chunk, int n) = 0;
+};
+
+template<typename Lock>
+class ContentionLocked : public Contention {
+ public:
+    acbench::ringbuffer<float, Lock> m_buffer;
+
+    explicit ContentionLocked(const std::string& name)
+        : Contention(name) {
+    }
+    void resize_allocation(int capacity) override {
+        m_buffer.resize_allocation(capacity);
+    }
+    int push_back_all(const float* chunk, int chunk_size) override {
+        acbench::lock_guard<Lock> guard(m_buffer.mutex());
+        if (m_buffer.size_max() - m_buffer.size() < chunk_size)
+            return 0;
+        m_buffer.push_back_nolock(chunk, chunk_size);
+        return chunk_size;
+    }
+    int pop_front(float* chunk, int n) override {
+        acbench::lock_guard<Lock> guard(m_buffer.mutex());
+        return m_buffer.pop_front_nolock(chunk, n);
+    }
+};
+
+class ContentionMPMC : public Contention {
+ public:
+    acbench::mpmc_ringbuffer<float> m_buffer;
+
+    explicit ContentionMPMC(const std::string& name)
+        : Contention(name) {
+    }
+    void resize_allocation(int capacity) override {
+        m_buffer.resize_allocation(capacity);
+    }
+    int push_back_all(const float* chunk, int chunk_size) override {
+        return m_buffer.push_back_all(chunk, chunk_size);
+    }
+    int pop_front(float* chunk, int n) override {
+        return m_buffer.pop_front(chunk, n);
+    }
+};
+
+// Quantile of the measures, in [s]
+static double quantile(std::vector<double> values, double q) {
+    if (values.empty())
+        return 0.0;
+    std::size_t n = static_cast<std::size_t>(q*(values.size()-1));
+    std::nth_element(values.begin(), values.begin()+n, values.end());
+    return values[n];
+}
+
+int main(int argc, char* argv[]) {
+
+    cxxopts::Options options("benchmark_ringbuffers_contention", "Benchmark several producer threads pushing into one acbench::ringbuffer, with a mutex vs. lock_mpmc");
+    options.add_options()
+        ("i,iterations", "Number of iterations for each number of producers.", cxxopts::value<int>()->default_value("5"))
+        ("n,nb_values", "Number of values pushed by each producer per iteration.", cxxopts::value<int>()->default_value("262144"))
+        ("c,chunk_size", "Number of values per push.", cxxopts::value<int>()->default_value("64"))
+        ("s,size_max", "Capacity of the ringbuffer.", cxxopts::value<int>()->default_value("4096"))
+        ("p,producers_max", "Max number of producers (1, 2, 4, ... up to this number).", cxxopts::value<int>()->default_value("16"))
+        ("h,help", "Print usage")
+    ;
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    std::srand(0);
+
+    int nb_iter = result["iterations"].as<int>();
+    int nb_values = result["nb_values"].as<int>();
+    int chunk_size = result["chunk_size"].as<int>();
+    int size_max = result["size_max"].as<int>();
+    int producers_max = result["producers_max"].as<int>();
+    nb_values = std::max(chunk_size, (nb_values/chunk_size)*chunk_size);  // Whole chunks only
+    std::cout << "#Iterations: " << nb_iter << std::endl;
+    std::cout << "nb_values: " << nb_values << std::endl;
+    std::cout << "chunk_size: " << chunk_size << std::endl;
+    std::cout << "size_max: " << size_max << std::endl;
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    if (size_max < chunk_size) {
+        std::cerr << "ERROR: size_max (=" << size_max << ") has to be at least chunk_size (=" << chunk_size << ")." << std::endl;
+        return 1;
+    }
+
+    std::vector<Contention*> contentions;
+    contentions.push_back(new ContentionLocked<std::mutex>("mutex"));
+    contentions.push_back(new ContentionLocked<acbench::lock_spinlock>("spinlock"));
+    contentions.push_back(new ContentionMPMC("mpmc"));
+
+    std::mt19937 gen(0);
+    std::vector<int> order(contentions.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    std::vector<float> chunk_ref(chunk_size);
+    for (int k = 0; k < chunk_size; ++k)
+        chunk_ref[k] = acbench::rand_uniform_continuous_01<float>();
+
+    bool ok = true;
+
+    for (int nb_producers = 1; nb_producers <= producers_max; nb_producers *= 2) {
+        std::cout << "INFO: nb_producers=" << nb_producers << std::endl;
+
+        std::vector<acbench::time_elapsed> elapsed_push(contentions.size(), acbench::time_elapsed(nb_iter*nb_producers*(nb_values/chunk_size)+1));
+        std::vector<acbench::time_elapsed> elapsed_total(contentions.size(), acbench::time_elapsed(nb_iter+1));
+
+        for (int iter = 0; iter < nb_iter; ++iter) {
+            // Run each locking policy in a randomized order
+            std::shuffle(order.begin(), order.end(), gen);
+            for (int ci : order) {
+                Contention* contention = contentions[ci];
+                contention->resize_allocation(size_max);
+
+                std::atomic<bool> go(false);
+                std::vector<acbench::time_elapsed> elapsed_producers(nb_producers, acbench::time_elapsed(nb_values/chunk_size+1));
+                std::vector<std::thread> producers;
+                for (int p = 0; p < nb_producers; ++p) {
+                    producers.push_back(std::thread([&, p]() {
+                        while (!go.load(std::memory_order_acquire))
+                            std::this_thread::yield();
+                        for (int n = 0; n < nb_values; n += chunk_size) {
+                            elapsed_producers[p].start();
+                            while (contention->push_back_all(chunk_ref.data(), chunk_size) == 0)
+                                std::this_thread::yield();
+                            elapsed_producers[p].end(0.0f);
+                        }
+                    }));
+                }
+
+                // The consumer runs in the main thread
+                std::vector<float> chunk_pull(chunk_size);
+                long long nb_popped = 0;
+                long long nb_total = static_cast<long long>(nb_producers)*nb_values;
+                double checksum = 0.0;
+                elapsed_total[ci].start();
+                go.store(true, std::memory_order_release);
+                while (nb_popped < nb_total) {
+                    int n = contention->pop_front(chunk_pull.data(), chunk_size);
+                    if (n == 0) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    checksum += chunk_pull[n-1];
+                    nb_popped += n;
+                }
+                elapsed_total[ci].end(0.0f);
+
+                for (auto& producer : producers)
+                    producer.join();
+                for (auto& elapsed : elapsed_producers)
+                    elapsed_push[ci].merge(std::move(elapsed));
+
+                if (checksum <= 0.0)
+                    ok = false;
+            }
+        }
+
+        for (int ci = 0; ci < static_cast<int>(contentions.size()); ++ci) {
+            const auto& segs = elapsed_push[ci].elapsed().segments();
+            std::vector<double> pushes(segs.first.begin(), segs.first.end());
+            pushes.insert(pushes.end(), segs.second.begin(), segs.second.end());
+            double throughput = static_cast<double>(nb_producers)*nb_values/elapsed_total[ci].mean();
+            std::cout << "    " << contentions[ci]->m_name << ":" << std::endl;
+            std::cout << "        throughput: " << acbench::to_string(throughput*1e-6, "%8.2f") << "M values/s" << std::endl;
+            std::cout << "        push: p50=" << acbench::to_string(quantile(pushes, 0.5)*1e6, "%8.2f") << "µs"
+                      << ", p99=" << acbench::to_string(quantile(pushes, 0.99)*1e6, "%8.2f") << "µs"
+                      << ", p99.9=" << acbench::to_string(quantile(pushes, 0.999)*1e6, "%8.2f") << "µs"
+                      << ", max=" << acbench::to_string(elapsed_push[ci].max()*1e6, "%8.2f") << "µs"
+                      << ", #" << pushes.size() << std::endl;
+        }
+    }
+
+    if (!ok)
+        std::cerr << "ERROR: a consumer didn't receive the values pushed." << std::endl;
+
+    for (auto contention : contentions)
+        delete contention;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,221 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+// Benchmark of acbench::delayline (see acbench/delayline.h), compared to a delay line built on acbench::ringbuffer
+// with per-sample push_back/pop_front and operator[] (the naive implementation).
+// Each run writes a block and reads it back with the given delay.
+
+#include <acbench/ringbuffer.h>
+#include <acbench/delayline.h>
+#include <acbench/time_elapsed.h>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <cmath>
+#include <iostream>
+
+#include "../ext/cxxopts/include/cxxopts.hpp"  // TODO(GD) Very slow compilation
+
+typedef acbench::ringbuffer<float, acbench::lock_none> ringbuffer_t;
+typedef acbench::delayline<float, acbench::lock_none> delayline_t;
+
+class Operation {
+ public:
+    std::string m_name;
+    std::function<void()> m_run;
+    acbench::time_elapsed m_elapsed;
+
+    explicit Operation(const std::string& name, const std::function<void()>& run, int nb_iter)
+        : m_name(name)
+        , m_run(run)
+        , m_elapsed(nb_iter+1) {
+    }
+
+    void run() {
+        m_elapsed.start();
+        m_run();
+        m_elapsed.end(0.0f);
+    }
+};
+
+// The naive delay line: full ringbuffer of the same size as delayline's, written one value at a time
+class naive_delayline {
+ public:
+    ringbuffer_t m_buffer;
+
+    void resize_allocation(int delay_max, int block_size_max) {
+        m_buffer.resize_allocation(delay_max + block_size_max + delayline_t::interpolation_margin);
+        m_buffer.push_back(0.0f, m_buffer.size_max());
+    }
+    void write(const float* block, int n) {
+        for (int k = 0; k < n; ++k) {
+            m_buffer.pop_front();
+            m_buffer.push_back(block[k]);
+        }
+    }
+    // The value delayed by delay relative to the k-th value of the last block of n values
+    inline float at(int n, int k, int delay) const {
+        return m_buffer[m_buffer.size() - n + k - delay];
+    }
+};
+
+int main(int argc, char* argv[]) {
+
+    cxxopts::Options options("benchmark_ringbuffers_delayline", "Benchmark acbench::delayline against a naive delay line");
+    options.add_options()
+        ("i,iterations", "Number of iterations.", cxxopts::value<int>()->default_value("10000"))
+        ("b,block_size", "Number of values written and read per iteration.", cxxopts::value<int>()->default_value("64"))
+        ("d,delay_max", "Maximum delay [samples] (the reads are done at delays close to it).", cxxopts::value<int>()->default_value("4800"))
+        ("h,help", "Print usage")
+    ;
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    std::srand(0);
+
+    int nb_iter = result["iterations"].as<int>();
+    int block_size = result["block_size"].as<int>();
+    int delay_max = result["delay_max"].as<int>();
+    std::cout << "#Iterations: " << nb_iter << std::endl;
+    std::cout << "block_size: " << block_size << std::endl;
+    std::cout << "delay_max: " << delay_max << std::endl;
+    std::cout << "instruction set: " << acbench::simd::instruction_set() << std::endl;
+
+    const int delay = delay_max - delay_max/3;
+    const float delay_frac = static_cast<float>(delay) + 0.3f;
+    const int nb_taps = 4;
+    std::vector<int> taps_delays(nb_taps);
+    std::vector<float> taps_gains(nb_taps);
+    for (int j = 0; j < nb_taps; ++j) {
+        taps_delays[j] = (j+1)*delay_max/nb_taps;
+        taps_gains[j] = 1.0f/(j+2);
+    }
+
+    std::vector<float> block(block_size);
+    std::vector<std::string> names = {"integer", "taps", "linear", "cubic", "allpass"};
+    int nb_reads = static_cast<int>(names.size());
+    // One delay line and one output per read and per implementation, so that they are all in the same state
+    std::vector<naive_delayline> naives(nb_reads);
+    std::vector<delayline_t> dls(nb_reads);
+    std::vector<std::vector<float>> outs_naive(nb_reads, std::vector<float>(block_size));
+    std::vector<std::vector<float>> outs_dl(nb_reads, std::vector<float>(block_size));
+    for (int r = 0; r < nb_reads; ++r) {
+        naives[r].resize_allocation(delay_max, block_size);
+        dls[r].resize_allocation(delay_max, block_size);
+    }
+    float state_naive = 0.0f;
+    float state_dl = 0.0f;
+
+    std::vector<Operation*> operations;
+    // integer
+    operations.push_back(new Operation("integer/naive", [&]() {
+        naive_delayline& dl = naives[0];
+        float* out = outs_naive[0].data();
+        dl.write(block.data(), block_size);
+        for (int k = 0; k < block_size; ++k)
+            out[k] = dl.at(block_size, k, delay); }, nb_iter));
+    operations.push_back(new Operation("integer/acbench", [&]() {
+        dls[0].write(block.data(), block_size);
+        dls[0].read(outs_dl[0].data(), block_size, delay); }, nb_iter));
+    // taps
+    operations.push_back(new Operation("taps/naive", [&]() {
+        naive_delayline& dl = naives[1];
+        float* out = outs_naive[1].data();
+        dl.write(block.data(), block_size);
+        for (int k = 0; k < block_size; ++k) {
+            float v = 0.0f;
+            for (int j = 0; j < nb_taps; ++j)
+                v += taps_gains[j]*dl.at(block_size, k, taps_delays[j]);
+            out[k] = v;
+        } }, nb_iter));
+    operations.push_back(new Operation("taps/acbench", [&]() {
+        dls[1].write(block.data(), block_size);
+        dls[1].read_taps(outs_dl[1].data(), block_size, taps_delays.data(), taps_gains.data(), nb_taps); }, nb_iter));
+    // linear
+    operations.push_back(new Operation("linear/naive", [&]() {
+        naive_delayline& dl = naives[2];
+        float* out = outs_naive[2].data();
+        dl.write(block.data(), block_size);
+        int di = static_cast<int>(delay_frac);
+        float frac = delay_frac - di;
+        for (int k = 0; k < block_size; ++k)
+            out[k] = (1.0f-frac)*dl.at(block_size, k, di) + frac*dl.at(block_size, k, di+1); }, nb_iter));
+    operations.push_back(new Operation("linear/acbench", [&]() {
+        dls[2].write(block.data(), block_size);
+        dls[2].read_linear(outs_dl[2].data(), block_size, delay_frac); }, nb_iter));
+    // cubic
+    operations.push_back(new Operation("cubic/naive", [&]() {
+        naive_delayline& dl = naives[3];
+        float* out = outs_naive[3].data();
+        dl.write(block.data(), block_size);
+        int di = static_cast<int>(delay_frac);
+        float d = 1.0f + (delay_frac - di);
+        float h0 = -(d-1)*(d-2)*(d-3)/6;
+        float h1 = d*(d-2)*(d-3)/2;
+        float h2 = -d*(d-1)*(d-3)/2;
+        float h3 = d*(d-1)*(d-2)/6;
+        for (int k = 0; k < block_size; ++k)
+            out[k] = h0*dl.at(block_size, k, di-1) + h1*dl.at(block_size, k, di) + h2*dl.at(block_size, k, di+1) + h3*dl.at(block_size, k, di+2); }, nb_iter));
+    operations.push_back(new Operation("cubic/acbench", [&]() {
+        dls[3].write(block.data(), block_size);
+        dls[3].read_cubic(outs_dl[3].data(), block_size, delay_frac); }, nb_iter));
+    // allpass
+    operations.push_back(new Operation("allpass/naive", [&]() {
+        naive_delayline& dl = naives[4];
+        float* out = outs_naive[4].data();
+        dl.write(block.data(), block_size);
+        int di = static_cast<int>(delay_frac);
+        float frac = delay_frac - di;
+        float a = (1.0f-frac)/(1.0f+frac);
+        for (int k = 0; k < block_size; ++k) {
+            state_naive = a*dl.at(block_size, k, di) + dl.at(block_size, k, di+1) - a*state_naive;
+            out[k] = state_naive;
+        } }, nb_iter));
+    operations.push_back(new Operation("allpass/acbench", [&]() {
+        dls[4].write(block.data(), block_size);
+        dls[4].read_allpass(outs_dl[4].data(), block_size, delay_frac, &state_dl); }, nb_iter));
+
+    std::mt19937 gen(0);
+    std::vector<int> order(operations.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    std::vector<float> max_errors(nb_reads, 0.0f);
+    for (int iter = 0; iter < nb_iter; ++iter) {
+        for (int k = 0; k < block_size; ++k)
+            block[k] = 2.0f*acbench::rand_uniform_continuous_01<float>()-1.0f;
+
+        // Run each operation in a randomized order
+        std::shuffle(order.begin(), order.end(), gen);
+        for (int oi : order)
+            operations[oi]->run();
+
+        for (int r = 0; r < nb_reads; ++r)
+            for (int k = 0; k < block_size; ++k)
+                max_errors[r] = std::max(max_errors[r], std::abs(outs_naive[r][k] - outs_dl[r][k]));
+    }
+
+    for (auto operation : operations) {
+        std::cout << "    " << operation->m_name << ": " << operation->m_elapsed.stats(6)
+                  << ", " << acbench::to_string(operation->m_elapsed.mean()*1e9/block_size, "%5.3f") << "ns/sample" << std::endl;
+    }
+    // The interpolations are computed in a different order, so the results can differ by a few ULPs
+    for (int r = 0; r < nb_reads; ++r)
+        std::cout << "max error " << names[r] << ": " << max_errors[r] << std::endl;
+
+    for (auto operation : operations)
+        delete operation;
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+// Benchmark of handing a full ringbuffer over to another owner (ex. from one pipeline stage to the next),
+// by copying its values (the only way before the move operations) compared to moving or swapping it.
+// Each run hands the buffer over and back, so that the next run starts from the same state.
+
+#include <acbench/ringbuffer.h>
+#include <acbench/time_elapsed.h>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <utility>
+#include <iostream>
+
+#include "../ext/cxxopts/include/cxxopts.hpp"  // TODO(GD) Very slow compilation
+
+typedef acbench::ringbuffer<float, acbench::lock_none> ringbuffer_t;
+
+class Operation {
+ public:
+    std::string m_name;
+    std::function<void()> m_run;
+    acbench::time_elapsed m_elapsed;
+
+    explicit Operation(const std::string& name, const std::function<void()>& run, int nb_iter)
+        : m_name(name)
+        , m_run(run)
+        , m_elapsed(nb_iter+1) {
+    }
+
+    void run() {
+        m_elapsed.start();
+        m_run();
+        m_elapsed.end(0.0f);
+    }
+};
+
+int main(int argc, char* argv[]) {
+
+    cxxopts::Options options("benchmark_ringbuffers_handoff", "Benchmark the hand-off of a full acbench::ringbuffer, by copy vs. by move");
+    options.add_options()
+        ("i,iterations", "Number of iterations.", cxxopts::value<int>()->default_value("100"))
+        ("s,size", "Number of values in the ringbuffer.", cxxopts::value<int>()->default_value("1048576"))
+        ("h,help", "Print usage")
+    ;
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    std::srand(0);
+
+    int nb_iter = result["iterations"].as<int>();
+    int size = result["size"].as<int>();
+    std::cout << "#Iterations: " << nb_iter << std::endl;
+    std::cout << "size: " << size << std::endl;
+
+    // One source per operation, so that they all hand over the same content
+    std::vector<ringbuffer_t> sources(5);
+    for (auto& rb : sources) {
+        rb.resize_allocation(size);
+        for (int n = 0; n < size; ++n)
+            rb.push_back(acbench::rand_uniform_continuous_01<float>());
+    }
+    ringbuffer_t stage;  // The receiving stage, which already has an allocation to copy into
+    stage.resize_allocation(size);
+    // time_elapsed holding size measures
+    acbench::time_elapsed measures(size);
+    for (int n = 0; n < size; ++n) {
+        measures.start();
+        measures.end(0.0f);
+    }
+
+    std::vector<Operation*> operations;
+    // Before: the values are copied into an existing allocation, and back
+    operations.push_back(new Operation("ringbuffer/copy_assign", [&]() {
+        stage = sources[0];
+        sources[0] = stage; }, nb_iter));
+    // Before: a new owner has to allocate and copy (the copy constructor is forbidden)
+    operations.push_back(new Operation("ringbuffer/copy_construct", [&]() {
+        ringbuffer_t next;
+        next.resize_allocation(sources[1].size_max());
+        next.push_back(sources[1]);
+        sources[1] = next; }, nb_iter));
+    // After
+    operations.push_back(new Operation("ringbuffer/move_construct", [&]() {
+        ringbuffer_t next(std::move(sources[2]));
+        sources[2] = std::move(next); }, nb_iter));
+    operations.push_back(new Operation("ringbuffer/swap", [&]() {
+        ringbuffer_t next;
+        next.swap(sources[3]);
+        sources[3].swap(next); }, nb_iter));
+    // std::vector growth, which moves the ringbuffers instead of copying them
+    operations.push_back(new Operation("ringbuffer/vector_grow", [&]() {
+        std::vector<ringbuffer_t> stages;
+        stages.emplace_back(std::move(sources[4]));
+        stages.emplace_back();  // Reallocation of the vector
+        sources[4] = std::move(stages[0]); }, nb_iter));
+    operations.push_back(new Operation("time_elapsed/copy", [&]() {
+        acbench::time_elapsed next(measures);
+        measures = next; }, nb_iter));
+    operations.push_back(new Operation("time_elapsed/move", [&]() {
+        acbench::time_elapsed next(std::move(measures));
+        measures = std::move(next); }, nb_iter));
+
+    std::mt19937 gen(0);
+    std::vector<int> order(operations.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    for (int iter = 0; iter < nb_iter; ++iter) {
+        // Run each operation in a randomized order
+        std::shuffle(order.begin(), order.end(), gen);
+        for (int oi : order)
+            operations[oi]->run();
+    }
+
+    for (auto operation : operations)
+        std::cout << "    " << operation->m_name << ": " << operation->m_elapsed.stats(6) << std::endl;
+
+    bool ok = true;
+    for (auto& rb : sources)
+        ok = ok && (rb.size() == size);
+    ok = ok && (measures.size() == size);
+    if (!ok)
+        std::cerr << "ERROR: a ringbuffer lost its content." << std::endl;
+
+    for (auto operation : operations)
+        delete operation;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+// Benchmark of a large acbench::ringbuffer (ex. a multi-hour recording ring) with the default int size type
+// compared to a 64 bits size type (the SizeType template argument), on the hot paths:
+// chunked push_back/pop_front streaming through the whole allocation, and element-wise reads.
+// Both ringbuffers have the same capacity, so the 64 bits indexing should cost nothing.
+
+#include <acbench/ringbuffer.h>
+#include <acbench/time_elapsed.h>
+
+#include <cstdint>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <iostream>
+
+#include "../ext/cxxopts/include/cxxopts.hpp"  // TODO(GD) Very slow compilation
+
+typedef acbench::ringbuffer<float, acbench::lock_none> ringbuffer32_t;
+typedef acbench::ringbuffer<float, acbench::lock_none, acbench::allocator_new<float>, std::int64_t> ringbuffer64_t;
+
+class Operation {
+ public:
+    std::string m_name;
+    std::function<void()> m_run;
+    acbench::time_elapsed m_elapsed;
+
+    explicit Operation(const std::string& name, const std::function<void()>& run, int nb_iter)
+        : m_name(name)
+        , m_run(run)
+        , m_elapsed(nb_iter+1) {
+    }
+
+    void run() {
+        m_elapsed.start();
+        m_run();
+        m_elapsed.end(0.0f);
+    }
+};
+
+// Half full, with the front in the middle of the allocation
+template<typename ringbuffer_t>
+void fill(ringbuffer_t* prb, std::int64_t size_max) {
+    prb->resize_allocation(size_max);
+    prb->push_back(0.0f, size_max/2);
+    prb->pop_front(size_max/4);
+    prb->push_back(1.0f, size_max/4);
+}
+
+// Pushes then pops nb_chunks chunks, so that the front and the end keep moving through the whole allocation
+template<typename ringbuffer_t>
+void push_pop(ringbuffer_t* prb, const float* chunk_push, float* chunk_pull, int chunk_size, int nb_chunks) {
+    for (int c = 0; c < nb_chunks; ++c) {
+        prb->push_back(chunk_push, chunk_size);
+        prb->pop_front(chunk_pull, chunk_size);
+    }
+}
+
+// Sum of chunk_size values at the given positions, with operator[]
+template<typename ringbuffer_t>
+float read_at(const ringbuffer_t& rb, const std::vector<std::int64_t>& positions, int chunk_size) {
+    float acc = 0.0f;
+    for (std::int64_t pos : positions)
+        for (int k = 0; k < chunk_size; ++k)
+            acc += rb[static_cast<typename ringbuffer_t::size_type>(pos+k)];
+    return acc;
+}
+
+int main(int argc, char* argv[]) {
+
+    cxxopts::Options options("benchmark_ringbuffers_large", "Benchmark a large acbench::ringbuffer with int vs. 64 bits sizes");
+    options.add_options()
+        ("i,iterations", "Number of iterations.", cxxopts::value<int>()->default_value("100"))
+        ("s,size_max", "Capacity of the ringbuffers (at most 2^31-1 for the int one).", cxxopts::value<int>()->default_value("67108864"))
+        ("c,chunk_size", "Number of values per push_back/pop_front.", cxxopts::value<int>()->default_value("512"))
+        ("n,nb_chunks", "Number of chunks per iteration.", cxxopts::value<int>()->default_value("1000"))
+        ("h,help", "Print usage")
+    ;
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    std::srand(0);
+
+    int nb_iter = result["iterations"].as<int>();
+    int size_max = result["size_max"].as<int>();
+    int chunk_size = result["chunk_size"].as<int>();
+    int nb_chunks = result["nb_chunks"].as<int>();
+    std::cout << "#Iterations: " << nb_iter << std::endl;
+    std::cout << "size_max: " << size_max << " (" << acbench::to_string(size_max*sizeof(float)/1e6, "%.1f") << "MB)" << std::endl;
+    std::cout << "chunk_size: " << chunk_size << std::endl;
+    std::cout << "nb_chunks: " << nb_chunks << std::endl;
+
+    ringbuffer32_t rb32;
+    ringbuffer64_t rb64;
+    fill(&rb32, size_max);
+    fill(&rb64, size_max);
+
+    std::vector<float> chunk(chunk_size);
+    std::vector<float> chunk_pull(chunk_size);
+    for (int k = 0; k < chunk_size; ++k)
+        chunk[k] = acbench::rand_uniform_continuous_01<float>();
+
+    // Random positions over the whole content, drawn again at each iteration
+    std::mt19937 gen(0);
+    std::vector<std::int64_t> positions(nb_chunks);
+    float acc32 = 0.0f;
+    float acc64 = 0.0f;
+
+    std::vector<Operation*> operations;
+    operations.push_back(new Operation("push_pop/int", [&]() {
+        push_pop(&rb32, chunk.data(), chunk_pull.data(), chunk_size, nb_chunks); }, nb_iter));
+    operations.push_back(new Operation("push_pop/int64", [&]() {
+        push_pop(&rb64, chunk.data(), chunk_pull.data(), chunk_size, nb_chunks); }, nb_iter));
+    operations.push_back(new Operation("operator[]/int", [&]() {
+        acc32 += read_at(rb32, positions, chunk_size); }, nb_iter));
+    operations.push_back(new Operation("operator[]/int64", [&]() {
+        acc64 += read_at(rb64, positions, chunk_size); }, nb_iter));
+
+    std::vector<int> order(operations.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    for (int iter = 0; iter < nb_iter; ++iter) {
+        std::uniform_int_distribution<std::int64_t> dist(0, rb32.size()-chunk_size);
+        for (auto& pos : positions)
+            pos = dist(gen);
+
+        // Run each operation in a randomized order
+        std::shuffle(order.begin(), order.end(), gen);
+        for (int oi : order)
+            operations[oi]->run();
+    }
+
+    for (auto operation : operations) {
+        std::cout << "    " << operation->m_name << ": " << operation->m_elapsed.stats(6)
+                  << ", " << acbench::to_string(operation->m_elapsed.mean()*1e9/(static_cast<double>(chunk_size)*nb_chunks), "%5.3f") << "ns/sample" << std::endl;
+    }
+    // The reads depend on the order of the operations, only their sums are printed (so that they can't be optimized out)
+    std::cout << "sums of the reads: " << acc32 << " and " << acc64 << std::endl;
+    if (!acbench::compare(rb32, rb64))
+        std::cerr << "ERROR: the int and int64 ringbuffers differ." << std::endl;
+
+    for (auto operation : operations)
+        delete operation;
+
+    return 0;
+}
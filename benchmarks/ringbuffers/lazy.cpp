@@ -0,0 +1,182 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+// Benchmark of the construction and first fill of large ringbuffers of which only the beginning is used
+// (ex. the two 1M-values ringbuffers of each acbench::time_elapsed, of which a benchmark usually fills a few thousands),
+// allocated with new[] (allocator_new) compared to commit-on-demand (allocator_lazy, see acbench/allocators.h).
+// Each run constructs the ringbuffers, pushes the first values in each of them, fills them up, and destroys them.
+
+#include <acbench/ringbuffer.h>
+#include <acbench/allocators.h>
+#include <acbench/time_elapsed.h>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <fstream>
+#include <iostream>
+
+#include "../ext/cxxopts/include/cxxopts.hpp"  // TODO(GD) Very slow compilation
+
+// Resident memory of the process [MB] (Linux only, 0 otherwise)
+static double resident_mb() {
+    #if defined(__linux__)
+        std::ifstream statm("/proc/self/statm");
+        double size = 0.0, resident = 0.0;
+        statm >> size >> resident;
+        return resident*4096.0/(1024.0*1024.0);
+    #else
+        return 0.0;
+    #endif
+}
+
+class Lazy {
+ public:
+    std::string m_name;
+    acbench::time_elapsed m_elapsed_construct;
+    acbench::time_elapsed m_elapsed_first_fill;
+    acbench::time_elapsed m_elapsed_full_fill;
+    acbench::time_elapsed m_elapsed_destroy;
+    double m_resident_first_fill = 0.0;  // Resident memory added by the construction and the first fill [MB]
+    double m_resident_full_fill = 0.0;   // Resident memory added by the construction and the full fill [MB]
+    double m_checksum = 0.0;
+
+    explicit Lazy(const std::string& name, int nb_iter)
+        : m_name(name)
+        , m_elapsed_construct(nb_iter+1)
+        , m_elapsed_first_fill(nb_iter+1)
+        , m_elapsed_full_fill(nb_iter+1)
+        , m_elapsed_destroy(nb_iter+1) {
+    }
+    virtual ~Lazy() {}
+
+    virtual void construct(int nb_buffers, int size_max) = 0;
+    virtual void fill(int nb_values) = 0;
+    virtual void destroy() = 0;
+
+    void run(int nb_buffers, int size_max, int nb_first) {
+        double resident_start = resident_mb();
+
+        m_elapsed_construct.start();
+        construct(nb_buffers, size_max);
+        m_elapsed_construct.end(0.0f);
+
+        m_elapsed_first_fill.start();
+        fill(nb_first);
+        m_elapsed_first_fill.end(0.0f);
+        m_resident_first_fill = resident_mb() - resident_start;
+
+        m_elapsed_full_fill.start();
+        fill(size_max - nb_first);
+        m_elapsed_full_fill.end(0.0f);
+        m_resident_full_fill = resident_mb() - resident_start;
+
+        m_elapsed_destroy.start();
+        destroy();
+        m_elapsed_destroy.end(0.0f);
+    }
+};
+
+template<typename Allocator>
+class LazyAllocator : public Lazy {
+ public:
+    typedef acbench::ringbuffer<double, acbench::lock_none, Allocator> ringbuffer_t;
+    std::vector<ringbuffer_t> m_buffers;
+
+    explicit LazyAllocator(const std::string& name, int nb_iter)
+        : Lazy(name, nb_iter) {
+    }
+
+    void construct(int nb_buffers, int size_max) override {
+        m_buffers.resize(nb_buffers);
+        for (auto& rb : m_buffers)
+            rb.resize_allocation(size_max);
+    }
+    // One value at a time, as time_elapsed::end(.) does
+    void fill(int nb_values) override {
+        for (auto& rb : m_buffers) {
+            for (int n = 0; n < nb_values; ++n)
+                rb.push_back(static_cast<double>(n));
+            m_checksum += rb.back();
+        }
+    }
+    void destroy() override {
+        std::vector<ringbuffer_t>().swap(m_buffers);
+    }
+};
+
+int main(int argc, char* argv[]) {
+
+    cxxopts::Options options("benchmark_ringbuffers_lazy", "Benchmark the construction and first fill of large acbench::ringbuffer, with new[] vs. commit-on-demand allocation");
+    options.add_options()
+        ("i,iterations", "Number of iterations.", cxxopts::value<int>()->default_value("20"))
+        ("n,nb_buffers", "Number of ringbuffers constructed per iteration (2 per time_elapsed).", cxxopts::value<int>()->default_value("32"))
+        ("s,size_max", "Capacity of each ringbuffer.", cxxopts::value<int>()->default_value("1000000"))
+        ("f,first", "Number of values of the first fill (ex. the number of measures of a benchmark).", cxxopts::value<int>()->default_value("1000"))
+        ("h,help", "Print usage")
+    ;
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    std::srand(0);
+
+    int nb_iter = result["iterations"].as<int>();
+    int nb_buffers = result["nb_buffers"].as<int>();
+    int size_max = result["size_max"].as<int>();
+    int nb_first = std::min(result["first"].as<int>(), size_max);
+    std::cout << "#Iterations: " << nb_iter << std::endl;
+    std::cout << "nb_buffers: " << nb_buffers << std::endl;
+    std::cout << "size_max: " << size_max << std::endl;
+    std::cout << "first: " << nb_first << std::endl;
+
+    std::vector<Lazy*> lazies;
+    lazies.push_back(new LazyAllocator<acbench::allocator_new<double>>("new", nb_iter));
+    lazies.push_back(new LazyAllocator<acbench::allocator_lazy<double>>("lazy", nb_iter));
+
+    std::mt19937 gen(0);
+    std::vector<int> order(lazies.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    for (int iter = 0; iter < nb_iter; ++iter) {
+        // Run each allocation policy in a randomized order
+        std::shuffle(order.begin(), order.end(), gen);
+        for (int li : order)
+            lazies[li]->run(nb_buffers, size_max, nb_first);
+    }
+
+    for (auto lazy : lazies) {
+        std::cout << "    " << lazy->m_name << ":" << std::endl;
+        std::cout << "        construct:  " << lazy->m_elapsed_construct.stats(6) << std::endl;
+        std::cout << "        first fill: " << lazy->m_elapsed_first_fill.stats(6)
+                  << ", resident +" << acbench::to_string(lazy->m_resident_first_fill, "%.1f") << "MB" << std::endl;
+        std::cout << "        full fill:  " << lazy->m_elapsed_full_fill.stats(6)
+                  << ", resident +" << acbench::to_string(lazy->m_resident_full_fill, "%.1f") << "MB" << std::endl;
+        std::cout << "        destroy:    " << lazy->m_elapsed_destroy.stats(6) << std::endl;
+    }
+    for (auto lazy : lazies)
+        std::cout << "checksum " << lazy->m_name << ": " << lazy->m_checksum << std::endl;
+
+    // The construction of time_elapsed itself, which uses allocator_lazy
+    acbench::time_elapsed elapsed_time_elapsed(nb_iter+1);
+    for (int iter = 0; iter < nb_iter; ++iter) {
+        elapsed_time_elapsed.start();
+        acbench::time_elapsed te;
+        elapsed_time_elapsed.end(0.0f);
+    }
+    std::cout << "time_elapsed construction: " << elapsed_time_elapsed.stats(6) << std::endl;
+
+    for (auto lazy : lazies)
+        delete lazy;
+
+    return 0;
+}
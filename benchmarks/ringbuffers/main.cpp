@@ -8,8 +8,184 @@
 
 #include "methods.h"
 
+#include <chrono>
+#if defined(__linux__)
+#include <pthread.h>  // For pthread_setaffinity_np(.)
+#include <unistd.h>   // For sysconf(.)
+#endif
+
 #include "../ext/cxxopts/include/cxxopts.hpp"  // TODO(GD) Very slow compilation
 
+// Scenario: convert, for one sample format
+template<typename S>
+void run_convert(const std::string& format, int chunk_size_max, int nb_iter, int nb_repeat) {
+    std::cout << "INFO: format=" << format << std::endl;
+    std::vector<MethodConvert<S>*> convmethods;
+    convmethods.push_back(new MethodConvertThenCopy<S>(chunk_size_max, nb_repeat));
+    convmethods.push_back(new MethodConverting<S>(chunk_size_max, nb_repeat));
+
+    std::vector<int> convmethodorder(convmethods.size());
+    std::iota(convmethodorder.begin(), convmethodorder.end(), 0);
+
+    // Random floats in [-1, 1), converted once to the sample format
+    std::vector<float> chunk_float(chunk_size_max);
+    std::vector<S> chunk_push(chunk_size_max);
+    std::vector<S> chunk_pull(chunk_size_max);
+
+    for (int chunk_size = 1; chunk_size <= chunk_size_max; chunk_size = static_cast<int>(1+chunk_size*1.1)) {
+        std::cout << "INFO: chunk_size=" << chunk_size << std::endl;
+        for (int iter=0; iter < nb_iter; ++iter) {
+            for (int n=0; n < chunk_size; ++n)
+                chunk_float[n] = 2.0f*acbench::rand_uniform_continuous_01<float>()-1.0f;
+            acbench::convert_samples(chunk_push.data(), chunk_float.data(), chunk_size);
+
+            // Run each method in a randomized order
+            std::random_shuffle(convmethodorder.begin(), convmethodorder.end());
+            for (int mi=0; mi < static_cast<int>(convmethods.size()); ++mi)
+                convmethods[convmethodorder[mi]]->run_push_pull(chunk_push.data(), chunk_size, chunk_pull.data(), chunk_size);
+        }
+
+        for (auto pmethod : convmethods) {
+            pmethod->write_file("convert_"+format+"_"+acbench::to_string<int>(chunk_size, "%i"));
+            pmethod->m_elapsed.reset();
+        }
+    }
+
+    for (auto pmethod : convmethods)
+        pmethod->compare(*convmethods[0]);
+
+    for (auto pmethod : convmethods)
+        delete pmethod;
+}
+
+// Pins the thread on the given core, if the system has it (Linux only)
+static void pin_thread(std::thread* pthread, int core) {
+    #if defined(__linux__)
+        int nb_cores = static_cast<int>(std::thread::hardware_concurrency());
+        if (nb_cores > 0)
+            core = core % nb_cores;
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(core, &cpuset);
+        if (pthread_setaffinity_np(pthread->native_handle(), sizeof(cpu_set_t), &cpuset) != 0)
+            std::cerr << "WARNING: Could not pin the thread on core " << core << std::endl;
+    #else
+        (void)pthread;
+        (void)core;
+    #endif
+}
+
+// Evicts the ringbuffers, the chunks and the code from the caches, by writing over a buffer larger than the last level cache
+class CacheEvicter {
+ public:
+    std::vector<char> m_buffer;
+
+    explicit CacheEvicter(std::size_t size)
+        : m_buffer(size) {
+    }
+
+    //! Size of the last level cache [bytes], or a default size if it can't be retrieved
+    static std::size_t llc_size() {
+        #if defined(__linux__) && defined(_SC_LEVEL3_CACHE_SIZE)
+            long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+            if (size > 0)
+                return static_cast<std::size_t>(size);
+        #endif
+        return 32*1024*1024;
+    }
+
+    void evict() {
+        for (std::size_t i=0; i < m_buffer.size(); i += 64)
+            m_buffer[i] += 1;  // One write per cache line
+    }
+};
+
+// Scenario: threads, for one method
+// A producer thread pushes nb_chunks chunks of chunk_size values while a consumer thread pulls them, each on its own core.
+// If paced, the producer pushes a chunk only once the previous one has been pulled, so that the latencies are the
+// hand-over times only (otherwise the queueing time in the ringbuffer is included).
+// Returns the duration of the run [s], and the latency of each chunk from its push to its pull in latencies [s].
+static double run_threads(Method* pmethod, int chunk_size, int nb_chunks, bool paced, std::vector<float>* latencies, int* nb_errors) {
+    typedef std::chrono::steady_clock clock_type;
+    std::vector<clock_type::time_point> push_times(nb_chunks);
+    std::atomic<int> nb_pulled(0);
+    latencies->resize(nb_chunks);
+    *nb_errors = 0;
+
+    clock_type::time_point start = clock_type::now();
+
+    std::thread producer([&]() {
+        std::vector<float> chunk(chunk_size);
+        for (int k = 0; k < nb_chunks; ++k) {
+            std::fill(chunk.begin(), chunk.end(), static_cast<float>(k));
+            if (paced) {
+                while (nb_pulled.load(std::memory_order_acquire) < k)
+                    std::this_thread::yield();
+            }
+            push_times[k] = clock_type::now();  // Published to the consumer by the push
+            while (!pmethod->push_threaded(chunk.data(), chunk_size))
+                std::this_thread::yield();
+        }
+    });
+    std::thread consumer([&]() {
+        std::vector<float> chunk(chunk_size);
+        for (int k = 0; k < nb_chunks; ++k) {
+            while (!pmethod->pull_threaded(chunk.data(), chunk_size))
+                std::this_thread::yield();
+            std::chrono::duration<double> latency = clock_type::now() - push_times[k];
+            (*latencies)[k] = static_cast<float>(latency.count());
+            if (!pmethod->compare_threaded(chunk.data(), chunk_size, static_cast<float>(k)))
+                ++(*nb_errors);
+            nb_pulled.store(k+1, std::memory_order_release);
+        }
+    });
+    pin_thread(&producer, 0);
+    pin_thread(&consumer, 1);
+
+    producer.join();
+    consumer.join();
+
+    std::chrono::duration<double> elapsed = clock_type::now() - start;
+    return elapsed.count();
+}
+
+// Scenario: callback, for one method
+// A timer thread wakes up every period, as an audio callback would, and pushes then pulls one block of block_size values.
+// The ringbuffer is prefilled with a few blocks, as the FIFO between an audio device and the processing would be.
+// Each callback is measured from its scheduled wake-up time to its completion (so including the wake-up latency)
+// in *pelapsed, whose deadline is the period.
+static void run_callback(Method* pmethod, int block_size, int nb_callbacks, double period, acbench::time_elapsed* pelapsed) {
+    typedef std::chrono::high_resolution_clock clock_type;
+    const int nb_blocks_prefill = 4;
+    std::vector<float> block_push(block_size);
+    for (int n=0; n < block_size; ++n)
+        block_push[n] = acbench::rand_uniform_continuous_01<float>();
+    std::vector<float> block_pull(block_size);
+
+    pmethod->clear();
+    for (int b=0; b < nb_blocks_prefill; ++b)
+        pmethod->push_threaded(block_push.data(), block_size);
+
+    pelapsed->reset();
+    pelapsed->set_deadline(period);
+    std::thread timer([&]() {
+        clock_type::duration period_duration = std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(period));
+        clock_type::time_point wake = clock_type::now() + period_duration;
+        for (int c = 0; c < nb_callbacks; ++c) {
+            std::this_thread::sleep_until(wake);
+            pelapsed->start(wake);
+            pmethod->push_threaded(block_push.data(), block_size);
+            pmethod->pull_threaded(block_pull.data(), block_size);
+            pelapsed->end(static_cast<float>(period));
+            wake += period_duration;  // Late callbacks don't shift the next ones
+        }
+    });
+    pin_thread(&timer, 0);
+    timer.join();
+
+    pmethod->clear();
+}
+
 int main(int argc, char* argv[]) {
 
     cxxopts::Options options("benchmark_ringbuffers", "Benchmark ringbuffers types");
@@ -17,6 +193,9 @@ int main(int argc, char* argv[]) {
         ("i,iterations", "Number of total iteration for each chunk size.", cxxopts::value<int>()->default_value("100"))
         ("c,chunk_size_max", "Max chunk size.", cxxopts::value<int>()->default_value("8192"))
         ("r,nb_repeat", "Number of repetition of each instruction, to increase measure accuracy.", cxxopts::value<int>()->default_value("100"))
+        ("cold", "Evict the caches before each measurement, with nb_repeat=1, and run the push_back_array, push_pull_array, push_pull_block and push_pull_inplace scenarios only (results tagged cold_).")
+        ("counters", "Sample the hardware counters (cycles, instructions, L1/LLC misses, branch misses, Linux only) of the push_back_array, push_pull_array, push_pull_block and push_pull_inplace scenarios, written next to the durations (ex. ACBench_push_pull_array_64_cycles.bin).")
+        ("cold_size", "Size of the buffer written over to evict the caches [MB] (default: twice the last level cache).", cxxopts::value<int>()->default_value("0"))
         ("h,help", "Print usage")
     ;
     auto result = options.parse(argc, argv);
@@ -35,6 +214,18 @@ int main(int argc, char* argv[]) {
     int nb_repeat = result["nb_repeat"].as<int>();
     std::cout << "chunk_size_max: " << chunk_size_max << std::endl;
 
+    // With cold caches, only the first repetition would be cold, so measure each instruction once
+    bool cold = result.count("cold") > 0;
+    std::string tag_prefix = cold ? "cold_" : "";
+    std::size_t cold_size = static_cast<std::size_t>(result["cold_size"].as<int>())*1024*1024;
+    if (cold_size == 0)
+        cold_size = 2*CacheEvicter::llc_size();
+    CacheEvicter evicter(cold ? cold_size : 0);
+    if (cold) {
+        nb_repeat = 1;
+        std::cout << "cold: evicting " << cold_size/(1024*1024) << "MB before each measurement, nb_repeat=1" << std::endl;
+    }
+
     std::vector<Method*> methods;
     methods.push_back(new MethodFastestBound(chunk_size_max, nb_repeat));
     methods.push_back(new MethodSTL(chunk_size_max, nb_repeat));
@@ -43,7 +234,34 @@ int main(int argc, char* argv[]) {
     methods.push_back(new MethodPortaudio(chunk_size_max, nb_repeat));
     methods.push_back(new MethodRubberBand(chunk_size_max, nb_repeat));
     methods.push_back(new MethodJack(chunk_size_max, nb_repeat));
-    methods.push_back(new MethodACBench(chunk_size_max, nb_repeat));
+    methods.push_back(new MethodACBench<>(chunk_size_max, nb_repeat));
+    methods.push_back(new MethodACBench<acbench::lock_none>(chunk_size_max, nb_repeat, "ACBenchNoLock"));
+    methods.push_back(new MethodACBench<acbench::lock_spinlock>(chunk_size_max, nb_repeat, "ACBenchSpinlock"));
+    // Block sizes known at compile time, to compare with ACBenchNoLock
+    methods.push_back(new MethodACBenchBlock<acbench::lock_none>(chunk_size_max, nb_repeat));
+    // Allocation policies, to compare with ACBenchNoLock
+    // (the huge pages threshold is lowered so that the buffer is mapped whatever chunk_size_max)
+    methods.push_back(new MethodACBench<acbench::lock_none, acbench::allocator_aligned<float>>(chunk_size_max, nb_repeat, "ACBenchAligned"));
+    methods.push_back(new MethodACBench<acbench::lock_none, acbench::allocator_hugepage<float, 1>>(chunk_size_max, nb_repeat, "ACBenchHugePages"));
+    methods.push_back(new MethodACBench<acbench::lock_none, acbench::allocator_mlock<float>>(chunk_size_max, nb_repeat, "ACBenchMlock"));
+    // The capacity of static_ringbuffer is fixed at compile time, to compare with ACBenchNoLock
+    if (chunk_size_max <= 8192)
+        methods.push_back(new MethodACBenchStatic<8192>(chunk_size_max, nb_repeat));
+    else
+        std::cout << "WARNING: ACBenchStatic skipped, chunk_size_max is bigger than its capacity (8192)" << std::endl;
+    methods.push_back(new MethodACBenchSPSC(chunk_size_max, nb_repeat));
+    #if defined(__linux__)
+        methods.push_back(new MethodACBenchMirrored(chunk_size_max, nb_repeat));
+    #endif
+
+    if (result.count("counters")) {
+        for (auto pmethod : methods) {
+            if (!pmethod->m_elapsed.enable_counters()) {
+                std::cout << "WARNING: The hardware counters are not available (see /proc/sys/kernel/perf_event_paranoid), only the durations are measured." << std::endl;
+                break;
+            }
+        }
+    }
 
     std::random_device rd;  // a seed source for the random number engine
     // std::mt19937 gen(rd());
@@ -64,6 +282,8 @@ int main(int argc, char* argv[]) {
             // Run each method in a randomized order
             std::random_shuffle(methodorder.begin(), methodorder.end());
             for (int mi=0; mi < static_cast<int>(methods.size()); ++mi) {
+                if (cold)
+                    evicter.evict();
                 methods[methodorder[mi]]->run_push_back_array(chunk_push, chunk_size);
             }
 
@@ -71,7 +291,7 @@ int main(int argc, char* argv[]) {
         }
 
         for (auto pmethod : methods) {
-            pmethod->write_file("push_back_array_"+acbench::to_string<int>(chunk_size, "%i"));
+            pmethod->write_file(tag_prefix+"push_back_array_"+acbench::to_string<int>(chunk_size, "%i"));
             // std::cout << pmethod->m_name << ": " << pmethod->m_elapsed.stats(9) << std::endl;
             pmethod->m_elapsed.reset();
         }
@@ -98,6 +318,8 @@ int main(int argc, char* argv[]) {
             // Run each method in a randomized order
             std::random_shuffle(methodorder.begin(), methodorder.end());
             for (int mi=0; mi < static_cast<int>(methods.size()); ++mi) {
+                if (cold)
+                    evicter.evict();
                 methods[methodorder[mi]]->run_push_pull_array(chunk_push, chunk_push_size, chunk_pull, chunk_pull_size);
             }
 
@@ -106,7 +328,7 @@ int main(int argc, char* argv[]) {
         }
 
         for (auto pmethod : methods) {
-            pmethod->write_file("push_pull_array_"+acbench::to_string<int>(chunk_size, "%i"));
+            pmethod->write_file(tag_prefix+"push_pull_array_"+acbench::to_string<int>(chunk_size, "%i"));
             // std::cout << pmethod->m_name << ": " << pmethod->m_elapsed.stats(9) << std::endl;
             pmethod->m_elapsed.reset();
         }
@@ -116,6 +338,361 @@ int main(int argc, char* argv[]) {
         pmethod->compare(arr_ref);
 
 
+    // Scenario: push_pull_block ------------------------------------------
+    // Same as push_pull_array, for the usual block sizes only (which ACBenchBlock knows at compile time).
+    for (auto pmethod : methods)
+        pmethod->clear();
+
+    for (int chunk_size : {32, 64, 128, 256, 512}) {
+        if (chunk_size > chunk_size_max)
+            break;
+        std::cout << "INFO: chunk_size=" << chunk_size << std::endl;
+        for (int iter=0; iter < nb_iter; ++iter) {
+            float* chunk_push = new float[chunk_size];
+            for (int n=0; n < chunk_size; ++n)
+                chunk_push[n] = acbench::rand_uniform_continuous_01<float>();
+            float* chunk_pull = new float[chunk_size];
+
+            // Run each method in a randomized order
+            std::random_shuffle(methodorder.begin(), methodorder.end());
+            for (int mi=0; mi < static_cast<int>(methods.size()); ++mi) {
+                if (cold)
+                    evicter.evict();
+                methods[methodorder[mi]]->run_push_pull_array(chunk_push, chunk_size, chunk_pull, chunk_size);
+            }
+
+            delete[] chunk_push;
+            delete[] chunk_pull;
+        }
+
+        for (auto pmethod : methods) {
+            pmethod->write_file(tag_prefix+"push_pull_block_"+acbench::to_string<int>(chunk_size, "%i"));
+            pmethod->m_elapsed.reset();
+        }
+    }
+
+    for (auto pmethod : methods)
+        pmethod->compare(arr_ref);
+
+
+    // Scenario: push_pull_inplace ----------------------------------------
+    for (auto pmethod : methods)
+        pmethod->clear();
+
+    for (int chunk_size = 1; chunk_size <= chunk_size_max; chunk_size = static_cast<int>(1+chunk_size*1.1)) {
+        std::cout << "INFO: chunk_size=" << chunk_size << std::endl;
+        int chunk_push_size = chunk_size;
+        int chunk_pull_size = chunk_size;
+        for (int iter=0; iter < nb_iter; ++iter) {
+            float* chunk_push = new float[chunk_push_size];
+            for (int n=0; n < chunk_push_size; ++n)
+                chunk_push[n] = acbench::rand_uniform_continuous_01<float>();
+            float* chunk_pull = new float[chunk_pull_size];
+
+            // Run each method in a randomized order
+            std::random_shuffle(methodorder.begin(), methodorder.end());
+            for (int mi=0; mi < static_cast<int>(methods.size()); ++mi) {
+                if (cold)
+                    evicter.evict();
+                methods[methodorder[mi]]->run_push_pull_inplace(chunk_push, chunk_push_size, chunk_pull, chunk_pull_size);
+            }
+
+            delete[] chunk_push;
+            delete[] chunk_pull;
+        }
+
+        for (auto pmethod : methods) {
+            pmethod->write_file(tag_prefix+"push_pull_inplace_"+acbench::to_string<int>(chunk_size, "%i"));
+            pmethod->m_elapsed.reset();
+        }
+    }
+
+    for (auto pmethod : methods)
+        pmethod->compare(arr_ref);
+
+    if (cold)  // The other scenarios are measured with hot caches only (the callback scenario is cold by design)
+        return 0;
+
+
+    // Scenario: threads ----------------------------------------------------
+    // A producer thread and a consumer thread, on two different cores (see run_threads(.)).
+    // The throughput is measured with the producer pushing as fast as possible,
+    // and the latencies with the producer pushing each chunk once the previous one has been pulled.
+    for (auto pmethod : methods)
+        pmethod->clear();
+
+    if (std::thread::hardware_concurrency() < 2)
+        std::cout << "WARNING: Less than 2 cores, the producer and the consumer of the threads scenario share the same core." << std::endl;
+
+    for (int chunk_size : {64, 512}) {
+        if (chunk_size > chunk_size_max)
+            break;
+        std::cout << "INFO: chunk_size=" << chunk_size << std::endl;
+        int nb_chunks = nb_iter*nb_repeat;
+        std::vector<double> durations(methods.size(), 0.0);
+        std::vector<std::vector<float>> latencies(methods.size());
+        std::vector<float> latencies_throughput;
+        for (int pass=0; pass < 2; ++pass) {
+            bool paced = (pass == 1);
+            // Run each method in a randomized order
+            std::random_shuffle(methodorder.begin(), methodorder.end());
+            for (int mi=0; mi < static_cast<int>(methods.size()); ++mi) {
+                Method* pmethod = methods[methodorder[mi]];
+                int nb_errors = 0;
+                if (paced) {
+                    run_threads(pmethod, chunk_size, nb_chunks, true, &latencies[methodorder[mi]], &nb_errors);
+                } else {
+                    durations[methodorder[mi]] = run_threads(pmethod, chunk_size, nb_chunks, false, &latencies_throughput, &nb_errors);
+                }
+                if (nb_errors > 0)
+                    std::cerr << "ERROR: " << pmethod->m_name << ": " << nb_errors << " chunks pulled with wrong values in the threads scenario." << std::endl;
+            }
+        }
+
+        for (int mi=0; mi < static_cast<int>(methods.size()); ++mi) {
+            std::string tag = "threads_"+acbench::to_string<int>(chunk_size, "%i");
+            float throughput = static_cast<float>(static_cast<double>(nb_chunks)*chunk_size/durations[mi]);  // [values/s]
+            std::ofstream fh_throughput(methods[mi]->m_name+"_"+tag+"_throughput.bin", std::ios_base::binary);
+            fh_throughput.write((char*)&throughput, sizeof(throughput));
+            std::ofstream fh_latency(methods[mi]->m_name+"_"+tag+"_latency.bin", std::ios_base::binary);
+            fh_latency.write((char*)latencies[mi].data(), latencies[mi].size()*sizeof(float));
+            std::vector<float> sorted(latencies[mi]);
+            std::sort(sorted.begin(), sorted.end());
+            std::cout << "    " << methods[mi]->m_name << ": throughput=" << acbench::to_string(throughput*1e-6, "%8.2f") << "M values/s"
+                      << ", latency median=" << acbench::to_string(sorted[sorted.size()/2]*1e6, "%7.2f") << "µs"
+                      << ", p99=" << acbench::to_string(sorted[static_cast<std::size_t>(0.99*(sorted.size()-1))]*1e6, "%7.2f") << "µs" << std::endl;
+        }
+    }
+
+
+    // Scenario: callback --------------------------------------------------
+    // Each method driven by a periodic timer thread at the period of audio blocks at 48kHz (see run_callback(.)),
+    // while a background thread keeps writing over a buffer larger than the last level cache, so that
+    // the ringbuffers and the code are evicted from the caches between the callbacks.
+    {
+        const double sampling_rate = 48000.0;
+        const int nb_callbacks = 4*nb_iter;
+
+        std::atomic<bool> polluting(true);
+        std::vector<char> pollution(64*1024*1024);
+        std::thread polluter([&]() {
+            while (polluting.load(std::memory_order_relaxed)) {
+                for (std::size_t i=0; i < pollution.size(); i += 64)
+                    pollution[i] += 1;  // One write per cache line
+            }
+        });
+        pin_thread(&polluter, 1);
+
+        for (int block_size : {64, 256}) {
+            if (block_size > chunk_size_max)
+                break;
+            double period = block_size/sampling_rate;
+            std::cout << "INFO: block_size=" << block_size << " (period=" << acbench::to_string(period*1e3, "%.2f") << "ms)" << std::endl;
+            std::vector<acbench::time_elapsed> elapseds(methods.size(), acbench::time_elapsed(nb_callbacks+1));
+
+            // Run each method in a randomized order
+            std::random_shuffle(methodorder.begin(), methodorder.end());
+            for (int mi=0; mi < static_cast<int>(methods.size()); ++mi)
+                run_callback(methods[methodorder[mi]], block_size, nb_callbacks, period, &elapseds[methodorder[mi]]);
+
+            for (int mi=0; mi < static_cast<int>(methods.size()); ++mi) {
+                std::cout << "    " << methods[mi]->m_name << ": " << elapseds[mi].stats(6) << std::endl;
+                write_elapsed(methods[mi]->m_name, "callback_"+acbench::to_string<int>(block_size, "%i"), elapseds[mi], 1);
+            }
+        }
+
+        polluting.store(false, std::memory_order_relaxed);
+        polluter.join();
+    }
+
+
+    // Scenario: multichannel ---------------------------------------------
+    for (int nb_channels : {2, 8, 64}) {
+        std::cout << "INFO: nb_channels=" << nb_channels << std::endl;
+        std::vector<MethodMultichannel*> mcmethods;
+        mcmethods.push_back(new MethodMultichannelACBench(nb_channels, chunk_size_max, nb_repeat));
+        mcmethods.push_back(new MethodMultichannelACBenchLayout(acbench::channel_layout::planar, nb_channels, chunk_size_max, nb_repeat));
+        mcmethods.push_back(new MethodMultichannelACBenchLayout(acbench::channel_layout::interleaved, nb_channels, chunk_size_max, nb_repeat));
+
+        std::vector<int> mcmethodorder(mcmethods.size());
+        std::iota(mcmethodorder.begin(), mcmethodorder.end(), 0);
+
+        std::vector<std::vector<float>> chunks_push(nb_channels, std::vector<float>(chunk_size_max));
+        std::vector<std::vector<float>> chunks_pull(nb_channels, std::vector<float>(chunk_size_max));
+        std::vector<float*> pchunks_push(nb_channels);
+        std::vector<float*> pchunks_pull(nb_channels);
+        for (int c = 0; c < nb_channels; ++c) {
+            pchunks_push[c] = chunks_push[c].data();
+            pchunks_pull[c] = chunks_pull[c].data();
+        }
+
+        for (int chunk_size = 1; chunk_size <= chunk_size_max; chunk_size = static_cast<int>(1+chunk_size*1.1)) {
+            std::cout << "INFO: chunk_size=" << chunk_size << std::endl;
+            for (int iter=0; iter < nb_iter; ++iter) {
+                for (int c = 0; c < nb_channels; ++c)
+                    for (int n=0; n < chunk_size; ++n)
+                        chunks_push[c][n] = acbench::rand_uniform_continuous_01<float>();
+
+                // Run each method in a randomized order
+                std::random_shuffle(mcmethodorder.begin(), mcmethodorder.end());
+                for (int mi=0; mi < static_cast<int>(mcmethods.size()); ++mi)
+                    mcmethods[mcmethodorder[mi]]->run_push_pull(pchunks_push.data(), chunk_size, pchunks_pull.data(), chunk_size);
+            }
+
+            for (auto pmethod : mcmethods) {
+                pmethod->write_file("multichannel"+acbench::to_string<int>(nb_channels, "%i")+"_"+acbench::to_string<int>(chunk_size, "%i"));
+                pmethod->m_elapsed.reset();
+            }
+        }
+
+        for (auto pmethod : mcmethods)
+            pmethod->compare(*mcmethods[0]);
+
+        for (auto pmethod : mcmethods)
+            delete pmethod;
+    }
+
+
+    // Scenario: stft -----------------------------------------------------
+    // Frames of frame_len values with an overlap of 75%, the input being pushed by chunks of any size.
+    for (int frame_len : {256, 1024, 4096}) {
+        int hop = frame_len/4;
+        std::cout << "INFO: frame_len=" << frame_len << " hop=" << hop << std::endl;
+        std::vector<MethodSTFT*> stftmethods;
+        stftmethods.push_back(new MethodSTFTACBenchOperator(frame_len, hop, chunk_size_max, nb_repeat));
+        stftmethods.push_back(new MethodSTFTACBenchFrames(frame_len, hop, chunk_size_max, nb_repeat));
+
+        std::vector<int> stftmethodorder(stftmethods.size());
+        std::iota(stftmethodorder.begin(), stftmethodorder.end(), 0);
+
+        std::vector<float> chunk_push(chunk_size_max);
+        std::vector<float> chunk_pull(hop);
+
+        for (int chunk_size = 1; chunk_size <= chunk_size_max; chunk_size = static_cast<int>(1+chunk_size*1.1)) {
+            std::cout << "INFO: chunk_size=" << chunk_size << std::endl;
+            for (int iter=0; iter < nb_iter; ++iter) {
+                for (int n=0; n < chunk_size; ++n)
+                    chunk_push[n] = acbench::rand_uniform_continuous_01<float>();
+
+                // Run each method in a randomized order
+                std::random_shuffle(stftmethodorder.begin(), stftmethodorder.end());
+                for (int mi=0; mi < static_cast<int>(stftmethods.size()); ++mi)
+                    stftmethods[stftmethodorder[mi]]->run(chunk_push.data(), chunk_size, chunk_pull.data());
+            }
+
+            for (auto pmethod : stftmethods) {
+                pmethod->write_file("stft"+acbench::to_string<int>(frame_len, "%i")+"_"+acbench::to_string<int>(chunk_size, "%i"));
+                pmethod->m_elapsed.reset();
+            }
+        }
+
+        for (auto pmethod : stftmethods)
+            pmethod->compare(*stftmethods[0]);
+
+        for (auto pmethod : stftmethods)
+            delete pmethod;
+    }
+
+
+    // Scenario: convert ---------------------------------------------------
+    // Integer samples pushed into and pulled out of a ringbuffer<float>.
+    run_convert<int16_t>("int16", chunk_size_max, nb_iter, nb_repeat);
+    run_convert<acbench::int24>("int24", chunk_size_max, nb_iter, nb_repeat);
+    run_convert<int32_t>("int32", chunk_size_max, nb_iter, nb_repeat);
+
+
+    // Scenario: mixer -----------------------------------------------------
+    // A block from each of 32 to 128 sources, drained and summed at once.
+    for (int nb_buffers : {32, 64, 128}) {
+        std::cout << "INFO: nb_buffers=" << nb_buffers << std::endl;
+        std::vector<MethodMixer*> mixmethods;
+        mixmethods.push_back(new MethodMixerACBenchSeparate(nb_buffers, chunk_size_max));
+        mixmethods.push_back(new MethodMixerACBenchGroup(nb_buffers, chunk_size_max));
+        mixmethods.push_back(new MethodMixerACBenchGroupMix(nb_buffers, chunk_size_max));
+
+        std::vector<int> mixmethodorder(mixmethods.size());
+        std::iota(mixmethodorder.begin(), mixmethodorder.end(), 0);
+
+        std::vector<std::vector<float>> chunks(nb_buffers, std::vector<float>(chunk_size_max));
+        std::vector<const float*> pchunks(nb_buffers);
+        for (int i = 0; i < nb_buffers; ++i)
+            pchunks[i] = chunks[i].data();
+
+        for (int chunk_size = 1; chunk_size <= chunk_size_max; chunk_size = static_cast<int>(1+chunk_size*1.1)) {
+            std::cout << "INFO: chunk_size=" << chunk_size << std::endl;
+            for (int i=0; i < nb_buffers; ++i)
+                for (int n=0; n < chunk_size; ++n)
+                    chunks[i][n] = acbench::rand_uniform_continuous_01<float>();
+
+            // One block per iteration, measured individually
+            for (int iter=0; iter < nb_iter; ++iter) {
+                // Run each method in a randomized order
+                std::random_shuffle(mixmethodorder.begin(), mixmethodorder.end());
+                for (int mi=0; mi < static_cast<int>(mixmethods.size()); ++mi)
+                    mixmethods[mixmethodorder[mi]]->run(pchunks.data(), chunk_size);
+            }
+
+            for (auto pmethod : mixmethods) {
+                pmethod->write_file("mixer"+acbench::to_string<int>(nb_buffers, "%i")+"_"+acbench::to_string<int>(chunk_size, "%i"));
+                pmethod->m_elapsed.reset();
+            }
+
+            for (auto pmethod : mixmethods)
+                pmethod->compare(*mixmethods[0]);
+        }
+
+        for (auto pmethod : mixmethods)
+            delete pmethod;
+    }
+
+
+    // Scenario: large ---------------------------------------------------
+    // A 64MB ringbuffer kept half full, with a consumer thread running over a 1MB working set concurrently with the pushes.
+    // The pushes are copied through the caches (memcpy) or with non-temporal stores (set_stream_threshold(.)),
+    // all the chunks being streamed, so that the plot shows from which chunk size it pays off.
+    // The cache misses of the consumer are measured with its hardware counters where available, otherwise by its durations.
+    {
+        const int large_size_max = 16*1024*1024;
+        const int working_set_size = 256*1024;
+        std::vector<MethodLarge*> largemethods;
+        largemethods.push_back(new MethodLarge("ACBenchLarge", large_size_max, working_set_size, chunk_size_max, 0));
+        largemethods.push_back(new MethodLarge("ACBenchLargeStream", large_size_max, working_set_size, chunk_size_max, 1));
+        for (auto pmethod : largemethods)
+            pin_thread(&pmethod->m_consumer, 1);  // The producer being the main thread
+        if (!largemethods[0]->consumer_counters())
+            std::cout << "WARNING: The hardware counters are not available (see /proc/sys/kernel/perf_event_paranoid), the cache misses of the consumer are measured by its durations only." << std::endl;
+
+        std::vector<int> largemethodorder(largemethods.size());
+        std::iota(largemethodorder.begin(), largemethodorder.end(), 0);
+
+        std::vector<float> chunk_push(chunk_size_max);
+
+        for (int chunk_size = 1; chunk_size <= chunk_size_max; chunk_size = static_cast<int>(1+chunk_size*1.1)) {
+            std::cout << "INFO: chunk_size=" << chunk_size << std::endl;
+            for (int iter=0; iter < nb_iter; ++iter) {
+                for (int n=0; n < chunk_size; ++n)
+                    chunk_push[n] = acbench::rand_uniform_continuous_01<float>();
+
+                // Run each method in a randomized order
+                std::random_shuffle(largemethodorder.begin(), largemethodorder.end());
+                for (int mi=0; mi < static_cast<int>(largemethods.size()); ++mi)
+                    largemethods[largemethodorder[mi]]->run(chunk_push.data(), chunk_size, nb_repeat);
+            }
+
+            for (auto pmethod : largemethods) {
+                pmethod->write_file("large_"+acbench::to_string<int>(chunk_size, "%i"));
+                pmethod->reset();
+            }
+        }
+
+        for (auto pmethod : largemethods)
+            pmethod->compare(*largemethods[0]);
+
+        for (auto pmethod : largemethods)
+            delete pmethod;
+    }
+
+
     // Scenario: push_back_const ----------------------------------------------
     // Not very interesting comparison as none of the methods are optimized for
     // this use case, except ACBench. Thus ACBench is ~50 times faster than the others.
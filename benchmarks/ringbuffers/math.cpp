@@ -0,0 +1,180 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+// Benchmark of the math operations on the content of acbench::ringbuffer (see acbench/ringbuffer_math.h),
+// compared to copying the content out, processing it and pushing it back, and to operator[] loops.
+
+#include <acbench/ringbuffer.h>
+#include <acbench/ringbuffer_math.h>
+#include <acbench/time_elapsed.h>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <cmath>
+#include <iostream>
+
+#include "../ext/cxxopts/include/cxxopts.hpp"  // TODO(GD) Very slow compilation
+
+typedef acbench::ringbuffer<float, acbench::lock_none> ringbuffer_t;
+
+class Operation {
+ public:
+    std::string m_name;
+    std::function<void()> m_run;
+    acbench::time_elapsed m_elapsed;
+
+    explicit Operation(const std::string& name, const std::function<void()>& run, int nb_iter)
+        : m_name(name)
+        , m_run(run)
+        , m_elapsed(nb_iter+1) {
+    }
+
+    void run() {
+        m_elapsed.start();
+        m_run();
+        m_elapsed.end(0.0f);
+    }
+};
+
+int main(int argc, char* argv[]) {
+
+    cxxopts::Options options("benchmark_ringbuffers_math", "Benchmark math operations on the content of acbench::ringbuffer");
+    options.add_options()
+        ("i,iterations", "Number of iterations.", cxxopts::value<int>()->default_value("1000"))
+        ("s,size", "Number of values in the ringbuffers.", cxxopts::value<int>()->default_value("4096"))
+        ("h,help", "Print usage")
+    ;
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    std::srand(0);
+
+    int nb_iter = result["iterations"].as<int>();
+    int size = result["size"].as<int>();
+    std::cout << "#Iterations: " << nb_iter << std::endl;
+    std::cout << "size: " << size << std::endl;
+    std::cout << "instruction set: " << acbench::simd::instruction_set() << std::endl;
+
+    // Content that wraps around the end of the allocation, as it usually does
+    ringbuffer_t rb;
+    rb.resize_allocation(2*size);
+    rb.push_back(0.0f, size+size/2);
+    rb.pop_front(size+size/2);
+    for (int n = 0; n < size; ++n)
+        rb.push_back(2.0f*acbench::rand_uniform_continuous_01<float>()-1.0f);
+    // The array operand, made of +/-1 so that the values neither explode nor become denormals
+    std::vector<float> array(size);
+    for (int n = 0; n < size; ++n)
+        array[n] = (std::rand()%2) ? 1.0f : -1.0f;
+    const float* parray = array.data();
+    std::vector<float> tmp(size);  // Scratch buffer of the copy-process-push method
+    float* ptmp = tmp.data();
+    float acc = 0.0f;  // Output of the reductions, so that the compiler can't remove them
+
+    // Copy the content out, process it, and push it back
+    auto copy_process_push = [&](const std::function<void(float*, int)>& process) {
+        rb.copy_to_contiguous(ptmp);
+        process(ptmp, size);
+        rb.clear();
+        rb.push_back(ptmp, size);
+    };
+
+    std::vector<Operation*> operations;
+    // scale
+    operations.push_back(new Operation("scale/copy_process_push", [&]() {
+        copy_process_push([](float* p, int n) { for (int k = 0; k < n; ++k) p[k] *= -1.0f; }); }, nb_iter));
+    operations.push_back(new Operation("scale/operator[]", [&]() {
+        for (int k = 0; k < size; ++k) rb[k] *= -1.0f; }, nb_iter));
+    operations.push_back(new Operation("scale/acbench", [&]() {
+        acbench::scale(rb, -1.0f); }, nb_iter));
+    // multiply by an array
+    operations.push_back(new Operation("multiply/copy_process_push", [&]() {
+        copy_process_push([&](float* p, int n) { for (int k = 0; k < n; ++k) p[k] *= parray[k]; }); }, nb_iter));
+    operations.push_back(new Operation("multiply/operator[]", [&]() {
+        for (int k = 0; k < size; ++k) rb[k] *= parray[k]; }, nb_iter));
+    operations.push_back(new Operation("multiply/acbench", [&]() {
+        acbench::multiply(rb, parray); }, nb_iter));
+    // multiply-accumulate an array (with alternating gains, so that the values don't grow)
+    float mac_gain = 1.0f;
+    operations.push_back(new Operation("multiply_accumulate/copy_process_push", [&]() {
+        mac_gain = -mac_gain;
+        copy_process_push([&](float* p, int n) { for (int k = 0; k < n; ++k) p[k] += mac_gain*parray[k]; }); }, nb_iter));
+    operations.push_back(new Operation("multiply_accumulate/operator[]", [&]() {
+        mac_gain = -mac_gain;
+        for (int k = 0; k < size; ++k) rb[k] += mac_gain*parray[k]; }, nb_iter));
+    operations.push_back(new Operation("multiply_accumulate/acbench", [&]() {
+        mac_gain = -mac_gain;
+        acbench::multiply_accumulate(rb, parray, mac_gain); }, nb_iter));
+    // gain ramp (from -1 to -1, so that the values don't change in magnitude)
+    float step = 0.0f;
+    operations.push_back(new Operation("gain_ramp/copy_process_push", [&]() {
+        copy_process_push([&](float* p, int n) { for (int k = 0; k < n; ++k) p[k] *= -1.0f + k*step; }); }, nb_iter));
+    operations.push_back(new Operation("gain_ramp/operator[]", [&]() {
+        for (int k = 0; k < size; ++k) rb[k] *= -1.0f + k*step; }, nb_iter));
+    operations.push_back(new Operation("gain_ramp/acbench", [&]() {
+        acbench::gain_ramp(rb, -1.0f, -1.0f); }, nb_iter));
+    // sum
+    operations.push_back(new Operation("sum/copy_process", [&]() {
+        rb.copy_to_contiguous(ptmp);
+        float s = 0.0f; for (int k = 0; k < size; ++k) s += ptmp[k];
+        acc += s; }, nb_iter));
+    operations.push_back(new Operation("sum/operator[]", [&]() {
+        float s = 0.0f; for (int k = 0; k < size; ++k) s += rb[k];
+        acc += s; }, nb_iter));
+    operations.push_back(new Operation("sum/acbench", [&]() {
+        acc += acbench::sum(rb); }, nb_iter));
+    // rms
+    operations.push_back(new Operation("rms/copy_process", [&]() {
+        rb.copy_to_contiguous(ptmp);
+        float s = 0.0f; for (int k = 0; k < size; ++k) s += ptmp[k]*ptmp[k];
+        acc += std::sqrt(s/size); }, nb_iter));
+    operations.push_back(new Operation("rms/operator[]", [&]() {
+        float s = 0.0f; for (int k = 0; k < size; ++k) s += rb[k]*rb[k];
+        acc += std::sqrt(s/size); }, nb_iter));
+    operations.push_back(new Operation("rms/acbench", [&]() {
+        acc += acbench::rms(rb); }, nb_iter));
+    // peak
+    operations.push_back(new Operation("peak/copy_process", [&]() {
+        rb.copy_to_contiguous(ptmp);
+        float p = 0.0f; for (int k = 0; k < size; ++k) p = std::max(p, std::abs(ptmp[k]));
+        acc += p; }, nb_iter));
+    operations.push_back(new Operation("peak/operator[]", [&]() {
+        float p = 0.0f; for (int k = 0; k < size; ++k) p = std::max(p, std::abs(rb[k]));
+        acc += p; }, nb_iter));
+    operations.push_back(new Operation("peak/acbench", [&]() {
+        acc += acbench::peak(rb); }, nb_iter));
+
+    std::mt19937 gen(0);
+    std::vector<int> order(operations.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    for (int iter = 0; iter < nb_iter; ++iter) {
+        // Run each operation in a randomized order
+        std::shuffle(order.begin(), order.end(), gen);
+        for (int oi : order)
+            operations[oi]->run();
+    }
+
+    for (auto operation : operations) {
+        std::cout << "    " << operation->m_name << ": " << operation->m_elapsed.stats(6)
+                  << ", " << acbench::to_string(operation->m_elapsed.mean()*1e9/size, "%5.3f") << "ns/sample" << std::endl;
+    }
+    std::cout << "(" << acc << ")" << std::endl;
+
+    for (auto operation : operations)
+        delete operation;
+
+    return 0;
+}
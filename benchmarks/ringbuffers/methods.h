@@ -15,6 +15,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <cmath>
 #include <algorithm>
 #include <random>
 
@@ -22,6 +23,10 @@
 #include <fstream>
 
 #include <deque>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
 
 // Boost
 #include <boost/circular_buffer.hpp>
@@ -34,33 +39,76 @@
 
 // ACBench
 #include <acbench/ringbuffer.h>
+#include <acbench/allocators.h>
+#include <acbench/mirrored_ringbuffer.h>  // Empty outside Linux
+#include <acbench/multichannel_ringbuffer.h>
+#include <acbench/static_ringbuffer.h>
+#include <acbench/ringbuffer_group.h>
 
 #include <acbench/time_elapsed.h>
 
 
-class Method {
+//! Writes the durations of elapsed, and its hardware counters if enabled (see acbench::time_elapsed::enable_counters()),
+//  divided by divisor (ex. the number of repetitions in each measure), in name_tag_elapsed.bin (and name_tag_<counter>.bin).
+inline void write_elapsed(const std::string& name, const std::string& tag, const acbench::time_elapsed& elapsed, int divisor) {
+    std::string file_path = name+"_"+tag+"_elapsed.bin";
+    std::ofstream fh(file_path, std::ios_base::binary);
+    for (int n=0; n<elapsed.size(); ++n) {
+        float value = elapsed.elapsed()[n]/divisor;
+        fh.write((char*)&value, sizeof(value));
+    }
+    fh.close();
+
+    for (int i=0; i < acbench::time_elapsed::nb_counters; ++i) {
+        acbench::time_elapsed::counter c = static_cast<acbench::time_elapsed::counter>(i);
+        if (!elapsed.has_counter(c))
+            continue;
+        std::ofstream fh_counter(name+"_"+tag+"_"+acbench::time_elapsed::counter_name(c)+".bin", std::ios_base::binary);
+        for (int n=0; n < elapsed.counters(c).size(); ++n) {
+            float value = static_cast<float>(elapsed.counters(c)[n]/divisor);
+            fh_counter.write((char*)&value, sizeof(value));
+        }
+    }
+}
+
+//! The base of all the scenarios: the name of the method, its measures, and how they are written.
+class Scenario {
  public:
     std::string m_name;
-    int m_max_size = 0;
-    int m_nb_repeat = 100;
+    int m_nb_repeat = 1;  // Number of repetitions in each measure
     acbench::time_elapsed m_elapsed;
 
-    explicit Method(const std::string& name, int max_size, int nb_repeat)
+    explicit Scenario(const std::string& name, int nb_repeat)
         : m_name(name)
-        , m_max_size(max_size)
         , m_nb_repeat(nb_repeat) {
     }
-    virtual ~Method() {
+    virtual ~Scenario() {
     }
 
-    void write_file(const std::string& tag) const {
-        std::string file_path = m_name+"_"+tag+"_elapsed.bin";
-        std::ofstream fh(file_path, std::ios_base::binary);
-        for (int n=0; n<m_elapsed.size(); ++n) {
-            float value = m_elapsed.elapsed()[n]/m_nb_repeat;
-            fh.write((char*)&value, sizeof(value));
-        }
-        fh.close();
+    //! Writes the durations per repetition, and the hardware counters if enabled.
+    virtual void write_file(const std::string& tag) const {
+        write_elapsed(m_name, tag, m_elapsed, m_nb_repeat);
+    }
+
+ protected:
+    //! Reports an error if the outcome of this method is not the same as the one of the reference method.
+    bool check_same(bool same, const Scenario& ref) const {
+        if (!same)
+            std::cerr << "ERROR: compare: " << m_name << ": different from " << ref.m_name << "." << std::endl;
+        return same;
+    }
+};
+
+class Method : public Scenario {
+ public:
+    int m_max_size = 0;
+    float m_inplace_acc = 0.0f;  // Output of the consumer in the push_pull_inplace scenario
+
+    explicit Method(const std::string& name, int max_size, int nb_repeat)
+        : Scenario(name, nb_repeat)
+        , m_max_size(max_size) {
+    }
+    virtual ~Method() {
     }
 
     virtual void clear() = 0;
@@ -69,9 +117,64 @@ class Method {
     virtual void run_push_pull_array(float* chunk_push, int size_push, float* chunk_pull, int size_pull) = 0;
     virtual void run_push_back_const(float value, int chunk_size) = 0;
 
+    /* Scenario: push_pull_inplace
+     * Same as push_pull_array, but the producer writes the chunk directly in the ringbuffer's memory
+     * and the consumer processes the values directly in the ringbuffer's memory (see process_inplace(.)),
+     * using the zero-copy API of the implementation when it has one (otherwise the copy path).
+     */
+    virtual void run_push_pull_inplace(float* chunk_push, int size_push, float* chunk_pull, int size_pull) = 0;
+
     virtual bool compare(const std::deque<float>& arr_ref) = 0;
+
+    /* Scenario: threads
+     * A producer thread pushes chunks while a consumer thread pulls them (see run_threads(.) in main.cpp).
+     * push_threaded(.) and pull_threaded(.) are called concurrently, from one producer thread and one consumer thread.
+     * Both move the whole chunk or nothing, and return false if there is not enough space or values.
+     * The implementations that are not thread-safe are guarded by m_mutex_threaded, as their users would have to.
+     */
+    std::mutex m_mutex_threaded;
+    virtual bool push_threaded(const float* chunk, int chunk_size) = 0;
+    virtual bool pull_threaded(float* chunk, int chunk_size) = 0;
+    //! Checks a chunk pulled in the threads scenario, whose values were all set to value by the producer.
+    virtual bool compare_threaded(const float* chunk, int chunk_size, float value) const {
+        return (chunk[0] == value) && (chunk[chunk_size-1] == value);
+    }
 };
 
+// The processing done by the consumer in the push_pull_inplace scenario.
+// It accumulates the values in *pacc (ie. Method::m_inplace_acc), so that the compiler can't remove the reads.
+inline void process_inplace(const float* data, int size, float* pacc) {
+    float acc = *pacc;
+    for (int n = 0; n < size; ++n)
+        acc += data[n];
+    *pacc = acc;
+}
+
+// The threads scenario for the acbench containers that lock (see Method::push_threaded(.) and Method::pull_threaded(.)):
+// the size check and the copy within the same lock of the buffer (plus *pmutex_threaded for lock_none).
+template<typename Buffer>
+inline bool push_threaded_locked(Buffer* pbuffer, std::mutex* pmutex_threaded, int max_size, const float* chunk, int chunk_size) {
+    std::unique_lock<std::mutex> guard_threaded(*pmutex_threaded, std::defer_lock);
+    if (!pbuffer->is_thread_safe())
+        guard_threaded.lock();
+    acbench::lock_guard<Buffer> guard(*pbuffer);
+    if (pbuffer->size()+chunk_size > max_size)
+        return false;
+    pbuffer->push_back_nolock(chunk, chunk_size);
+    return true;
+}
+template<typename Buffer>
+inline bool pull_threaded_locked(Buffer* pbuffer, std::mutex* pmutex_threaded, float* chunk, int chunk_size) {
+    std::unique_lock<std::mutex> guard_threaded(*pmutex_threaded, std::defer_lock);
+    if (!pbuffer->is_thread_safe())
+        guard_threaded.lock();
+    acbench::lock_guard<Buffer> guard(*pbuffer);
+    if (pbuffer->size() < chunk_size)
+        return false;
+    pbuffer->pop_front_nolock(chunk, chunk_size);
+    return true;
+}
+
 // Fake ringbuffer that doesn't store the data
 template<typename T>
 class fastestbound_ringbuffer {
@@ -161,9 +264,38 @@ class MethodFastestBound : public Method {
         m_elapsed.end(0.0);
     }
 
+    virtual void run_push_pull_inplace(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        m_elapsed.start();
+        while (static_cast<int>(m_buffer.size())+size_push <= m_max_size) {
+            m_buffer.push_back(chunk_push, size_push);
+        }
+        while (static_cast<int>(m_buffer.size()) >= size_pull) {
+            m_buffer.pop_front(size_pull);
+        }
+        m_elapsed.end(0.0);
+    }
+
     virtual bool compare(const std::deque<float>& arr_ref) {
         return true;  // Fake it
     }
+
+    std::atomic<int> m_size_threaded{0};  // The fake ringbuffer only hands the sizes over
+
+    virtual bool push_threaded(const float* chunk, int chunk_size) {
+        if (m_size_threaded.load(std::memory_order_acquire)+chunk_size > m_max_size)
+            return false;
+        m_size_threaded.fetch_add(chunk_size, std::memory_order_release);
+        return true;
+    }
+    virtual bool pull_threaded(float* chunk, int chunk_size) {
+        if (m_size_threaded.load(std::memory_order_acquire) < chunk_size)
+            return false;
+        m_size_threaded.fetch_sub(chunk_size, std::memory_order_release);
+        return true;
+    }
+    virtual bool compare_threaded(const float* chunk, int chunk_size, float value) const {
+        return true;  // Fake it
+    }
 };
 
 class MethodSTL : public Method {
@@ -231,9 +363,45 @@ class MethodSTL : public Method {
         m_elapsed.end(0.0f);
     }
 
+    virtual void run_push_pull_inplace(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (static_cast<int>(m_buffer.size())+size_push <= m_max_size) {
+                for (int c=0; c < size_push; ++c)
+                    m_buffer.push_back(chunk_push[c]);
+            }
+            while (static_cast<int>(m_buffer.size()) >= size_pull) {
+                for (int c=0; c < size_pull; ++c) {
+                    m_inplace_acc += m_buffer.front();
+                    m_buffer.pop_front();
+                }
+            }
+       }
+        m_elapsed.end(0.0f);
+    }
+
     virtual bool compare(const std::deque<float>& arr_ref) {
         return acbench::compare(arr_ref, m_buffer);
     }
+
+    virtual bool push_threaded(const float* chunk, int chunk_size) {
+        std::lock_guard<std::mutex> guard(m_mutex_threaded);
+        if (static_cast<int>(m_buffer.size())+chunk_size > m_max_size)
+            return false;
+        for (int c=0; c < chunk_size; ++c)
+            m_buffer.push_back(chunk[c]);
+        return true;
+    }
+    virtual bool pull_threaded(float* chunk, int chunk_size) {
+        std::lock_guard<std::mutex> guard(m_mutex_threaded);
+        if (static_cast<int>(m_buffer.size()) < chunk_size)
+            return false;
+        for (int c=0; c < chunk_size; ++c) {
+            chunk[c] = m_buffer.front();
+            m_buffer.pop_front();
+        }
+        return true;
+    }
 };
 
 class MethodBoost : public Method {
@@ -292,9 +460,45 @@ class MethodBoost : public Method {
         m_elapsed.end(0.0f);
     }
 
+    virtual void run_push_pull_inplace(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (static_cast<int>(m_buffer.size())+size_push <= m_max_size) {
+                for (int c=0; c < size_push; ++c)
+                    m_buffer.push_back(chunk_push[c]);
+            }
+            while (static_cast<int>(m_buffer.size()) >= size_pull) {
+                for (int c=0; c < size_pull; ++c) {
+                    m_inplace_acc += m_buffer.front();
+                    m_buffer.pop_front();
+                }
+            }
+       }
+        m_elapsed.end(0.0f);
+    }
+
     virtual bool compare(const std::deque<float>& arr_ref) {
         return acbench::compare(arr_ref, m_buffer);
     }
+
+    virtual bool push_threaded(const float* chunk, int chunk_size) {
+        std::lock_guard<std::mutex> guard(m_mutex_threaded);
+        if (static_cast<int>(m_buffer.size())+chunk_size > m_max_size)
+            return false;
+        for (int c=0; c < chunk_size; ++c)
+            m_buffer.push_back(chunk[c]);
+        return true;
+    }
+    virtual bool pull_threaded(float* chunk, int chunk_size) {
+        std::lock_guard<std::mutex> guard(m_mutex_threaded);
+        if (static_cast<int>(m_buffer.size()) < chunk_size)
+            return false;
+        for (int c=0; c < chunk_size; ++c) {
+            chunk[c] = m_buffer.front();
+            m_buffer.pop_front();
+        }
+        return true;
+    }
 };
 
 class MethodPortaudio : public Method {
@@ -364,6 +568,29 @@ class MethodPortaudio : public Method {
         m_elapsed.end(0.0f);
     }
 
+    virtual void run_push_pull_inplace(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        void* pdata1;
+        void* pdata2;
+        ring_buffer_size_t size1, size2;
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (size_push <= PaUtil_GetRingBufferWriteAvailable(&pa_buffer)) {
+                PaUtil_GetRingBufferWriteRegions(&pa_buffer, size_push, &pdata1, &size1, &pdata2, &size2);
+                std::memcpy(pdata1, chunk_push, size1*sizeof(float));
+                if (size2 > 0)
+                    std::memcpy(pdata2, chunk_push+size1, size2*sizeof(float));
+                PaUtil_AdvanceRingBufferWriteIndex(&pa_buffer, size_push);
+            }
+            while (PaUtil_GetRingBufferReadAvailable(&pa_buffer) >= size_pull) {
+                PaUtil_GetRingBufferReadRegions(&pa_buffer, size_pull, &pdata1, &size1, &pdata2, &size2);
+                process_inplace(reinterpret_cast<float*>(pdata1), size1, &m_inplace_acc);
+                process_inplace(reinterpret_cast<float*>(pdata2), size2, &m_inplace_acc);
+                PaUtil_AdvanceRingBufferReadIndex(&pa_buffer, size_pull);
+            }
+       }
+        m_elapsed.end(0.0f);
+    }
+
     virtual bool compare(const std::deque<float>& arr_ref) {
         int pa_size = PaUtil_GetRingBufferReadAvailable(&pa_buffer);
         float* tmp = new float[pa_size];
@@ -375,6 +602,20 @@ class MethodPortaudio : public Method {
         delete[] tmp;
         return ret;
     }
+
+    // Lock-free for one producer and one consumer
+    virtual bool push_threaded(const float* chunk, int chunk_size) {
+        if (PaUtil_GetRingBufferWriteAvailable(&pa_buffer) < chunk_size)
+            return false;
+        PaUtil_WriteRingBuffer(&pa_buffer, reinterpret_cast<const void*>(chunk), chunk_size);
+        return true;
+    }
+    virtual bool pull_threaded(float* chunk, int chunk_size) {
+        if (PaUtil_GetRingBufferReadAvailable(&pa_buffer) < chunk_size)
+            return false;
+        PaUtil_ReadRingBuffer(&pa_buffer, reinterpret_cast<void*>(chunk), chunk_size);
+        return true;
+    }
 };
 
 class MethodRubberBand : public Method {
@@ -427,6 +668,21 @@ class MethodRubberBand : public Method {
         m_elapsed.end(0.0f);
     }
 
+    // No zero-copy API used for RubberBand, so it goes through the copy path
+    virtual void run_push_pull_inplace(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (size_push <= m_buffer.getWriteSpace()) {
+                m_buffer.write(chunk_push, size_push);
+            }
+            while (m_buffer.getReadSpace() >= size_pull) {
+                m_buffer.read(chunk_pull, size_pull);
+                process_inplace(chunk_pull, size_pull, &m_inplace_acc);
+            }
+       }
+        m_elapsed.end(0.0f);
+    }
+
     virtual bool compare(const std::deque<float>& arr_ref) {
         // TODO(GD) Simplify
         float* tmp = new float[m_buffer.getReadSpace()];
@@ -438,6 +694,20 @@ class MethodRubberBand : public Method {
         delete[] tmp;
         return ret;
     }
+
+    // Lock-free for one producer and one consumer
+    virtual bool push_threaded(const float* chunk, int chunk_size) {
+        if (m_buffer.getWriteSpace() < chunk_size)
+            return false;
+        m_buffer.write(chunk, chunk_size);
+        return true;
+    }
+    virtual bool pull_threaded(float* chunk, int chunk_size) {
+        if (m_buffer.getReadSpace() < chunk_size)
+            return false;
+        m_buffer.read(chunk, chunk_size);
+        return true;
+    }
 };
 
 class MethodJack : public Method {
@@ -500,6 +770,29 @@ class MethodJack : public Method {
         m_elapsed.end(0.0f);
     }
 
+    virtual void run_push_pull_inplace(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        jack_ringbuffer_data_t vec[2];
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (size_push <= static_cast<int>(jack_ringbuffer_write_space(m_buffer)/sizeof(float))) {
+                jack_ringbuffer_get_write_vector(m_buffer, vec);
+                int size1 = std::min<int>(size_push, vec[0].len/sizeof(float));
+                std::memcpy(vec[0].buf, chunk_push, size1*sizeof(float));
+                if (size1 < size_push)
+                    std::memcpy(vec[1].buf, chunk_push+size1, (size_push-size1)*sizeof(float));
+                jack_ringbuffer_write_advance(m_buffer, size_push*sizeof(float));
+            }
+            while (static_cast<int>(jack_ringbuffer_read_space(m_buffer)/sizeof(float)) >= size_pull) {
+                jack_ringbuffer_get_read_vector(m_buffer, vec);
+                int size1 = std::min<int>(size_pull, vec[0].len/sizeof(float));
+                process_inplace(reinterpret_cast<float*>(vec[0].buf), size1, &m_inplace_acc);
+                process_inplace(reinterpret_cast<float*>(vec[1].buf), size_pull-size1, &m_inplace_acc);
+                jack_ringbuffer_read_advance(m_buffer, size_pull*sizeof(float));
+            }
+       }
+        m_elapsed.end(0.0f);
+    }
+
     virtual bool compare(const std::deque<float>& arr_ref) {
         int size = jack_ringbuffer_read_space(m_buffer)/sizeof(float);
         float* tmp = new float[size];
@@ -511,14 +804,330 @@ class MethodJack : public Method {
         delete[] tmp;
         return ret;
     }
+
+    // Lock-free for one producer and one consumer
+    virtual bool push_threaded(const float* chunk, int chunk_size) {
+        if (jack_ringbuffer_write_space(m_buffer) < chunk_size*sizeof(float))
+            return false;
+        jack_ringbuffer_write(m_buffer, reinterpret_cast<const char*>(chunk), chunk_size*sizeof(float));
+        return true;
+    }
+    virtual bool pull_threaded(float* chunk, int chunk_size) {
+        if (jack_ringbuffer_read_space(m_buffer) < chunk_size*sizeof(float))
+            return false;
+        jack_ringbuffer_read(m_buffer, reinterpret_cast<char*>(chunk), chunk_size*sizeof(float));
+        return true;
+    }
 };
 
+// One method per locking policy and allocation policy (see acbench/ringbuffer.h and acbench/allocators.h)
+template<typename Lock = acbench::lock_default, typename Allocator = acbench::allocator_new<float>>
 class MethodACBench : public Method {
  public:
-    acbench::ringbuffer<float> m_buffer;
+    acbench::ringbuffer<float, Lock, Allocator> m_buffer;
+
+    explicit MethodACBench(int max_size, int nb_repeat, const std::string& name = "ACBench")
+        : Method(name, max_size, nb_repeat) {
+        m_buffer.resize_allocation(max_size);
+    }
+
+    void clear() {
+        m_buffer.clear();
+    }
+
+    virtual void run_push_back_array(float* chunk, int chunk_size) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            if (m_buffer.size()+chunk_size > m_max_size)
+                m_buffer.pop_front(chunk_size);
+            m_buffer.push_back(chunk, chunk_size);
+        }
+        m_elapsed.end(0.0f);
+    }
+
+    virtual void run_push_pull_array(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (m_buffer.size()+size_push <= m_max_size) {
+                m_buffer.push_back(chunk_push, size_push);
+            }
+            while (m_buffer.size() >= size_pull) {
+                m_buffer.pop_front(chunk_pull, size_pull);
+            }
+        }
+        m_elapsed.end(0.0);
+    }
+
+    virtual void run_push_back_const(float value, int chunk_size) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            if (m_buffer.size()+chunk_size > m_max_size)
+                m_buffer.pop_front(chunk_size);
+            m_buffer.push_back(value, chunk_size);
+        }
+        m_elapsed.end(0.0f);
+    }
+
+    virtual void run_push_pull_inplace(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        float* pwrite1;
+        float* pwrite2;
+        const float* pread1;
+        const float* pread2;
+        int size1, size2;
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (m_buffer.size()+size_push <= m_max_size) {
+                m_buffer.write_reserve(size_push, &pwrite1, &size1, &pwrite2, &size2);
+                std::memcpy(pwrite1, chunk_push, size1*sizeof(float));
+                if (size2 > 0)
+                    std::memcpy(pwrite2, chunk_push+size1, size2*sizeof(float));
+                m_buffer.write_commit(size_push);
+            }
+            while (m_buffer.size() >= size_pull) {
+                m_buffer.read_peek(size_pull, &pread1, &size1, &pread2, &size2);
+                process_inplace(pread1, size1, &m_inplace_acc);
+                process_inplace(pread2, size2, &m_inplace_acc);
+                m_buffer.read_consume(size_pull);
+            }
+        }
+        m_elapsed.end(0.0f);
+    }
+
+    virtual bool compare(const std::deque<float>& arr_ref) {
+        return acbench::compare(arr_ref, m_buffer);
+    }
+
+    virtual bool push_threaded(const float* chunk, int chunk_size) {
+        return push_threaded_locked(&m_buffer, &m_mutex_threaded, m_max_size, chunk, chunk_size);
+    }
+    virtual bool pull_threaded(float* chunk, int chunk_size) {
+        return pull_threaded_locked(&m_buffer, &m_mutex_threaded, chunk, chunk_size);
+    }
+};
+
+// Same as MethodACBench, with the block size known at compile time (push_back<N>(.) and pop_front<N>(.)) for
+// the usual block sizes 32, 64, 128, 256 and 512 in the push_pull_array scenario, and the runtime size otherwise.
+template<typename Lock = acbench::lock_default>
+class MethodACBenchBlock : public MethodACBench<Lock> {
+ public:
+    explicit MethodACBenchBlock(int max_size, int nb_repeat, const std::string& name = "ACBenchBlock")
+        : MethodACBench<Lock>(max_size, nb_repeat, name) {
+    }
+
+    template<int N>
+    void run_push_pull_block(float* chunk_push, float* chunk_pull) {
+        this->m_elapsed.start();
+        for (int n = 0; n < this->m_nb_repeat; ++n) {
+            while (this->m_buffer.size()+N <= this->m_max_size) {
+                this->m_buffer.template push_back<N>(chunk_push);
+            }
+            while (this->m_buffer.size() >= N) {
+                this->m_buffer.template pop_front<N>(chunk_pull);
+            }
+        }
+        this->m_elapsed.end(0.0f);
+    }
+
+    virtual void run_push_pull_array(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        if (size_push == size_pull) {
+            switch (size_push) {
+                case 32:  run_push_pull_block<32>(chunk_push, chunk_pull); return;
+                case 64:  run_push_pull_block<64>(chunk_push, chunk_pull); return;
+                case 128: run_push_pull_block<128>(chunk_push, chunk_pull); return;
+                case 256: run_push_pull_block<256>(chunk_push, chunk_pull); return;
+                case 512: run_push_pull_block<512>(chunk_push, chunk_pull); return;
+                default: break;
+            }
+        }
+        MethodACBench<Lock>::run_push_pull_array(chunk_push, size_push, chunk_pull, size_pull);
+    }
+};
+
+// The capacity is fixed at compile time, so it is only usable if max_size <= N.
+// The scenarios limit the content to m_max_size, as for the other methods.
+template<int N, typename Lock = acbench::lock_none>
+class MethodACBenchStatic : public Method {
+ public:
+    acbench::static_ringbuffer<float, N, Lock> m_buffer;
+
+    explicit MethodACBenchStatic(int max_size, int nb_repeat, const std::string& name = "ACBenchStatic")
+        : Method(name, max_size, nb_repeat) {
+        assert(max_size <= N);
+    }
+
+    void clear() {
+        m_buffer.clear();
+    }
+
+    virtual void run_push_back_array(float* chunk, int chunk_size) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            if (m_buffer.size()+chunk_size > m_max_size)
+                m_buffer.pop_front(chunk_size);
+            m_buffer.push_back(chunk, chunk_size);
+        }
+        m_elapsed.end(0.0f);
+    }
+
+    virtual void run_push_pull_array(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (m_buffer.size()+size_push <= m_max_size) {
+                m_buffer.push_back(chunk_push, size_push);
+            }
+            while (m_buffer.size() >= size_pull) {
+                m_buffer.pop_front(chunk_pull, size_pull);
+            }
+        }
+        m_elapsed.end(0.0);
+    }
+
+    virtual void run_push_back_const(float value, int chunk_size) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            if (m_buffer.size()+chunk_size > m_max_size)
+                m_buffer.pop_front(chunk_size);
+            m_buffer.push_back(value, chunk_size);
+        }
+        m_elapsed.end(0.0f);
+    }
+
+    virtual void run_push_pull_inplace(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        float* pwrite1;
+        float* pwrite2;
+        const float* pread1;
+        const float* pread2;
+        int size1, size2;
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (m_buffer.size()+size_push <= m_max_size) {
+                m_buffer.write_reserve(size_push, &pwrite1, &size1, &pwrite2, &size2);
+                std::memcpy(pwrite1, chunk_push, size1*sizeof(float));
+                if (size2 > 0)
+                    std::memcpy(pwrite2, chunk_push+size1, size2*sizeof(float));
+                m_buffer.write_commit(size_push);
+            }
+            while (m_buffer.size() >= size_pull) {
+                m_buffer.read_peek(size_pull, &pread1, &size1, &pread2, &size2);
+                process_inplace(pread1, size1, &m_inplace_acc);
+                process_inplace(pread2, size2, &m_inplace_acc);
+                m_buffer.read_consume(size_pull);
+            }
+        }
+        m_elapsed.end(0.0f);
+    }
+
+    virtual bool compare(const std::deque<float>& arr_ref) {
+        return acbench::compare(arr_ref, m_buffer);
+    }
+
+    virtual bool push_threaded(const float* chunk, int chunk_size) {
+        return push_threaded_locked(&m_buffer, &m_mutex_threaded, m_max_size, chunk, chunk_size);
+    }
+    virtual bool pull_threaded(float* chunk, int chunk_size) {
+        return pull_threaded_locked(&m_buffer, &m_mutex_threaded, chunk, chunk_size);
+    }
+};
+
+// The lock_spsc policy has its own API, with push_back(.) that clips to the free space.
+class MethodACBenchSPSC : public Method {
+ public:
+    acbench::spsc_ringbuffer<float> m_buffer;
+
+    explicit MethodACBenchSPSC(int max_size, int nb_repeat)
+        : Method("ACBenchSPSC", max_size, nb_repeat) {
+        m_buffer.resize_allocation(max_size);
+    }
+
+    void clear() {
+        m_buffer.clear();
+    }
+
+    virtual void run_push_back_array(float* chunk, int chunk_size) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            if (m_buffer.size()+chunk_size > m_max_size)
+                m_buffer.pop_front(chunk_size);
+            m_buffer.push_back(chunk, chunk_size);
+        }
+        m_elapsed.end(0.0f);
+    }
+
+    virtual void run_push_pull_array(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (size_push <= m_buffer.size_free()) {
+                m_buffer.push_back(chunk_push, size_push);
+            }
+            while (m_buffer.size() >= size_pull) {
+                m_buffer.pop_front(chunk_pull, size_pull);
+            }
+        }
+        m_elapsed.end(0.0);
+    }
 
-    explicit MethodACBench(int max_size, int nb_repeat)
-        : Method("ACBench", max_size, nb_repeat) {
+    virtual void run_push_back_const(float value, int chunk_size) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            if (m_buffer.size()+chunk_size > m_max_size)
+                m_buffer.pop_front(chunk_size);
+            m_buffer.push_back(value, chunk_size);
+        }
+        m_elapsed.end(0.0f);
+    }
+
+    virtual void run_push_pull_inplace(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        float* pwrite1;
+        float* pwrite2;
+        const float* pread1;
+        const float* pread2;
+        int size1, size2;
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (size_push <= m_buffer.size_free()) {
+                m_buffer.write_reserve(size_push, &pwrite1, &size1, &pwrite2, &size2);
+                std::memcpy(pwrite1, chunk_push, size1*sizeof(float));
+                if (size2 > 0)
+                    std::memcpy(pwrite2, chunk_push+size1, size2*sizeof(float));
+                m_buffer.write_commit(size_push);
+            }
+            while (m_buffer.size() >= size_pull) {
+                m_buffer.read_peek(size_pull, &pread1, &size1, &pread2, &size2);
+                process_inplace(pread1, size1, &m_inplace_acc);
+                process_inplace(pread2, size2, &m_inplace_acc);
+                m_buffer.read_consume(size_pull);
+            }
+        }
+        m_elapsed.end(0.0f);
+    }
+
+    virtual bool compare(const std::deque<float>& arr_ref) {
+        return acbench::compare(arr_ref, m_buffer);
+    }
+
+    // Lock-free for one producer and one consumer
+    virtual bool push_threaded(const float* chunk, int chunk_size) {
+        if (m_buffer.size_free() < chunk_size)
+            return false;
+        m_buffer.push_back(chunk, chunk_size);
+        return true;
+    }
+    virtual bool pull_threaded(float* chunk, int chunk_size) {
+        if (m_buffer.size() < chunk_size)
+            return false;
+        m_buffer.pop_front(chunk, chunk_size);
+        return true;
+    }
+};
+
+#if defined(__linux__)  // mirrored_ringbuffer is Linux only
+// The capacity is rounded up to the page size, but the scenarios still limit the content to m_max_size.
+class MethodACBenchMirrored : public Method {
+ public:
+    acbench::mirrored_ringbuffer<float> m_buffer;
+
+    explicit MethodACBenchMirrored(int max_size, int nb_repeat)
+        : Method("ACBenchMirrored", max_size, nb_repeat) {
         m_buffer.resize_allocation(max_size);
     }
 
@@ -559,9 +1168,544 @@ class MethodACBench : public Method {
         m_elapsed.end(0.0f);
     }
 
+    virtual void run_push_pull_inplace(float* chunk_push, int size_push, float* chunk_pull, int size_pull) {
+        float* pwrite1;
+        float* pwrite2;
+        const float* pread1;
+        const float* pread2;
+        int size1, size2;
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (m_buffer.size()+size_push <= m_max_size) {
+                m_buffer.write_reserve(size_push, &pwrite1, &size1, &pwrite2, &size2);
+                std::memcpy(pwrite1, chunk_push, size1*sizeof(float));
+                if (size2 > 0)
+                    std::memcpy(pwrite2, chunk_push+size1, size2*sizeof(float));
+                m_buffer.write_commit(size_push);
+            }
+            while (m_buffer.size() >= size_pull) {
+                m_buffer.read_peek(size_pull, &pread1, &size1, &pread2, &size2);
+                process_inplace(pread1, size1, &m_inplace_acc);
+                process_inplace(pread2, size2, &m_inplace_acc);
+                m_buffer.read_consume(size_pull);
+            }
+        }
+        m_elapsed.end(0.0f);
+    }
+
     virtual bool compare(const std::deque<float>& arr_ref) {
         return acbench::compare(arr_ref, m_buffer);
     }
+
+    virtual bool push_threaded(const float* chunk, int chunk_size) {
+        return push_threaded_locked(&m_buffer, &m_mutex_threaded, m_max_size, chunk, chunk_size);
+    }
+    virtual bool pull_threaded(float* chunk, int chunk_size) {
+        return pull_threaded_locked(&m_buffer, &m_mutex_threaded, chunk, chunk_size);
+    }
+};
+#endif  // __linux__
+
+
+
+// Multichannel ---------------------------------------------------------------
+
+/* Scenario: multichannel
+ * Same as push_pull_array, but with nb_channels channels, each chunk being given and retrieved as one array per channel.
+ * The sizes are in frames (one value per channel).
+ */
+class MethodMultichannel : public Scenario {
+ public:
+    int m_nb_channels = 0;
+    int m_max_size = 0;
+
+    explicit MethodMultichannel(const std::string& name, int nb_channels, int max_size, int nb_repeat)
+        : Scenario(name, nb_repeat)
+        , m_nb_channels(nb_channels)
+        , m_max_size(max_size) {
+    }
+
+    virtual void clear() = 0;
+
+    virtual void run_push_pull(float* const* chunks_push, int size_push, float* const* chunks_pull, int size_pull) = 0;
+
+    virtual int size() const = 0;
+    virtual float value(int channel, int n) const = 0;
+
+    bool compare(const MethodMultichannel& ref) const {
+        if (size() != ref.size()) {
+            std::cerr << "ERROR: compare: " << m_name << ": reference and test have different sizes." << std::endl;
+            return false;
+        }
+        for (int c = 0; c < m_nb_channels; ++c) {
+            for (int n = 0; n < size(); ++n) {
+                if (value(c, n) != ref.value(c, n)) {
+                    std::cerr << "ERROR: compare: " << m_name << ": Values at channel " << c << " index " << n << " are different." << std::endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+// One independent acbench::ringbuffer per channel, as done without multichannel_ringbuffer (the reference)
+class MethodMultichannelACBench : public MethodMultichannel {
+ public:
+    acbench::ringbuffer<float>* m_buffers = nullptr;
+
+    explicit MethodMultichannelACBench(int nb_channels, int max_size, int nb_repeat)
+        : MethodMultichannel("ACBenchChannels", nb_channels, max_size, nb_repeat) {
+        m_buffers = new acbench::ringbuffer<float>[nb_channels];
+        for (int c = 0; c < nb_channels; ++c)
+            m_buffers[c].resize_allocation(max_size);
+    }
+    virtual ~MethodMultichannelACBench() {
+        delete[] m_buffers;
+    }
+
+    void clear() {
+        for (int c = 0; c < m_nb_channels; ++c)
+            m_buffers[c].clear();
+    }
+
+    virtual void run_push_pull(float* const* chunks_push, int size_push, float* const* chunks_pull, int size_pull) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (m_buffers[0].size()+size_push <= m_max_size) {
+                for (int c = 0; c < m_nb_channels; ++c)
+                    m_buffers[c].push_back(chunks_push[c], size_push);
+            }
+            while (m_buffers[0].size() >= size_pull) {
+                for (int c = 0; c < m_nb_channels; ++c)
+                    m_buffers[c].pop_front(chunks_pull[c], size_pull);
+            }
+        }
+        m_elapsed.end(0.0f);
+    }
+
+    virtual int size() const {
+        return m_buffers[0].size();
+    }
+    virtual float value(int channel, int n) const {
+        return m_buffers[channel][n];
+    }
+};
+
+// A single acbench::multichannel_ringbuffer with the given layout
+class MethodMultichannelACBenchLayout : public MethodMultichannel {
+ public:
+    acbench::multichannel_ringbuffer<float> m_buffer;
+
+    explicit MethodMultichannelACBenchLayout(acbench::channel_layout layout, int nb_channels, int max_size, int nb_repeat)
+        : MethodMultichannel(layout == acbench::channel_layout::planar ? "ACBenchMultichannelPlanar" : "ACBenchMultichannelInterleaved", nb_channels, max_size, nb_repeat) {
+        m_buffer.resize_allocation(nb_channels, max_size, layout);
+    }
+
+    void clear() {
+        m_buffer.clear();
+    }
+
+    virtual void run_push_pull(float* const* chunks_push, int size_push, float* const* chunks_pull, int size_pull) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            while (m_buffer.size()+size_push <= m_max_size) {
+                m_buffer.push_back(chunks_push, size_push);
+            }
+            while (m_buffer.size() >= size_pull) {
+                m_buffer.pop_front(chunks_pull, size_pull);
+            }
+        }
+        m_elapsed.end(0.0f);
+    }
+
+    virtual int size() const {
+        return m_buffer.size();
+    }
+    virtual float value(int channel, int n) const {
+        return m_buffer(channel, n);
+    }
+};
+
+// STFT -----------------------------------------------------------------------
+
+/* Scenario: stft
+ * Analysis/synthesis loop of a short-time Fourier transform, without the transform itself:
+ * the chunks are pushed into an input ringbuffer, which is split into frames of frame_len values every hop values,
+ * each frame is multiplied by a window and overlap-added into an output ringbuffer,
+ * from which the hop values that are complete are pulled.
+ */
+class MethodSTFT : public Scenario {
+ public:
+    int m_frame_len = 0;
+    int m_hop = 0;
+    std::vector<float> m_window;
+    std::vector<float> m_frame;
+    acbench::ringbuffer<float> m_buffer_in;
+    acbench::ringbuffer<float> m_buffer_out;
+
+    explicit MethodSTFT(const std::string& name, int frame_len, int hop, int max_size, int nb_repeat)
+        : Scenario(name, nb_repeat)
+        , m_frame_len(frame_len)
+        , m_hop(hop)
+        , m_window(frame_len)
+        , m_frame(frame_len) {
+        for (int n = 0; n < frame_len; ++n)
+            m_window[n] = 0.5f - 0.5f*std::cos(2.0f*3.14159265f*n/frame_len);  // Hann
+        m_buffer_in.resize_allocation(frame_len+max_size);
+        m_buffer_out.resize_allocation(frame_len);
+    }
+
+    void clear() {
+        m_buffer_in.clear();
+        m_buffer_out.clear();
+    }
+
+    // chunk_pull must hold at least hop values
+    virtual void run(float* chunk_push, int size_push, float* chunk_pull) = 0;
+
+    bool compare(const MethodSTFT& ref) const {
+        return check_same(acbench::compare(ref.m_buffer_in, m_buffer_in) && acbench::compare(ref.m_buffer_out, m_buffer_out), ref);
+    }
+};
+
+// The frames are split and overlap-added with operator[] loops (the reference)
+class MethodSTFTACBenchOperator : public MethodSTFT {
+ public:
+    explicit MethodSTFTACBenchOperator(int frame_len, int hop, int max_size, int nb_repeat)
+        : MethodSTFT("ACBenchOperator", frame_len, hop, max_size, nb_repeat) {
+    }
+
+    virtual void run(float* chunk_push, int size_push, float* chunk_pull) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            m_buffer_in.push_back(chunk_push, size_push);
+            while (m_buffer_in.size() >= m_frame_len) {
+                for (int k = 0; k < m_frame_len; ++k)
+                    m_frame[k] = m_buffer_in[k]*m_window[k];
+                m_buffer_in.pop_front(m_hop);
+
+                int overlap = m_buffer_out.size();
+                for (int k = 0; k < overlap; ++k)
+                    m_buffer_out[k] += m_frame[k];
+                m_buffer_out.push_back(m_frame.data()+overlap, m_frame_len-overlap);
+                m_buffer_out.pop_front(chunk_pull, m_hop);
+            }
+        }
+        m_elapsed.end(0.0f);
+    }
+};
+
+// The frames are split with read_frame(.) and overlap-added with add_overlap(.)
+class MethodSTFTACBenchFrames : public MethodSTFT {
+ public:
+    explicit MethodSTFTACBenchFrames(int frame_len, int hop, int max_size, int nb_repeat)
+        : MethodSTFT("ACBenchFrames", frame_len, hop, max_size, nb_repeat) {
+    }
+
+    virtual void run(float* chunk_push, int size_push, float* chunk_pull) {
+        m_elapsed.start();
+        for (int n = 0; n < m_nb_repeat; ++n) {
+            m_buffer_in.push_back(chunk_push, size_push);
+            while (m_buffer_in.read_frame(m_frame.data(), m_frame_len, m_hop, m_window.data()) > 0) {
+                m_buffer_out.add_overlap(m_frame.data(), m_frame_len);
+                m_buffer_out.pop_front(chunk_pull, m_hop);
+            }
+        }
+        m_elapsed.end(0.0f);
+    }
+};
+
+
+// Sample formats -------------------------------------------------------------
+
+/* Scenario: convert
+ * Chunks of integer samples (as delivered by audio devices) are pushed into a ringbuffer<float>,
+ * and the same amount is pulled back as integer samples.
+ */
+template<typename S>
+class MethodConvert : public Scenario {
+ public:
+    acbench::ringbuffer<float, acbench::lock_none> m_buffer;
+
+    explicit MethodConvert(const std::string& name, int max_size, int nb_repeat)
+        : Scenario(name, nb_repeat) {
+        m_buffer.resize_allocation(max_size);
+    }
+
+    virtual void run_push_pull(const S* chunk_push, int size_push, S* chunk_pull, int size_pull) = 0;
+
+    bool compare(const MethodConvert& ref) const {
+        return this->check_same(acbench::compare(ref.m_buffer, m_buffer), ref);
+    }
+};
+
+// The samples are converted into a scratch array, which is then copied into the ringbuffer (and vice versa)
+template<typename S>
+class MethodConvertThenCopy : public MethodConvert<S> {
+ public:
+    std::vector<float> m_scratch;
+
+    explicit MethodConvertThenCopy(int max_size, int nb_repeat)
+        : MethodConvert<S>("ACBenchConvertThenCopy", max_size, nb_repeat)
+        , m_scratch(max_size) {
+    }
+
+    virtual void run_push_pull(const S* chunk_push, int size_push, S* chunk_pull, int size_pull) {
+        this->m_elapsed.start();
+        for (int n = 0; n < this->m_nb_repeat; ++n) {
+            acbench::convert_samples(m_scratch.data(), chunk_push, size_push);
+            this->m_buffer.push_back(m_scratch.data(), size_push);
+            int size = this->m_buffer.pop_front(m_scratch.data(), size_pull);
+            acbench::convert_samples(chunk_pull, m_scratch.data(), size);
+        }
+        this->m_elapsed.end(0.0f);
+    }
+};
+
+// The samples are converted while copied into and out of the ringbuffer
+template<typename S>
+class MethodConverting : public MethodConvert<S> {
+ public:
+    explicit MethodConverting(int max_size, int nb_repeat)
+        : MethodConvert<S>("ACBenchConverting", max_size, nb_repeat) {
+    }
+
+    virtual void run_push_pull(const S* chunk_push, int size_push, S* chunk_pull, int size_pull) {
+        this->m_elapsed.start();
+        for (int n = 0; n < this->m_nb_repeat; ++n) {
+            this->m_buffer.push_back(chunk_push, size_push);
+            this->m_buffer.pop_front(chunk_pull, size_pull);
+        }
+        this->m_elapsed.end(0.0f);
+    }
+};
+
+// Large ----------------------------------------------------------------------
+
+/* Scenario: large
+ * A 64MB ringbuffer kept half full, so that the values are popped long after they were pushed (ex. a long delay line or
+ * a recording buffer), with a consumer thread that pops what is above half full and runs over its own working set
+ * (ex. the states of its processing), concurrently with the pushes of the producer.
+ * The pushes of the producer are measured (m_elapsed), as well as the passes of the consumer over its working set
+ * (m_elapsed_consumer), whose cache misses increase when the pushes evict the working set from the shared caches.
+ * The hardware counters of the consumer are sampled where available (see consumer_counters()),
+ * otherwise only the durations of its passes are measured, which are slowed down by the misses.
+ */
+class MethodLarge : public Scenario {
+ public:
+    acbench::ringbuffer<float> m_buffer;
+    acbench::time_elapsed m_elapsed_consumer;
+    std::vector<float> m_working_set;
+    std::vector<float> m_chunk_pull;
+    int m_size_kept = 0;
+    float m_working_acc = 0.0f;  // Output of the consumer's processing, so that the compiler can't remove the reads
+
+    enum {state_idle = 0, state_running, state_finishing, state_stop};
+    std::thread m_consumer;
+    std::atomic<int> m_state;
+    std::atomic<int> m_nb_passes;            // Passes started by the consumer since the start of the current run(.)
+    std::atomic<int> m_consumer_counters;    // -1 until the consumer has tried to enable its counters, then 0 or 1
+
+    explicit MethodLarge(const std::string& name, int size_max, int working_set_size, int chunk_size_max, int stream_threshold)
+        : Scenario(name, 1)
+        , m_working_set(working_set_size)
+        , m_chunk_pull(chunk_size_max)
+        , m_size_kept(size_max/2)
+        , m_state(state_idle)
+        , m_nb_passes(0)
+        , m_consumer_counters(-1) {
+        m_buffer.resize_allocation(size_max);
+        m_buffer.set_stream_threshold(stream_threshold);
+        m_buffer.push_back(0.0f, m_size_kept);
+        for (auto& v : m_working_set)
+            v = acbench::rand_uniform_continuous_01<float>();
+        m_consumer = std::thread(&MethodLarge::consume, this);
+    }
+    virtual ~MethodLarge() {
+        m_state.store(state_stop);
+        m_consumer.join();
+    }
+
+    virtual void write_file(const std::string& tag) const {
+        write_elapsed(m_name, tag, m_elapsed, m_nb_repeat);
+        write_elapsed(m_name, tag+"_consumer", m_elapsed_consumer, m_nb_repeat);
+    }
+
+    //! True if the hardware counters of the consumer are measured (waits for the consumer thread to try).
+    bool consumer_counters() const {
+        int counters;
+        while ((counters = m_consumer_counters.load()) < 0)
+            std::this_thread::yield();
+        return counters > 0;
+    }
+
+    void consume() {
+        // The counters measure the thread that enables them
+        m_consumer_counters.store(m_elapsed_consumer.enable_counters() ? 1 : 0);
+
+        while (true) {
+            int state;
+            while ((state = m_state.load()) == state_idle)
+                std::this_thread::yield();
+            if (state == state_stop)
+                return;
+
+            while (m_state.load() == state_running) {
+                int size_above = m_buffer.size()-m_size_kept;
+                if (size_above > 0)
+                    m_buffer.pop_front(m_chunk_pull.data(), std::min(size_above, static_cast<int>(m_chunk_pull.size())));
+
+                m_nb_passes.fetch_add(1);
+                m_elapsed_consumer.start();
+                // Vectorized, so that the pass is bound by the memory accesses rather than by the additions
+                m_working_acc += acbench::simd::sum(m_working_set.data(), static_cast<int>(m_working_set.size()));
+                m_elapsed_consumer.end(0.0f);
+            }
+
+            m_state.store(state_idle);
+        }
+    }
+
+    //! Pushes nb_chunks times the chunk, from the start of a pass of the consumer over its working set,
+    //  then waits for the consumer to pop the ringbuffer down to half full.
+    void run(const float* chunk, int size, int nb_chunks) {
+        m_nb_passes.store(0);
+        m_state.store(state_running);
+        while (m_nb_passes.load() == 0)
+            std::this_thread::yield();
+
+        for (int n = 0; n < nb_chunks; ++n) {
+            while (m_buffer.size()+size > m_buffer.size_max())
+                std::this_thread::yield();
+            m_elapsed.start();
+            m_buffer.push_back(chunk, size);
+            m_elapsed.end(0.0f);
+        }
+        while (m_buffer.size() > m_size_kept)
+            std::this_thread::yield();
+
+        m_state.store(state_finishing);
+        while (m_state.load() != state_idle)
+            std::this_thread::yield();
+    }
+
+    void reset() {
+        m_elapsed.reset();
+        m_elapsed_consumer.reset();
+    }
+
+    //! The ringbuffers are back to half full after each run(.), with the last values pushed.
+    bool compare(const MethodLarge& ref) const {
+        return check_same(acbench::compare(ref.m_buffer, m_buffer), ref);
+    }
+};
+
+// Mixer ----------------------------------------------------------------------
+
+/* Scenario: mixer
+ * A block is pushed into each of nb_buffers ringbuffers (not measured), then all the ringbuffers are drained
+ * and summed into a single output block (measured). The elapsed time is the latency of one block.
+ */
+class MethodMixer : public Scenario {
+ public:
+    int m_nb_buffers = 0;
+    std::vector<float> m_out;
+
+    // A single block per measure
+    explicit MethodMixer(const std::string& name, int nb_buffers, int max_size)
+        : Scenario(name, 1)
+        , m_nb_buffers(nb_buffers)
+        , m_out(max_size) {
+    }
+
+    // chunks holds one block of size values per ringbuffer
+    virtual void run(const float* const* chunks, int size) = 0;
+
+    bool compare(const MethodMixer& ref) const {
+        return check_same(acbench::compare(ref.m_out, m_out), ref);
+    }
+};
+
+// One acbench::ringbuffer (and one mutex) per source, each one locked and popped in turn
+class MethodMixerACBenchSeparate : public MethodMixer {
+ public:
+    std::vector<acbench::ringbuffer<float>*> m_buffers;
+    std::vector<float> m_scratch;
+
+    explicit MethodMixerACBenchSeparate(int nb_buffers, int max_size)
+        : MethodMixer("ACBenchSeparate", nb_buffers, max_size)
+        , m_scratch(max_size) {
+        for (int i = 0; i < nb_buffers; ++i) {
+            m_buffers.push_back(new acbench::ringbuffer<float>());
+            m_buffers.back()->resize_allocation(max_size);
+        }
+    }
+    virtual ~MethodMixerACBenchSeparate() {
+        for (auto pbuffer : m_buffers)
+            delete pbuffer;
+    }
+
+    virtual void run(const float* const* chunks, int size) {
+        for (int i = 0; i < m_nb_buffers; ++i)
+            m_buffers[i]->push_back(chunks[i], size);
+
+        m_elapsed.start();
+        std::fill(m_out.begin(), m_out.begin()+size, 0.0f);
+        for (int i = 0; i < m_nb_buffers; ++i) {
+            int popped = m_buffers[i]->pop_front(m_scratch.data(), size);
+            acbench::simd::multiply_accumulate(m_out.data(), m_scratch.data(), 1.0f, popped);
+        }
+        m_elapsed.end(0.0f);
+    }
+};
+
+// acbench::ringbuffer_group, popped with pop_front_many(.) (a single lock), then summed
+class MethodMixerACBenchGroup : public MethodMixer {
+ public:
+    acbench::ringbuffer_group<float> m_group;
+    std::vector<std::vector<float>> m_scratches;
+    std::vector<float*> m_pscratches;
+    std::vector<int> m_sizes;
+
+    explicit MethodMixerACBenchGroup(int nb_buffers, int max_size)
+        : MethodMixer("ACBenchGroup", nb_buffers, max_size)
+        , m_scratches(nb_buffers, std::vector<float>(max_size))
+        , m_sizes(nb_buffers) {
+        m_group.resize_allocation(nb_buffers, max_size);
+        for (int i = 0; i < nb_buffers; ++i)
+            m_pscratches.push_back(m_scratches[i].data());
+    }
+
+    virtual void run(const float* const* chunks, int size) {
+        m_group.push_back_many(chunks, size);
+
+        m_elapsed.start();
+        m_group.pop_front_many(m_pscratches.data(), size, m_sizes.data());
+        std::fill(m_out.begin(), m_out.begin()+size, 0.0f);
+        for (int i = 0; i < m_nb_buffers; ++i)
+            acbench::simd::multiply_accumulate(m_out.data(), m_pscratches[i], 1.0f, m_sizes[i]);
+        m_elapsed.end(0.0f);
+    }
+};
+
+// acbench::ringbuffer_group, mixed with pop_front_mix(.) (a single lock, no intermediate copies)
+class MethodMixerACBenchGroupMix : public MethodMixer {
+ public:
+    acbench::ringbuffer_group<float> m_group;
+
+    explicit MethodMixerACBenchGroupMix(int nb_buffers, int max_size)
+        : MethodMixer("ACBenchGroupMix", nb_buffers, max_size) {
+        m_group.resize_allocation(nb_buffers, max_size);
+    }
+
+    virtual void run(const float* const* chunks, int size) {
+        m_group.push_back_many(chunks, size);
+
+        m_elapsed.start();
+        m_group.pop_front_mix(m_out.data(), size);
+        m_elapsed.end(0.0f);
+    }
 };
 
 #endif  // ACBENCH_METHODS_H_
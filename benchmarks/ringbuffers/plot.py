@@ -6,6 +6,7 @@
 # If not, please visit:
 #     https://github.com/gillesdegottex/acbench
 
+import os
 import glob
 import numpy as np
 import math
@@ -38,16 +39,81 @@ def getlinestyle(method):
     if method=='ACBench':
         color = 'green'
         marker = '^'
+    if method=='ACBenchNoLock':
+        color = 'lime'
+        marker = '<'
+    if method=='ACBenchSpinlock':
+        color = 'olive'
+        marker = 's'
+    if method=='ACBenchAligned':
+        color = 'springgreen'
+        marker = 'p'
+    if method=='ACBenchHugePages':
+        color = 'seagreen'
+        marker = 'P'
+    if method=='ACBenchMlock':
+        color = 'yellowgreen'
+        marker = 'X'
+    if method=='ACBenchStatic':
+        color = 'darkkhaki'
+        marker = 'H'
+    if method=='ACBenchSPSC':
+        color = 'darkgreen'
+        marker = '>'
+    if method=='ACBenchMirrored':
+        color = 'teal'
+        marker = 'D'
+    if method=='ACBenchBlock':
+        color = 'orange'
+        marker = '*'
+    if method=='ACBenchChannels':
+        color = 'green'
+        marker = '^'
+    if method=='ACBenchMultichannelPlanar':
+        color = 'cyan'
+        marker = 'h'
+    if method=='ACBenchMultichannelInterleaved':
+        color = 'purple'
+        marker = 'd'
+    if method=='ACBenchOperator':
+        color = 'green'
+        marker = '^'
+    if method=='ACBenchFrames':
+        color = 'orange'
+        marker = '*'
+    if method=='ACBenchSeparate':
+        color = 'green'
+        marker = '^'
+    if method=='ACBenchGroup':
+        color = 'cyan'
+        marker = 'h'
+    if method=='ACBenchGroupMix':
+        color = 'orange'
+        marker = '*'
+    if method=='ACBenchLarge':
+        color = 'green'
+        marker = '^'
+    if method=='ACBenchLargeStream':
+        color = 'orange'
+        marker = '*'
+    if method=='ACBenchConvertThenCopy':
+        color = 'green'
+        marker = '^'
+    if method=='ACBenchConverting':
+        color = 'orange'
+        marker = '*'
 
     return color, marker
 
-plt.figure(figsize=(6,12))
+plt.figure(figsize=(6,18))
 
-for scenarion, scenario in enumerate(['push_back_array', 'push_pull_array']):
-    plt.subplot(2,1,1+scenarion)
+for scenarion, scenario in enumerate(['push_back_array', 'push_pull_array', 'push_pull_inplace']):
+    plt.subplot(3,1,1+scenarion)
 
-    for method in ['FastestBound', 'STL', 'Boost', 'Portaudio', 'RubberBand', 'Jack', 'ACBench']:
-        chunk_sizes = np.sort([int(el[len(f"STL_{scenario}_"):-12]) for el in glob.glob(f'STL_{scenario}_*')])
+    for method in ['FastestBound', 'STL', 'Boost', 'Portaudio', 'RubberBand', 'Jack', 'ACBench', 'ACBenchNoLock', 'ACBenchSpinlock', 'ACBenchAligned', 'ACBenchHugePages', 'ACBenchMlock', 'ACBenchStatic', 'ACBenchSPSC', 'ACBenchMirrored', 'ACBenchBlock']:
+        if len(glob.glob(f'{method}_{scenario}_*_elapsed.bin'))==0:
+            continue  # Not run on this platform (ex. ACBenchMirrored outside Linux)
+        chunk_sizes = np.sort([int(el[len(f"STL_{scenario}_"):-12]) for el in glob.glob(f'STL_{scenario}_*_elapsed.bin')])
         elapseds = {}
         centiles = [5, 50, 95]
         for centile in centiles:
@@ -79,6 +145,8 @@ for scenarion, scenario in enumerate(['push_back_array', 'push_pull_array']):
         plt.ylim([-2.0, 2.0])
     elif scenario=='push_pull_array':
         plt.ylim([-2.0, 2.0])
+    elif scenario=='push_pull_inplace':
+        plt.ylim([-2.0, 2.0])
     plt.xlabel('Chunk size [samples]')
     plt.ylabel('Processing time [log10 ns/sample]')
     # plt.ylabel('Speed [GFLOPS]')
@@ -87,4 +155,364 @@ for scenarion, scenario in enumerate(['push_back_array', 'push_pull_array']):
 
 plt.savefig('results.png')
 
+# Scenario: push_pull_block, the reference being the same pushes and pops with sizes known at run time
+plt.figure(figsize=(6,6))
+
+scenario = 'push_pull_block'
+for method in ['FastestBound', 'ACBenchNoLock', 'ACBenchBlock']:
+    chunk_sizes = np.sort([int(el[len(f"ACBenchNoLock_{scenario}_"):-12]) for el in glob.glob(f'ACBenchNoLock_{scenario}_*_elapsed.bin')])
+    elapseds = {}
+    centiles = [5, 50, 95]
+    for centile in centiles:
+        elapseds[f'cent{centile}'] = []
+    for chunk_size in chunk_sizes:
+        file_path = f'{method}_{scenario}_{chunk_size}_elapsed.bin'
+        elapsed = np.fromfile(file_path, dtype=np.float32)
+        elapsed *= 1e9  # [s] to [ns]
+        elapsed /= chunk_size  # [ns] to [ns/sample]
+        elapsed = np.sort(elapsed)
+        for centile in centiles:
+            elapseds[f'cent{centile}'].append(np.quantile(elapsed,centile/100.0))
+
+    color, marker = getlinestyle(method)
+
+    plt.fill_between(chunk_sizes, np.log10(elapseds[f'cent{centiles[0]}']), np.log10(elapseds[f'cent{centiles[-1]}']), facecolor=color, alpha=0.5)
+    plt.plot(chunk_sizes, np.log10(elapseds['cent50']), label=method, color=color, marker=marker)
+
+plt.legend(loc='upper right')
+plt.grid()
+plt.xscale('log', base=2)
+plt.xlabel('Block size [samples]')
+plt.ylabel('Processing time [log10 ns/sample]')
+plt.title(f'{scenario} (block sizes known at compile time)')
+plt.gcf().suptitle(f'{get_processor_name()}')
+
+plt.savefig('results_block.png')
+
+# Hot vs. cold caches (see the --cold option of benchmark_ringbuffers), side by side, if the cold results are there
+if len(glob.glob('STL_cold_push_pull_array_*'))>0:
+    plt.figure(figsize=(12,24))
+
+    for scenarion, scenario in enumerate(['push_back_array', 'push_pull_array', 'push_pull_block', 'push_pull_inplace']):
+        for cachen, cache in enumerate(['hot', 'cold']):
+            plt.subplot(4,2,1+2*scenarion+cachen)
+            tag = scenario if cache=='hot' else f'cold_{scenario}'
+
+            for method in ['FastestBound', 'STL', 'Boost', 'Portaudio', 'RubberBand', 'Jack', 'ACBench', 'ACBenchNoLock', 'ACBenchSPSC', 'ACBenchMirrored', 'ACBenchBlock']:
+                if len(glob.glob(f'{method}_{tag}_*_elapsed.bin'))==0:
+                    continue
+                chunk_sizes = np.sort([int(el[len(f"STL_{tag}_"):-12]) for el in glob.glob(f'STL_{tag}_*_elapsed.bin')])
+                elapseds = {}
+                centiles = [5, 50, 95]
+                for centile in centiles:
+                    elapseds[f'cent{centile}'] = []
+                for chunk_size in chunk_sizes:
+                    file_path = f'{method}_{tag}_{chunk_size}_elapsed.bin'
+                    elapsed = np.fromfile(file_path, dtype=np.float32)
+                    elapsed *= 1e9  # [s] to [ns]
+                    elapsed /= chunk_size  # [ns] to [ns/sample]
+                    for centile in centiles:
+                        elapseds[f'cent{centile}'].append(np.quantile(elapsed,centile/100.0))
+
+                color, marker = getlinestyle(method)
+
+                plt.fill_between(chunk_sizes, np.log10(elapseds[f'cent{centiles[0]}']), np.log10(elapseds[f'cent{centiles[-1]}']), facecolor=color, alpha=0.5)
+                plt.plot(chunk_sizes, np.log10(elapseds['cent50']), label=method, color=color, marker=marker)
+
+            plt.legend(loc='upper right')
+            plt.grid()
+            plt.ylim([-2.0, 3.0])  # Same range for hot and cold, to compare them
+            plt.xlabel('Chunk size [samples]')
+            plt.ylabel('Processing time [log10 ns/sample]')
+            plt.title(f'{scenario} ({cache} caches)')
+    plt.gcf().suptitle(f'{get_processor_name()}')
+
+    plt.savefig('results_cold.png')
+
+# Hardware counters of push_pull_array (see the --counters option of benchmark_ringbuffers), if they were measured
+if len(glob.glob('STL_push_pull_array_*_cycles.bin'))>0:
+    plt.figure(figsize=(6,18))
+
+    scenario = 'push_pull_array'
+    chunk_sizes = np.sort([int(el[len(f"STL_{scenario}_"):-12]) for el in glob.glob(f'STL_{scenario}_*_elapsed.bin')])
+    for plotn, (title, numerator, denominator) in enumerate([('Instructions per cycle', 'instructions', 'cycles'), ('L1d misses', 'l1d_misses', None), ('Branch misses', 'branch_misses', None)]):
+        plt.subplot(3,1,1+plotn)
+        for method in ['FastestBound', 'STL', 'Boost', 'Portaudio', 'RubberBand', 'Jack', 'ACBench', 'ACBenchNoLock', 'ACBenchSPSC', 'ACBenchMirrored', 'ACBenchBlock']:
+            medians = []
+            for chunk_size in chunk_sizes:
+                if not os.path.exists(f'{method}_{scenario}_{chunk_size}_{numerator}.bin'):
+                    break
+                values = np.fromfile(f'{method}_{scenario}_{chunk_size}_{numerator}.bin', dtype=np.float32)
+                if denominator is None:
+                    values /= chunk_size  # [count] to [count/sample]
+                else:
+                    values /= np.maximum(np.fromfile(f'{method}_{scenario}_{chunk_size}_{denominator}.bin', dtype=np.float32), 1.0)
+                medians.append(np.median(values))
+            if len(medians)==len(chunk_sizes):
+                color, marker = getlinestyle(method)
+                plt.plot(chunk_sizes, medians, label=method, color=color, marker=marker)
+        plt.legend(loc='upper right')
+        plt.grid()
+        plt.xlabel('Chunk size [samples]')
+        plt.ylabel(title if denominator is not None else f'{title} per sample')
+        plt.title(f'{scenario} ({title.lower()}, median)')
+    plt.gcf().suptitle(f'{get_processor_name()}')
+
+    plt.savefig('results_counters.png')
+
+# Scenario: threads, the latency histograms from push to pull (the throughputs being in the legend)
+plt.figure(figsize=(6,12))
+
+for chunk_sizen, chunk_size in enumerate([64, 512]):
+    plt.subplot(2,1,1+chunk_sizen)
+    scenario = f'threads_{chunk_size}'
+
+    for method in ['FastestBound', 'STL', 'Boost', 'Portaudio', 'RubberBand', 'Jack', 'ACBench', 'ACBenchNoLock', 'ACBenchSpinlock', 'ACBenchAligned', 'ACBenchHugePages', 'ACBenchMlock', 'ACBenchStatic', 'ACBenchSPSC', 'ACBenchMirrored', 'ACBenchBlock']:
+        file_path = f'{method}_{scenario}_latency.bin'
+        if not os.path.exists(file_path):
+            continue
+        latency = np.fromfile(file_path, dtype=np.float32)
+        latency *= 1e6  # [s] to [us]
+        throughput = np.fromfile(f'{method}_{scenario}_throughput.bin', dtype=np.float32)[0]
+
+        color, marker = getlinestyle(method)
+
+        hist, bin_edges = np.histogram(np.log10(latency), bins=100, range=[-1.0, 3.0], density=True)
+        plt.plot((bin_edges[:-1]+bin_edges[1:])/2, hist, label=f'{method} ({throughput*1e-6:.0f}M values/s)', color=color)
+
+    plt.legend(loc='upper right', fontsize='small')
+    plt.grid()
+    plt.xlabel('Latency from push to pull [log10 us]')
+    plt.ylabel('Density')
+    plt.title(f'{scenario} (one producer and one consumer thread)')
+    plt.gcf().suptitle(f'{get_processor_name()}')
+
+plt.savefig('results_threads.png')
+
+# Scenario: callback, the histograms of the callbacks' durations from their scheduled wake-up (the deadline misses being in the legend)
+plt.figure(figsize=(6,12))
+
+for block_sizen, block_size in enumerate([64, 256]):
+    plt.subplot(2,1,1+block_sizen)
+    scenario = f'callback_{block_size}'
+    deadline = 1e6*block_size/48000.0  # [us]
+
+    for method in ['FastestBound', 'STL', 'Boost', 'Portaudio', 'RubberBand', 'Jack', 'ACBench', 'ACBenchNoLock', 'ACBenchSpinlock', 'ACBenchAligned', 'ACBenchHugePages', 'ACBenchMlock', 'ACBenchStatic', 'ACBenchSPSC', 'ACBenchMirrored', 'ACBenchBlock']:
+        file_path = f'{method}_{scenario}_elapsed.bin'
+        if not os.path.exists(file_path):
+            continue
+        elapsed = np.fromfile(file_path, dtype=np.float32)
+        elapsed *= 1e6  # [s] to [us]
+        nb_misses = np.sum(elapsed > deadline)
+
+        color, marker = getlinestyle(method)
+
+        hist, bin_edges = np.histogram(np.log10(elapsed), bins=100, range=[0.0, 4.0], density=True)
+        plt.plot((bin_edges[:-1]+bin_edges[1:])/2, hist, label=f'{method} ({nb_misses}/{len(elapsed)} missed)', color=color)
+
+    plt.axvline(np.log10(deadline), color='black', linestyle='--')
+    plt.legend(loc='upper right', fontsize='small')
+    plt.grid()
+    plt.xlabel('Wake-up to completion [log10 us]')
+    plt.ylabel('Density')
+    plt.title(f'{scenario} (period {deadline/1e3:.2f}ms at 48kHz, with cache pollution)')
+    plt.gcf().suptitle(f'{get_processor_name()}')
+
+plt.savefig('results_callback.png')
+
+# Scenario: multichannel, the reference being one ringbuffer per channel
+plt.figure(figsize=(6,18))
+
+for nb_channelsn, nb_channels in enumerate([2, 8, 64]):
+    plt.subplot(3,1,1+nb_channelsn)
+    scenario = f'multichannel{nb_channels}'
+
+    for method in ['ACBenchChannels', 'ACBenchMultichannelPlanar', 'ACBenchMultichannelInterleaved']:
+        chunk_sizes = np.sort([int(el[len(f"ACBenchChannels_{scenario}_"):-12]) for el in glob.glob(f'ACBenchChannels_{scenario}_*')])
+        elapseds = {}
+        centiles = [5, 50, 95]
+        for centile in centiles:
+            elapseds[f'cent{centile}'] = []
+        for chunk_size in chunk_sizes:
+            file_path = f'{method}_{scenario}_{chunk_size}_elapsed.bin'
+            elapsed = np.fromfile(file_path, dtype=np.float32)
+            elapsed *= 1e9  # [s] to [ns]
+            elapsed /= chunk_size  # [ns] to [ns/frame]
+            elapsed = np.sort(elapsed)
+            for centile in centiles:
+                elapseds[f'cent{centile}'].append(np.quantile(elapsed,centile/100.0))
+
+        color, marker = getlinestyle(method)
+
+        plt.fill_between(chunk_sizes, np.log10(elapseds[f'cent{centiles[0]}']), np.log10(elapseds[f'cent{centiles[-1]}']), facecolor=color, alpha=0.5)
+        plt.plot(chunk_sizes, np.log10(elapseds['cent50']), label=method, color=color, marker=marker)
+
+    plt.legend(loc='upper right')
+    plt.grid()
+    plt.xlabel('Chunk size [frames]')
+    plt.ylabel('Processing time [log10 ns/frame]')
+    plt.title(f'{scenario} ({nb_channels} channels)')
+    plt.gcf().suptitle(f'{get_processor_name()}')
+
+plt.savefig('results_multichannel.png')
+
+# Scenario: stft, the reference being operator[] loops
+plt.figure(figsize=(6,18))
+
+for frame_lenn, frame_len in enumerate([256, 1024, 4096]):
+    plt.subplot(3,1,1+frame_lenn)
+    scenario = f'stft{frame_len}'
+
+    for method in ['ACBenchOperator', 'ACBenchFrames']:
+        chunk_sizes = np.sort([int(el[len(f"ACBenchOperator_{scenario}_"):-12]) for el in glob.glob(f'ACBenchOperator_{scenario}_*')])
+        elapseds = {}
+        centiles = [5, 50, 95]
+        for centile in centiles:
+            elapseds[f'cent{centile}'] = []
+        for chunk_size in chunk_sizes:
+            file_path = f'{method}_{scenario}_{chunk_size}_elapsed.bin'
+            elapsed = np.fromfile(file_path, dtype=np.float32)
+            elapsed *= 1e9  # [s] to [ns]
+            elapsed /= chunk_size  # [ns] to [ns/sample]
+            elapsed = np.sort(elapsed)
+            for centile in centiles:
+                elapseds[f'cent{centile}'].append(np.quantile(elapsed,centile/100.0))
+
+        color, marker = getlinestyle(method)
+
+        plt.fill_between(chunk_sizes, np.log10(elapseds[f'cent{centiles[0]}']), np.log10(elapseds[f'cent{centiles[-1]}']), facecolor=color, alpha=0.5)
+        plt.plot(chunk_sizes, np.log10(elapseds['cent50']), label=method, color=color, marker=marker)
+
+    plt.legend(loc='upper right')
+    plt.grid()
+    plt.xlabel('Chunk size [samples]')
+    plt.ylabel('Processing time [log10 ns/sample]')
+    plt.title(f'{scenario} (frames of {frame_len} samples, hop of {frame_len//4})')
+    plt.gcf().suptitle(f'{get_processor_name()}')
+
+plt.savefig('results_stft.png')
+
+# Scenario: convert, the reference being a conversion in a scratch array
+plt.figure(figsize=(6,18))
+
+for formatn, format in enumerate(['int16', 'int24', 'int32']):
+    plt.subplot(3,1,1+formatn)
+    scenario = f'convert_{format}'
+
+    for method in ['ACBenchConvertThenCopy', 'ACBenchConverting']:
+        chunk_sizes = np.sort([int(el[len(f"ACBenchConverting_{scenario}_"):-12]) for el in glob.glob(f'ACBenchConverting_{scenario}_*')])
+        elapseds = {}
+        centiles = [5, 50, 95]
+        for centile in centiles:
+            elapseds[f'cent{centile}'] = []
+        for chunk_size in chunk_sizes:
+            file_path = f'{method}_{scenario}_{chunk_size}_elapsed.bin'
+            elapsed = np.fromfile(file_path, dtype=np.float32)
+            elapsed *= 1e9  # [s] to [ns]
+            elapsed /= chunk_size  # [ns] to [ns/sample]
+            elapsed = np.sort(elapsed)
+            for centile in centiles:
+                elapseds[f'cent{centile}'].append(np.quantile(elapsed,centile/100.0))
+
+        color, marker = getlinestyle(method)
+
+        plt.fill_between(chunk_sizes, np.log10(elapseds[f'cent{centiles[0]}']), np.log10(elapseds[f'cent{centiles[-1]}']), facecolor=color, alpha=0.5)
+        plt.plot(chunk_sizes, np.log10(elapseds['cent50']), label=method, color=color, marker=marker)
+
+    plt.legend(loc='upper right')
+    plt.grid()
+    plt.xlabel('Chunk size [samples]')
+    plt.ylabel('Processing time [log10 ns/sample]')
+    plt.title(f'{scenario} (push_back then pop_front, {format} samples into a float ringbuffer)')
+    plt.gcf().suptitle(f'{get_processor_name()}')
+
+plt.savefig('results_convert.png')
+
+# Scenario: mixer, the reference being one locked ringbuffer per source
+plt.figure(figsize=(6,18))
+
+for nb_buffersn, nb_buffers in enumerate([32, 64, 128]):
+    plt.subplot(3,1,1+nb_buffersn)
+    scenario = f'mixer{nb_buffers}'
+
+    for method in ['ACBenchSeparate', 'ACBenchGroup', 'ACBenchGroupMix']:
+        chunk_sizes = np.sort([int(el[len(f"ACBenchSeparate_{scenario}_"):-12]) for el in glob.glob(f'ACBenchSeparate_{scenario}_*')])
+        elapseds = {}
+        centiles = [5, 50, 95]
+        for centile in centiles:
+            elapseds[f'cent{centile}'] = []
+        for chunk_size in chunk_sizes:
+            file_path = f'{method}_{scenario}_{chunk_size}_elapsed.bin'
+            elapsed = np.fromfile(file_path, dtype=np.float32)
+            elapsed *= 1e9  # [s] to [ns], per block
+            elapsed = np.sort(elapsed)
+            for centile in centiles:
+                elapseds[f'cent{centile}'].append(np.quantile(elapsed,centile/100.0))
+
+        color, marker = getlinestyle(method)
+
+        plt.fill_between(chunk_sizes, np.log10(elapseds[f'cent{centiles[0]}']), np.log10(elapseds[f'cent{centiles[-1]}']), facecolor=color, alpha=0.5)
+        plt.plot(chunk_sizes, np.log10(elapseds['cent50']), label=method, color=color, marker=marker)
+
+    plt.legend(loc='upper left')
+    plt.grid()
+    plt.xlabel('Block size [samples]')
+    plt.ylabel('Latency [log10 ns/block]')
+    plt.title(f'{scenario} ({nb_buffers} sources mixed per block)')
+    plt.gcf().suptitle(f'{get_processor_name()}')
+
+plt.savefig('results_mixer.png')
+
+# Scenario: large, the reference being the pushes through the caches (memcpy)
+# The consumer's cache misses per pass if its hardware counters were available, otherwise the durations of its passes
+consumer_measures = [measure for measure in ['l1d_misses', 'llc_misses'] if glob.glob(f'ACBenchLarge_large_*_consumer_{measure}.bin')]
+if not consumer_measures:
+    consumer_measures = ['elapsed']
+plots = [('', 'elapsed')] + [('_consumer', measure) for measure in consumer_measures]
+plt.figure(figsize=(6,6*len(plots)))
+
+for plotn, (consumer, measure) in enumerate(plots):
+    plt.subplot(len(plots),1,1+plotn)
+    scenario = 'large'
+
+    for method in ['ACBenchLarge', 'ACBenchLargeStream']:
+        chunk_sizes = np.sort([int(el[len(f"ACBenchLarge_{scenario}_"):-12]) for el in glob.glob(f'ACBenchLarge_{scenario}_*[0-9]_elapsed.bin')])
+        elapseds = {}
+        centiles = [5, 50, 95]
+        for centile in centiles:
+            elapseds[f'cent{centile}'] = []
+        for chunk_size in chunk_sizes:
+            file_path = f'{method}_{scenario}_{chunk_size}{consumer}_{measure}.bin'
+            elapsed = np.fromfile(file_path, dtype=np.float32)
+            if measure != 'elapsed':
+                elapsed = np.log10(1.0+elapsed)  # Misses per pass over the working set
+            elif consumer:
+                elapsed = np.log10(elapsed*1e6)  # [s] to [us], per pass over the working set
+            else:
+                elapsed = np.log10(elapsed*1e9/chunk_size)  # [s] to [ns/sample]
+            elapsed = np.sort(elapsed)
+            for centile in centiles:
+                elapseds[f'cent{centile}'].append(np.quantile(elapsed,centile/100.0))
+
+        color, marker = getlinestyle(method)
+
+        plt.fill_between(chunk_sizes, elapseds[f'cent{centiles[0]}'], elapseds[f'cent{centiles[-1]}'], facecolor=color, alpha=0.5)
+        plt.plot(chunk_sizes, elapseds['cent50'], label=method, color=color, marker=marker)
+
+    plt.legend(loc='upper right')
+    plt.grid()
+    plt.xlabel('Chunk size [samples]')
+    if measure != 'elapsed':
+        plt.ylabel(f'Consumer {measure} [log10 per pass]')
+        plt.title(f'{scenario} (consumer, pass over its 1MB working set)')
+    elif consumer:
+        plt.ylabel('Consumer pass [log10 us]')
+        plt.title(f'{scenario} (consumer, pass over its 1MB working set)')
+    else:
+        plt.ylabel('Processing time [log10 ns/sample]')
+        plt.title(f'{scenario} (producer, push_back into a 64MB ringbuffer)')
+    plt.gcf().suptitle(f'{get_processor_name()}')
+
+plt.savefig('results_large.png')
+
 from IPython.core.debugger import  Pdb; Pdb().set_trace()
@@ -0,0 +1,187 @@
+// Copyright (C) 2024 Gilles Degottex - All Rights Reserved
+//
+// You may use, distribute and modify this code under the
+// terms of the Apache 2.0 license. You should have
+// received a copy of this license with this file.
+// If not, please visit:
+//     https://github.com/gillesdegottex/acbench
+
+// Benchmark of the instantiation of many ringbuffers at once (ex. when a plugin host instantiates a processing graph),
+// with one heap allocation per ringbuffer (allocator_new, allocator_aligned) compared to a single arena shared by
+// all of them (allocator_arena, see acbench/allocators.h).
+// Each run instantiates all the ringbuffers, runs a first block through each of them (which faults their first pages in),
+// and destroys them.
+
+#include <acbench/ringbuffer.h>
+#include <acbench/allocators.h>
+#include <acbench/time_elapsed.h>
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <iostream>
+
+#include "../ext/cxxopts/include/cxxopts.hpp"  // TODO(GD) Very slow compilation
+
+class Startup {
+ public:
+    std::string m_name;
+    acbench::time_elapsed m_elapsed_instantiate;
+    acbench::time_elapsed m_elapsed_first_block;
+    acbench::time_elapsed m_elapsed_destroy;
+    float m_checksum = 0.0f;
+
+    explicit Startup(const std::string& name, int nb_iter)
+        : m_name(name)
+        , m_elapsed_instantiate(nb_iter+1)
+        , m_elapsed_first_block(nb_iter+1)
+        , m_elapsed_destroy(nb_iter+1) {
+    }
+    virtual ~Startup() {}
+
+    virtual void instantiate(int nb_buffers, int size_max) = 0;
+    virtual void first_block(const std::vector<float>& block, std::vector<float>* out) = 0;
+    virtual void destroy() = 0;
+
+    void run(int nb_buffers, int size_max, const std::vector<float>& block, std::vector<float>* out) {
+        m_elapsed_instantiate.start();
+        instantiate(nb_buffers, size_max);
+        m_elapsed_instantiate.end(0.0f);
+
+        m_elapsed_first_block.start();
+        first_block(block, out);
+        m_elapsed_first_block.end(0.0f);
+
+        m_elapsed_destroy.start();
+        destroy();
+        m_elapsed_destroy.end(0.0f);
+    }
+};
+
+template<typename Allocator>
+class StartupAllocator : public Startup {
+ public:
+    typedef acbench::ringbuffer<float, acbench::lock_none, Allocator> ringbuffer_t;
+    std::vector<ringbuffer_t> m_buffers;
+
+    explicit StartupAllocator(const std::string& name, int nb_iter)
+        : Startup(name, nb_iter) {
+    }
+
+    virtual Allocator make_allocator(int nb_buffers, int size_max) {
+        (void)nb_buffers;
+        (void)size_max;
+        return Allocator();
+    }
+
+    void instantiate(int nb_buffers, int size_max) override {
+        Allocator allocator = make_allocator(nb_buffers, size_max);
+        m_buffers.reserve(nb_buffers);
+        for (int i = 0; i < nb_buffers; ++i) {
+            m_buffers.emplace_back(allocator);
+            m_buffers.back().resize_allocation(size_max);
+        }
+    }
+    void first_block(const std::vector<float>& block, std::vector<float>* out) override {
+        int block_size = static_cast<int>(block.size());
+        for (auto& rb : m_buffers) {
+            rb.push_back(block.data(), block_size);
+            rb.pop_front(out->data(), block_size);
+            m_checksum += (*out)[block_size-1];
+        }
+    }
+    void destroy() override {
+        std::vector<ringbuffer_t>().swap(m_buffers);
+    }
+};
+
+class StartupArena : public StartupAllocator<acbench::allocator_arena<float>> {
+ public:
+    std::unique_ptr<acbench::arena_monotonic> m_arena;
+
+    explicit StartupArena(const std::string& name, int nb_iter)
+        : StartupAllocator<acbench::allocator_arena<float>>(name, nb_iter) {
+    }
+
+    // The arena is created with the graph, so its allocation is part of the instantiation time
+    acbench::allocator_arena<float> make_allocator(int nb_buffers, int size_max) override {
+        std::size_t buffer_bytes = sizeof(float)*static_cast<std::size_t>(size_max);
+        buffer_bytes = ((buffer_bytes + acbench::arena_monotonic::alignment - 1) / acbench::arena_monotonic::alignment) * acbench::arena_monotonic::alignment;
+        m_arena.reset(new acbench::arena_monotonic(static_cast<std::size_t>(nb_buffers)*buffer_bytes));
+        return acbench::allocator_arena<float>(*m_arena);
+    }
+    void destroy() override {
+        StartupAllocator<acbench::allocator_arena<float>>::destroy();
+        m_arena.reset();
+    }
+};
+
+int main(int argc, char* argv[]) {
+
+    cxxopts::Options options("benchmark_ringbuffers_startup", "Benchmark the instantiation of many acbench::ringbuffer, with one allocation each vs. one shared arena");
+    options.add_options()
+        ("i,iterations", "Number of iterations.", cxxopts::value<int>()->default_value("20"))
+        ("n,nb_buffers", "Number of ringbuffers instantiated per iteration.", cxxopts::value<int>()->default_value("10000"))
+        ("s,size_max", "Capacity of each ringbuffer.", cxxopts::value<int>()->default_value("2048"))
+        ("b,block_size", "Number of values of the first block run through each ringbuffer.", cxxopts::value<int>()->default_value("256"))
+        ("h,help", "Print usage")
+    ;
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    std::srand(0);
+
+    int nb_iter = result["iterations"].as<int>();
+    int nb_buffers = result["nb_buffers"].as<int>();
+    int size_max = result["size_max"].as<int>();
+    int block_size = std::min(result["block_size"].as<int>(), size_max);
+    std::cout << "#Iterations: " << nb_iter << std::endl;
+    std::cout << "nb_buffers: " << nb_buffers << std::endl;
+    std::cout << "size_max: " << size_max << std::endl;
+    std::cout << "block_size: " << block_size << std::endl;
+
+    std::vector<float> block(block_size);
+    for (int k = 0; k < block_size; ++k)
+        block[k] = acbench::rand_uniform_continuous_01<float>();
+    std::vector<float> out(block_size);
+
+    std::vector<Startup*> startups;
+    startups.push_back(new StartupAllocator<acbench::allocator_new<float>>("new", nb_iter));
+    startups.push_back(new StartupAllocator<acbench::allocator_aligned<float>>("aligned", nb_iter));
+    startups.push_back(new StartupArena("arena", nb_iter));
+
+    std::mt19937 gen(0);
+    std::vector<int> order(startups.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    for (int iter = 0; iter < nb_iter; ++iter) {
+        // Run each allocation policy in a randomized order
+        std::shuffle(order.begin(), order.end(), gen);
+        for (int si : order)
+            startups[si]->run(nb_buffers, size_max, block, &out);
+    }
+
+    for (auto startup : startups) {
+        std::cout << "    " << startup->m_name << ":" << std::endl;
+        std::cout << "        instantiate: " << startup->m_elapsed_instantiate.stats(6)
+                  << ", " << acbench::to_string(startup->m_elapsed_instantiate.mean()*1e9/nb_buffers, "%5.1f") << "ns/buffer" << std::endl;
+        std::cout << "        first block: " << startup->m_elapsed_first_block.stats(6)
+                  << ", " << acbench::to_string(startup->m_elapsed_first_block.mean()*1e9/nb_buffers, "%5.1f") << "ns/buffer" << std::endl;
+        std::cout << "        destroy:     " << startup->m_elapsed_destroy.stats(6)
+                  << ", " << acbench::to_string(startup->m_elapsed_destroy.mean()*1e9/nb_buffers, "%5.1f") << "ns/buffer" << std::endl;
+    }
+    // All the policies run the same blocks through the same number of ringbuffers
+    for (auto startup : startups)
+        std::cout << "checksum " << startup->m_name << ": " << startup->m_checksum << std::endl;
+
+    for (auto startup : startups)
+        delete startup;
+
+    return 0;
+}